@@ -0,0 +1,255 @@
+/* Copyright 2025 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef SIGNAL_SRC_AUDIO_FRONTEND_H_
+#define SIGNAL_SRC_AUDIO_FRONTEND_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "signal/src/complex.h"
+#include "signal/src/energy.h"
+#include "signal/src/fft_auto_scale.h"
+#include "signal/src/filter_bank.h"
+#include "signal/src/filter_bank_log.h"
+#include "signal/src/filter_bank_spectral_subtraction.h"
+#include "signal/src/filter_bank_square_root.h"
+#include "signal/src/pcan_argc_fixed.h"
+#include "signal/src/rfft.h"
+#include "signal/src/window.h"
+
+namespace tflite {
+namespace tflm_signal {
+
+// Streaming audio frontend: Framer, Window, FftAutoScale, RFFT, Energy,
+// FilterBank, FilterBankSquareRoot, SpectralSubtraction, PCAN (optional)
+// and FilterBankLog in one object. It takes int16 PCM in chunks of any size
+// and emits one frame of `num_channels` int16 features per `window_step`
+// samples.
+//
+// All state lives in one block of AudioFrontendGetNeededMemory() bytes. The
+// stages alternate between two scratch buffers of about 2 * fft_length bytes
+// each, instead of each stage writing a tensor of its own.
+struct AudioFrontendConfig {
+  // Framing, in samples. `window_step` must not exceed `window_size`.
+  int32_t window_size;
+  int32_t window_step;
+  // `window_size` coefficients, applied with a right shift of `window_shift`.
+  const int16_t* window_coefficients;
+  int32_t window_shift;
+  // Power of two, at least `window_size`.
+  int32_t fft_length;
+  // Range [spectrum_start, spectrum_end) of FFT bins the energy is computed
+  // for, it must cover the bins used by the filterbank.
+  int32_t spectrum_start;
+  int32_t spectrum_end;
+  FilterbankConfig filterbank;
+  // `spectral_subtraction.num_channels` must be `filterbank.num_channels`.
+  SpectralSubtractionConfig spectral_subtraction;
+  // PCAN is applied if `pcan_gain_lut` is not null.
+  const int16_t* pcan_gain_lut;
+  int32_t pcan_snr_shift;
+  int32_t log_output_scale;
+  uint32_t log_correction_bits;
+};
+
+struct AudioFrontend {
+  const AudioFrontendConfig* config;
+  void* rfft_state;
+  // Samples of the current frame, the overlap with the next frame is kept.
+  int16_t* frame;
+  size_t frame_fill;
+  uint32_t* noise_estimate;
+  // Ping-pong buffers shared by the stages.
+  uint8_t* scratch_a;
+  uint8_t* scratch_b;
+};
+
+namespace audio_frontend_internal {
+
+inline size_t AlignUp(size_t bytes) {
+  return (bytes + 7) & ~static_cast<size_t>(7);
+}
+
+inline size_t MaxOf(size_t a, size_t b) { return a > b ? a : b; }
+
+// Holds the scaled frame and then the energy spectrum, later the square
+// roots of the filterbank channels.
+inline size_t ScratchABytes(const AudioFrontendConfig* config) {
+  const size_t bins = config->fft_length / 2 + 1;
+  return AlignUp(MaxOf(config->fft_length * sizeof(int16_t),
+                       MaxOf(bins * sizeof(uint32_t),
+                             config->filterbank.num_channels *
+                                 sizeof(uint32_t))));
+}
+
+// Holds the windowed frame and then the spectrum, later the filterbank
+// accumulators and the noise reduced channels.
+inline size_t ScratchBBytes(const AudioFrontendConfig* config) {
+  const size_t bins = config->fft_length / 2 + 1;
+  return AlignUp(
+      MaxOf(bins * sizeof(Complex<int16_t>),
+            (config->filterbank.num_channels + 1) * sizeof(uint64_t)));
+}
+
+inline size_t RfftBytes(const AudioFrontendConfig* config) {
+  return AlignUp(::tflm_signal::RfftInt16GetNeededMemory(config->fft_length));
+}
+
+// Computes the features of the frame in `frontend->frame`.
+inline void ProcessFrame(AudioFrontend* frontend, int16_t* features) {
+  const AudioFrontendConfig* config = frontend->config;
+  const int num_channels = config->filterbank.num_channels;
+  int16_t* windowed = reinterpret_cast<int16_t*>(frontend->scratch_b);
+  int16_t* scaled = reinterpret_cast<int16_t*>(frontend->scratch_a);
+  Complex<int16_t>* spectrum =
+      reinterpret_cast<Complex<int16_t>*>(frontend->scratch_b);
+  uint32_t* energy = reinterpret_cast<uint32_t*>(frontend->scratch_a);
+  uint64_t* filterbank = reinterpret_cast<uint64_t*>(frontend->scratch_b);
+  uint32_t* channels = reinterpret_cast<uint32_t*>(frontend->scratch_a);
+  uint32_t* noise_reduced = reinterpret_cast<uint32_t*>(frontend->scratch_b);
+
+  ::tflm_signal::ApplyWindow(frontend->frame, config->window_coefficients,
+                             config->window_size, config->window_shift,
+                             windowed);
+  const int scale_bits = FftAutoScale(windowed, config->window_size, scaled);
+  // The later stages use the tail of the buffer, so pad on every frame.
+  memset(scaled + config->window_size, 0,
+         (config->fft_length - config->window_size) * sizeof(int16_t));
+  ::tflm_signal::RfftInt16Apply(frontend->rfft_state, scaled, spectrum);
+  SpectrumToEnergy(spectrum, config->spectrum_start, config->spectrum_end,
+                   energy);
+  FilterbankAccumulateChannels(&config->filterbank, energy, filterbank);
+  FilterbankSqrt(filterbank, num_channels, scale_bits, channels);
+  FilterbankSpectralSubtraction(&config->spectral_subtraction, channels,
+                                noise_reduced, frontend->noise_estimate);
+  if (config->pcan_gain_lut != nullptr) {
+    ApplyPcanAutoGainControlFixed(config->pcan_gain_lut,
+                                  config->pcan_snr_shift,
+                                  frontend->noise_estimate, noise_reduced,
+                                  num_channels);
+  }
+  FilterbankLog(noise_reduced, num_channels, config->log_output_scale,
+                config->log_correction_bits, features);
+}
+
+}  // namespace audio_frontend_internal
+
+// Returns the size of the memory that a frontend with `config` needs.
+inline size_t AudioFrontendGetNeededMemory(const AudioFrontendConfig* config) {
+  using namespace audio_frontend_internal;
+  return AlignUp(sizeof(AudioFrontend)) + RfftBytes(config) +
+         AlignUp(config->window_size * sizeof(int16_t)) +
+         AlignUp(config->filterbank.num_channels * sizeof(uint32_t)) +
+         ScratchABytes(config) + ScratchBBytes(config);
+}
+
+// Resets the frontend to its initial state: no buffered samples and no noise
+// estimate.
+inline void AudioFrontendReset(AudioFrontend* frontend) {
+  using namespace audio_frontend_internal;
+  const AudioFrontendConfig* config = frontend->config;
+  frontend->frame_fill = 0;
+  memset(frontend->noise_estimate, 0,
+         config->filterbank.num_channels * sizeof(uint32_t));
+  memset(frontend->scratch_a, 0, ScratchABytes(config));
+  memset(frontend->scratch_b, 0, ScratchBBytes(config));
+}
+
+// Initializes a frontend for `config`, which must outlive it, in `state` of
+// `state_size` bytes. `state` must be 8 byte aligned and `state_size` at
+// least AudioFrontendGetNeededMemory(config).
+// Returns the frontend on success or nullptr on failure.
+inline AudioFrontend* AudioFrontendInit(const AudioFrontendConfig* config,
+                                        void* state, size_t state_size) {
+  using namespace audio_frontend_internal;
+  if (config == nullptr || state == nullptr ||
+      (reinterpret_cast<uintptr_t>(state) & 7) != 0 ||
+      state_size < AudioFrontendGetNeededMemory(config) ||
+      config->window_step <= 0 || config->window_step > config->window_size ||
+      config->window_size > config->fft_length ||
+      config->spectrum_start < 0 ||
+      config->spectrum_end > config->fft_length / 2 + 1 ||
+      config->spectral_subtraction.num_channels !=
+          config->filterbank.num_channels) {
+    return nullptr;
+  }
+  uint8_t* memory = static_cast<uint8_t*>(state);
+  AudioFrontend* frontend = reinterpret_cast<AudioFrontend*>(memory);
+  memory += AlignUp(sizeof(AudioFrontend));
+  frontend->config = config;
+  frontend->rfft_state = ::tflm_signal::RfftInt16Init(
+      config->fft_length, memory, RfftBytes(config));
+  if (frontend->rfft_state == nullptr) {
+    return nullptr;
+  }
+  memory += RfftBytes(config);
+  frontend->frame = reinterpret_cast<int16_t*>(memory);
+  memory += AlignUp(config->window_size * sizeof(int16_t));
+  frontend->noise_estimate = reinterpret_cast<uint32_t*>(memory);
+  memory += AlignUp(config->filterbank.num_channels * sizeof(uint32_t));
+  frontend->scratch_a = memory;
+  memory += ScratchABytes(config);
+  frontend->scratch_b = memory;
+  AudioFrontendReset(frontend);
+  return frontend;
+}
+
+// Consumes samples until a frame is complete or all `num_samples` are
+// consumed. Returns the number of samples consumed. If a frame was completed,
+// its `filterbank.num_channels` features are written to `features` and
+// `*frame_ready` is set to true.
+//
+// Call it in a loop until all samples of a chunk are consumed:
+//
+//   while (num_samples > 0) {
+//     bool frame_ready;
+//     size_t consumed = AudioFrontendProcessSamples(
+//         frontend, samples, num_samples, features, &frame_ready);
+//     samples += consumed;
+//     num_samples -= consumed;
+//     if (frame_ready) { ... }
+//   }
+inline size_t AudioFrontendProcessSamples(AudioFrontend* frontend,
+                                          const int16_t* samples,
+                                          size_t num_samples,
+                                          int16_t* features,
+                                          bool* frame_ready) {
+  const AudioFrontendConfig* config = frontend->config;
+  const size_t window_size = config->window_size;
+  size_t consumed = window_size - frontend->frame_fill;
+  if (consumed > num_samples) {
+    consumed = num_samples;
+  }
+  memcpy(frontend->frame + frontend->frame_fill, samples,
+         consumed * sizeof(int16_t));
+  frontend->frame_fill += consumed;
+
+  *frame_ready = frontend->frame_fill == window_size;
+  if (*frame_ready) {
+    audio_frontend_internal::ProcessFrame(frontend, features);
+    const size_t overlap = window_size - config->window_step;
+    memmove(frontend->frame, frontend->frame + config->window_step,
+            overlap * sizeof(int16_t));
+    frontend->frame_fill = overlap;
+  }
+  return consumed;
+}
+
+}  // namespace tflm_signal
+}  // namespace tflite
+
+#endif  // SIGNAL_SRC_AUDIO_FRONTEND_H_
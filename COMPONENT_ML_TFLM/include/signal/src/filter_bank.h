@@ -63,6 +63,55 @@ struct FilterbankConfig {
 void FilterbankAccumulateChannels(const FilterbankConfig* config,
                                   const uint32_t* input, uint64_t* output);
 
+// Number of frames FilterbankAccumulateChannelsBatch() accumulates at a time.
+constexpr int kFilterbankFramesPerBlock = 4;
+
+// FilterbankAccumulateChannels() for `num_frames` frames. Frame `f` is read
+// from `input + f * input_stride` and its `config->num_channels + 1` channels
+// are written to `output + f * output_stride`. The filter weights are walked
+// once per block of kFilterbankFramesPerBlock frames instead of once per
+// frame.
+inline void FilterbankAccumulateChannelsBatch(const FilterbankConfig* config,
+                                              const uint32_t* input,
+                                              int input_stride, int num_frames,
+                                              uint64_t* output,
+                                              int output_stride) {
+  for (int first = 0; first < num_frames;
+       first += kFilterbankFramesPerBlock) {
+    const int frames = num_frames - first < kFilterbankFramesPerBlock
+                           ? num_frames - first
+                           : kFilterbankFramesPerBlock;
+    const uint32_t* block_input = input + first * input_stride;
+    uint64_t* block_output = output + first * output_stride;
+    uint64_t weight_accumulator[kFilterbankFramesPerBlock] = {};
+    uint64_t unweight_accumulator[kFilterbankFramesPerBlock];
+    for (int i = 0; i < config->num_channels + 1; i++) {
+      const int16_t freq_start = config->channel_frequency_starts[i];
+      const int16_t weight_start = config->channel_weight_starts[i];
+      const int16_t channel_width = config->channel_widths[i];
+      for (int f = 0; f < frames; f++) {
+        unweight_accumulator[f] = 0;
+      }
+      for (int j = 0; j < channel_width; j++) {
+        const uint64_t weight =
+            static_cast<uint64_t>(config->weights[weight_start + j]);
+        const uint64_t unweight =
+            static_cast<uint64_t>(config->unweights[weight_start + j]);
+        const uint32_t* bin = block_input + freq_start + j;
+        for (int f = 0; f < frames; f++) {
+          const uint64_t value = bin[f * input_stride];
+          weight_accumulator[f] += weight * value;
+          unweight_accumulator[f] += unweight * value;
+        }
+      }
+      for (int f = 0; f < frames; f++) {
+        block_output[f * output_stride + i] = weight_accumulator[f];
+        weight_accumulator[f] = unweight_accumulator[f];
+      }
+    }
+  }
+}
+
 }  // namespace tflm_signal
 }  // namespace tflite
 
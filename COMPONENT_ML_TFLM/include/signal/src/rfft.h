@@ -80,6 +80,38 @@ void* RfftFloatInit(int32_t fft_length, void* state, size_t state_size);
 // * `output` must be of size (`fft_length` * 2) + 1 elements
 void RfftFloatApply(void* state, const float* input, Complex<float>* output);
 
+// Batched variants: apply the RFFT to `num_frames` consecutive frames of
+// `fft_length` elements and write `fft_length` / 2 + 1 complex values per
+// frame. The state, including the twiddle factors, is set up once by the
+// Init function and shared by all frames.
+
+inline void RfftInt16ApplyBatch(void* state, const int16_t* input,
+                                int32_t fft_length, int num_frames,
+                                Complex<int16_t>* output) {
+  for (int f = 0; f < num_frames; f++) {
+    RfftInt16Apply(state, input + f * fft_length,
+                   output + f * (fft_length / 2 + 1));
+  }
+}
+
+inline void RfftInt32ApplyBatch(void* state, const int32_t* input,
+                                int32_t fft_length, int num_frames,
+                                Complex<int32_t>* output) {
+  for (int f = 0; f < num_frames; f++) {
+    RfftInt32Apply(state, input + f * fft_length,
+                   output + f * (fft_length / 2 + 1));
+  }
+}
+
+inline void RfftFloatApplyBatch(void* state, const float* input,
+                                int32_t fft_length, int num_frames,
+                                Complex<float>* output) {
+  for (int f = 0; f < num_frames; f++) {
+    RfftFloatApply(state, input + f * fft_length,
+                   output + f * (fft_length / 2 + 1));
+  }
+}
+
 }  // namespace tflm_signal
 
 #endif  // SIGNAL_SRC_RFFT_H_
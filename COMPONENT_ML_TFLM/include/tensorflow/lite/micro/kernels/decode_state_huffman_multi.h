@@ -0,0 +1,404 @@
+/* Copyright 2025 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_MICRO_KERNELS_DECODE_STATE_HUFFMAN_MULTI_H_
+#define TENSORFLOW_LITE_MICRO_MICRO_KERNELS_DECODE_STATE_HUFFMAN_MULTI_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/compatibility.h"
+#include "tensorflow/lite/micro/kernels/decode_state.h"
+#include "tensorflow/lite/micro/kernels/decode_state_huffman.h"
+#include "tensorflow/lite/micro/kernels/micro_ops.h"
+#include "tensorflow/lite/micro/micro_context.h"
+#include "tensorflow/lite/micro/micro_log.h"
+
+namespace tflite {
+
+// Huffman decoding of int8 tensors with a multi-symbol lookup table.
+//
+// DecodeStateHuffman walks the tables of the DCM once per symbol. This state
+// builds a second table at Setup, indexed by the next `lookup_bits` bits of
+// the stream, that holds every symbol whose code lies completely within these
+// bits, up to kMaxSymbolsPerLookup of them. With the short codes typical for
+// quantized weights a single lookup emits several symbols. Symbols with
+// longer codes fall back to the walk of the DCM tables.
+//
+// The stream is read through a 64 bit reservoir, refilled with one 32 bit
+// word (one byte swap) whenever it runs low, instead of the bit by bit
+// bookkeeping of GetNextBits() and PutBackBits().
+//
+// The lookup table takes 5 << lookup_bits bytes of persistent arena per
+// decoded tensor, plus sizeof(DecodeStateHuffmanMulti) for the state itself.
+// The DecodeStateHuffman it replaces was allocated by the DECODE kernel and
+// stays in the persistent arena as well. int16 outputs, and tensors whose
+// first table level needs more than lookup_bits bits, are decoded by
+// DecodeStateHuffman.
+class DecodeStateHuffmanMulti : public DecodeStateHuffman {
+ public:
+  static constexpr int kMaxSymbolsPerLookup = 4;
+  static constexpr int kMaxLookupBits = 14;
+
+  DecodeStateHuffmanMulti() = delete;
+
+  DecodeStateHuffmanMulti(const TfLiteContext* context,
+                          MicroProfilerInterface* profiler, int lookup_bits)
+      : DecodeStateHuffman(context, profiler), lookup_bits_(lookup_bits) {}
+
+  TfLiteStatus Setup(const TfLiteTensor& input, const TfLiteTensor& ancillary,
+                     const TfLiteTensor& output) override {
+    TF_LITE_ENSURE_STATUS(DecodeStateHuffman::Setup(input, ancillary, output));
+    codewords_end_ = compressed_codewords_ + input.bytes / sizeof(uint32_t);
+    table_entries_ = (ancillary.bytes - kDcmSizeInBytes) /
+                     (use_32bit_table_ ? sizeof(uint32_t) : sizeof(uint16_t));
+    lookup_symbols_ = nullptr;
+    lookup_info_ = nullptr;
+    if (output.type != kTfLiteInt8) {
+      return kTfLiteOk;
+    }
+    // The first step of the table walk reads initial_table_size_ + 1 bits,
+    // which a lookup has to cover. Without a lookup table the tensor is
+    // decoded by DecodeStateHuffman.
+    if (lookup_bits_ < initial_table_size_ + 1 ||
+        lookup_bits_ > kMaxLookupBits) {
+      return kTfLiteOk;
+    }
+
+    const size_t entries = size_t{1} << lookup_bits_;
+    MicroContext* micro_context = GetMicroContext(context_);
+    lookup_symbols_ = static_cast<uint32_t*>(
+        micro_context->AllocatePersistentBuffer(entries * sizeof(uint32_t)));
+    lookup_info_ = static_cast<uint8_t*>(
+        micro_context->AllocatePersistentBuffer(entries * sizeof(uint8_t)));
+    if (lookup_symbols_ == nullptr || lookup_info_ == nullptr) {
+      MicroPrintf("Failed to allocate the Huffman lookup table");
+      return kTfLiteError;
+    }
+    if (use_32bit_table_) {
+      BuildLookupTable<Table32Bit>();
+    } else {
+      BuildLookupTable<Table16Bit>();
+    }
+    return kTfLiteOk;
+  }
+
+  TfLiteStatus Decode(const TfLiteEvalTensor& input,
+                      const TfLiteEvalTensor& ancillary,
+                      const TfLiteEvalTensor& output) override {
+    if (output.type != kTfLiteInt8 || lookup_info_ == nullptr) {
+      return DecodeStateHuffman::Decode(input, ancillary, output);
+    }
+    int8_t* buffer = static_cast<int8_t*>(output.data.data);
+    const bool decoded = use_32bit_table_
+                             ? DecompressToBufferMulti<Table32Bit>(buffer)
+                             : DecompressToBufferMulti<Table16Bit>(buffer);
+    if (!decoded) {
+      MicroPrintf("Invalid Huffman code in compressed tensor");
+      return kTfLiteError;
+    }
+    return kTfLiteOk;
+  }
+
+  TF_LITE_REMOVE_VIRTUAL_DELETE
+
+ protected:
+  virtual ~DecodeStateHuffmanMulti() = default;
+
+  struct Table16Bit {
+    using Element = uint16_t;
+    static constexpr Element kSymbolFoundMask = kTable16BitSymbolFoundMask;
+    static constexpr size_t kCountShift = kTable16BitCountShift;
+    static constexpr Element kValueMask = kTable16BitValueMask;
+  };
+
+  struct Table32Bit {
+    using Element = uint32_t;
+    static constexpr Element kSymbolFoundMask = kTable32BitSymbolFoundMask;
+    static constexpr size_t kCountShift = kTable32BitCountShift;
+    static constexpr Element kValueMask = kTable32BitValueMask;
+  };
+
+  // Big endian bit stream, most significant bit of `bits` first.
+  struct BitReservoir {
+    uint64_t bits;
+    int available;
+    const uint32_t* next;
+    const uint32_t* end;
+
+    // Ensures at least 33 bits are available. Past the end of the stream
+    // zeros are read, as padding of the last codeword.
+    void Refill() {
+      while (available <= 32) {
+        uint32_t word = 0;
+        if (next < end) {
+          word = LoadBigEndian(next++);
+        }
+        bits |= static_cast<uint64_t>(word) << (32 - available);
+        available += 32;
+      }
+    }
+
+    uint32_t Peek(int count) const {
+      return static_cast<uint32_t>(bits >> (64 - count));
+    }
+
+    void Skip(int count) {
+      bits <<= count;
+      available -= count;
+    }
+
+    uint32_t Read(int count) {
+      if (available < count) {
+        Refill();
+      }
+      const uint32_t value = Peek(count);
+      Skip(count);
+      return value;
+    }
+
+    // Returns the last `count` bits of `value`, the most recently read bits,
+    // to the stream.
+    void PutBack(int count, uint32_t value) {
+      const uint64_t mask = (uint64_t{1} << count) - 1;
+      bits = (bits >> count) | ((value & mask) << (64 - count));
+      available += count;
+    }
+  };
+
+  static uint32_t LoadBigEndian(const uint32_t* word) {
+    uint32_t value = *word;
+    int one = 1;
+    if (reinterpret_cast<const char*>(&one)[0] == 1) {
+#if defined(__GNUC__) || defined(__clang__)
+      value = __builtin_bswap32(value);
+#else
+      value = (value << 24) | ((value & 0xFF00) << 8) |
+              ((value >> 8) & 0xFF00) | (value >> 24);
+#endif  // defined(__GNUC__) || defined(__clang__)
+    }
+    return value;
+  }
+
+  // Decodes one symbol by walking the DCM tables, like DecodeStateHuffman.
+  // `consumed` is the code length, `read` the number of bits looked at.
+  // Returns false on an index outside of the tables or if more than
+  // `max_read` bits would have to be looked at.
+  template <typename Table>
+  bool WalkSymbol(BitReservoir& reservoir, int max_read, uint32_t* symbol,
+                  int* consumed, int* read) const {
+    using Element = typename Table::Element;
+    const Element* table = static_cast<const Element*>(huffman_tables_);
+    int count = initial_table_size_ + 1;
+    uint32_t last_bits = reservoir.Read(count);
+    size_t index = last_bits;
+    int total = count;
+    while (true) {
+      if (index >= table_entries_) {
+        return false;
+      }
+      const Element element = table[index];
+      if (element & Table::kSymbolFoundMask) {
+        const int used = (element >> Table::kCountShift) & 0xF;
+        if (used < count) {
+          reservoir.PutBack(count - used, last_bits);
+          *consumed = total - (count - used);
+        } else {
+          *consumed = total;
+        }
+        *read = total;
+        *symbol = element & Table::kValueMask;
+        return true;
+      }
+      count = (element >> Table::kCountShift) + 1;
+      if (total + count > max_read) {
+        return false;
+      }
+      last_bits = reservoir.Read(count);
+      index += (element & Table::kValueMask) + last_bits;
+      total += count;
+    }
+  }
+
+  // Entry i of the lookup table holds the symbols whose codes lie completely
+  // within the first lookup_bits_ bits of i: up to four int8 symbols in
+  // lookup_symbols_[i], their number and total code length in lookup_info_[i].
+  template <typename Table>
+  void BuildLookupTable() {
+    const uint32_t entries = uint32_t{1} << lookup_bits_;
+    for (uint32_t i = 0; i < entries; ++i) {
+      BitReservoir reservoir = {static_cast<uint64_t>(i) << (64 - lookup_bits_),
+                                64, nullptr, nullptr};
+      int8_t symbols[kMaxSymbolsPerLookup] = {};
+      int symbol_count = 0;
+      int position = 0;
+      while (symbol_count < kMaxSymbolsPerLookup) {
+        BitReservoir probe = reservoir;
+        uint32_t symbol;
+        int consumed;
+        int read;
+        if (!WalkSymbol<Table>(probe, lookup_bits_ - position, &symbol,
+                               &consumed, &read) ||
+            position + read > lookup_bits_) {
+          break;
+        }
+        symbols[symbol_count++] = static_cast<int8_t>(symbol);
+        position += consumed;
+        reservoir = probe;
+      }
+      memcpy(&lookup_symbols_[i], symbols, sizeof(symbols));
+      lookup_info_[i] = static_cast<uint8_t>(symbol_count << kInfoCountShift |
+                                             position);
+    }
+  }
+
+  template <typename Table>
+  bool DecompressToBufferMulti(int8_t* buffer) const {
+    BitReservoir reservoir = {0, 0, compressed_codewords_, codewords_end_};
+    size_t remaining = count_codewords_;
+    uint32_t symbol;
+    int consumed;
+    int read;
+
+    // The lookups store kMaxSymbolsPerLookup bytes, so leave room for them.
+    while (remaining >= kMaxSymbolsPerLookup) {
+      if (reservoir.available < lookup_bits_) {
+        reservoir.Refill();
+      }
+      const uint32_t index = reservoir.Peek(lookup_bits_);
+      const uint8_t info = lookup_info_[index];
+      const int symbol_count = info >> kInfoCountShift;
+      if (symbol_count > 0) {
+        memcpy(buffer, &lookup_symbols_[index], kMaxSymbolsPerLookup);
+        buffer += symbol_count;
+        remaining -= symbol_count;
+        reservoir.Skip(info & kInfoBitsMask);
+      } else {
+        if (!WalkSymbol<Table>(reservoir, kMaxWalkBits, &symbol, &consumed,
+                               &read)) {
+          return false;
+        }
+        *buffer++ = static_cast<int8_t>(symbol);
+        --remaining;
+      }
+    }
+    for (; remaining > 0; --remaining) {
+      if (!WalkSymbol<Table>(reservoir, kMaxWalkBits, &symbol, &consumed,
+                             &read)) {
+        return false;
+      }
+      *buffer++ = static_cast<int8_t>(symbol);
+    }
+    return true;
+  }
+
+  static constexpr int kInfoCountShift = 4;
+  static constexpr uint8_t kInfoBitsMask = 0x0F;
+  // Longest walk through the DCM tables, in bits, before the code is
+  // considered invalid.
+  static constexpr int kMaxWalkBits = 64;
+
+  static_assert(kMaxLookupBits <= kInfoBitsMask,
+                "Code lengths of a lookup must fit into the info bits");
+
+  int lookup_bits_;
+  const uint32_t* codewords_end_ = nullptr;
+  size_t table_entries_ = 0;
+  uint32_t* lookup_symbols_ = nullptr;
+  uint8_t* lookup_info_ = nullptr;
+};
+
+namespace decode_huffman_multi {
+
+inline TFLMRegistration& WrappedDecode() {
+  static TFLMRegistration registration = {};
+  return registration;
+}
+
+// Runs the prepare of the DECODE kernel, then replaces the states of the
+// Huffman compressed int8 outputs. The kernel keeps an array of DecodeState
+// pointers, one per output, in the user data of the node. The replaced states
+// are smaller than DecodeStateHuffmanMulti, so the new ones cannot be built in
+// their place, and persistent allocations cannot be freed.
+template <int tLookupBits>
+TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
+  TF_LITE_ENSURE_STATUS(WrappedDecode().prepare(context, node));
+  DecodeState** states = static_cast<DecodeState**>(node->user_data);
+  MicroContext* micro_context = GetMicroContext(context);
+  TfLiteStatus status = kTfLiteOk;
+
+  for (int i = 0; i + 1 < NumInputs(node) && status == kTfLiteOk; i += 2) {
+    TfLiteTensor* input = micro_context->AllocateTempInputTensor(node, i);
+    TfLiteTensor* ancillary =
+        micro_context->AllocateTempInputTensor(node, i + 1);
+    TfLiteTensor* output = micro_context->AllocateTempOutputTensor(node, i / 2);
+    if (input == nullptr || ancillary == nullptr || output == nullptr) {
+      status = kTfLiteError;
+    } else if (DecodeState::Type(*ancillary) == DecodeState::kDcmTypeHuffman &&
+               output->type == kTfLiteInt8) {
+      void* memory = micro_context->AllocatePersistentBuffer(
+          sizeof(DecodeStateHuffmanMulti));
+      if (memory == nullptr) {
+        status = kTfLiteError;
+      } else {
+        DecodeStateHuffmanMulti* state = new (memory) DecodeStateHuffmanMulti(
+            context, micro_context->GetAlternateProfiler(), tLookupBits);
+        status = state->Setup(*input, *ancillary, *output);
+        states[i / 2] = state;
+      }
+    }
+    if (input != nullptr) {
+      micro_context->DeallocateTempTfLiteTensor(input);
+    }
+    if (ancillary != nullptr) {
+      micro_context->DeallocateTempTfLiteTensor(ancillary);
+    }
+    if (output != nullptr) {
+      micro_context->DeallocateTempTfLiteTensor(output);
+    }
+  }
+  return status;
+}
+
+}  // namespace decode_huffman_multi
+
+// DECODE kernel with multi-symbol Huffman decoding of int8 tensors. Other
+// decode types are handled by the DECODE kernel as before.
+//
+//   resolver.AddCustom("TFLM_DECODE",
+//                      tflite::Register_DECODE_HUFFMAN_MULTI_SYMBOL());
+//
+// Longer lookups emit more symbols per lookup but take 5 << tLookupBits bytes
+// of persistent arena per Huffman compressed int8 tensor. Each of these
+// tensors also keeps the unused DecodeStateHuffman of the DECODE kernel next
+// to its DecodeStateHuffmanMulti, sizeof() of both.
+template <int tLookupBits = 10>
+TFLMRegistration Register_DECODE_HUFFMAN_MULTI_SYMBOL() {
+  static_assert(tLookupBits > 0 &&
+                    tLookupBits <= DecodeStateHuffmanMulti::kMaxLookupBits,
+                "Unsupported number of lookup bits");
+  decode_huffman_multi::WrappedDecode() = Register_DECODE();
+  TFLMRegistration registration = decode_huffman_multi::WrappedDecode();
+  registration.prepare = decode_huffman_multi::Prepare<tLookupBits>;
+  return registration;
+}
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MICRO_KERNELS_DECODE_STATE_HUFFMAN_MULTI_H_
@@ -0,0 +1,320 @@
+/* Copyright 2025 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_KERNELS_TILED_CONV_CHAIN_H_
+#define TENSORFLOW_LITE_MICRO_KERNELS_TILED_CONV_CHAIN_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/common.h"
+
+namespace tflite {
+
+// Depth-first execution of a chain of int8 CONV_2D, DEPTHWISE_CONV_2D,
+// MAX_POOL_2D and AVERAGE_POOL_2D layers (batch 1, NHWC).
+//
+// The output of the last layer is computed row by row. Each row pulls the
+// input rows it needs from the layer before, which computes them on demand
+// into a rolling buffer holding only as many rows as the filter of the next
+// layer spans. Rows shared between neighbouring output rows (the halo) stay
+// in the rolling buffer, so nothing is computed twice, and the full
+// intermediate feature maps are never stored.
+//
+// The arithmetic is the one of the reference int8 kernels, so the results
+// are bit exact with the per-layer execution.
+
+enum class TiledLayerKind : uint8_t {
+  kConv,
+  kDepthwiseConv,
+  kMaxPool,
+  kAveragePool,
+};
+
+// Largest dilated filter height of a tiled layer.
+constexpr int kMaxTiledFilterHeight = 16;
+// Largest number of layers in a chain.
+constexpr int kMaxTiledChainLength = 8;
+
+struct TiledLayer {
+  TiledLayerKind kind;
+  int input_height;
+  int input_width;
+  int input_depth;
+  int output_height;
+  int output_width;
+  int output_depth;
+  int filter_height;
+  int filter_width;
+  int stride_height;
+  int stride_width;
+  int dilation_height;  // 1 for pooling.
+  int dilation_width;
+  int padding_top;
+  int padding_left;
+  int depth_multiplier;
+  int32_t input_offset;
+  int32_t output_offset;
+  int32_t activation_min;
+  int32_t activation_max;
+  const int8_t* filter;  // Unused for pooling.
+  const int32_t* bias;   // Can be null.
+  const int32_t* output_multiplier;  // Per output channel, conv only.
+  const int32_t* output_shift;       // Per output channel, conv only.
+
+  // Rolling buffer of the output rows, for all but the last layer.
+  int8_t* rows;
+  int row_capacity;
+  int produced_rows;
+};
+
+// Number of input rows one output row of `layer` spans, which is the number
+// of rows the rolling buffer of the layer before has to hold.
+inline int TiledLayerInputRows(const TiledLayer& layer) {
+  return (layer.filter_height - 1) * layer.dilation_height + 1;
+}
+
+inline size_t TiledLayerRowBytes(const TiledLayer& layer) {
+  return static_cast<size_t>(layer.output_width) * layer.output_depth;
+}
+
+// Bytes of the rolling buffers of a chain: rows of layer i are held for
+// layer i + 1.
+inline size_t TiledChainBufferBytes(const TiledLayer* layers, int count) {
+  size_t bytes = 0;
+  for (int i = 0; i + 1 < count; ++i) {
+    bytes += TiledLayerRowBytes(layers[i]) * TiledLayerInputRows(layers[i + 1]);
+  }
+  return bytes;
+}
+
+// Splits `buffer` of TiledChainBufferBytes() into the rolling buffers.
+inline void TiledChainAssignBuffers(TiledLayer* layers, int count,
+                                    int8_t* buffer) {
+  for (int i = 0; i + 1 < count; ++i) {
+    layers[i].rows = buffer;
+    layers[i].row_capacity = TiledLayerInputRows(layers[i + 1]);
+    buffer += TiledLayerRowBytes(layers[i]) * layers[i].row_capacity;
+  }
+  layers[count - 1].rows = nullptr;
+  layers[count - 1].row_capacity = 0;
+}
+
+namespace tiled_conv_chain {
+
+inline int32_t Clamp(const TiledLayer& layer, int32_t value) {
+  value = std::max(value, layer.activation_min);
+  return std::min(value, layer.activation_max);
+}
+
+// `rows[ky]` is the input row of filter row ky, or null in the padding.
+inline void ConvRow(const TiledLayer& layer, const int8_t* const* rows,
+                    int8_t* output) {
+  const int depth = layer.input_depth;
+  for (int out_x = 0; out_x < layer.output_width; ++out_x) {
+    const int in_x_origin = out_x * layer.stride_width - layer.padding_left;
+    for (int out_c = 0; out_c < layer.output_depth; ++out_c) {
+      int32_t acc = 0;
+      for (int ky = 0; ky < layer.filter_height; ++ky) {
+        if (rows[ky] == nullptr) {
+          continue;
+        }
+        for (int kx = 0; kx < layer.filter_width; ++kx) {
+          const int in_x = in_x_origin + kx * layer.dilation_width;
+          if (in_x < 0 || in_x >= layer.input_width) {
+            continue;
+          }
+          const int8_t* input = rows[ky] + in_x * depth;
+          const int8_t* filter =
+              layer.filter +
+              ((out_c * layer.filter_height + ky) * layer.filter_width + kx) *
+                  depth;
+          for (int in_c = 0; in_c < depth; ++in_c) {
+            acc += filter[in_c] * (input[in_c] + layer.input_offset);
+          }
+        }
+      }
+      if (layer.bias != nullptr) {
+        acc += layer.bias[out_c];
+      }
+      acc = MultiplyByQuantizedMultiplier(acc, layer.output_multiplier[out_c],
+                                          layer.output_shift[out_c]);
+      output[out_x * layer.output_depth + out_c] =
+          static_cast<int8_t>(Clamp(layer, acc + layer.output_offset));
+    }
+  }
+}
+
+inline void DepthwiseConvRow(const TiledLayer& layer,
+                             const int8_t* const* rows, int8_t* output) {
+  for (int out_x = 0; out_x < layer.output_width; ++out_x) {
+    const int in_x_origin = out_x * layer.stride_width - layer.padding_left;
+    for (int in_c = 0; in_c < layer.input_depth; ++in_c) {
+      for (int m = 0; m < layer.depth_multiplier; ++m) {
+        const int out_c = in_c * layer.depth_multiplier + m;
+        int32_t acc = 0;
+        for (int ky = 0; ky < layer.filter_height; ++ky) {
+          if (rows[ky] == nullptr) {
+            continue;
+          }
+          for (int kx = 0; kx < layer.filter_width; ++kx) {
+            const int in_x = in_x_origin + kx * layer.dilation_width;
+            if (in_x < 0 || in_x >= layer.input_width) {
+              continue;
+            }
+            const int32_t input = rows[ky][in_x * layer.input_depth + in_c];
+            const int32_t filter =
+                layer.filter[(ky * layer.filter_width + kx) *
+                                 layer.output_depth +
+                             out_c];
+            acc += filter * (input + layer.input_offset);
+          }
+        }
+        if (layer.bias != nullptr) {
+          acc += layer.bias[out_c];
+        }
+        acc = MultiplyByQuantizedMultiplier(
+            acc, layer.output_multiplier[out_c], layer.output_shift[out_c]);
+        output[out_x * layer.output_depth + out_c] =
+            static_cast<int8_t>(Clamp(layer, acc + layer.output_offset));
+      }
+    }
+  }
+}
+
+inline TfLiteStatus PoolRow(const TiledLayer& layer, const int8_t* const* rows,
+                            int8_t* output) {
+  const int depth = layer.input_depth;
+  for (int out_x = 0; out_x < layer.output_width; ++out_x) {
+    const int in_x_origin = out_x * layer.stride_width - layer.padding_left;
+    const int filter_x_start = std::max(0, -in_x_origin);
+    const int filter_x_end =
+        std::min(layer.filter_width, layer.input_width - in_x_origin);
+    for (int c = 0; c < depth; ++c) {
+      int32_t max = std::numeric_limits<int8_t>::lowest();
+      int32_t sum = 0;
+      int count = 0;
+      for (int ky = 0; ky < layer.filter_height; ++ky) {
+        if (rows[ky] == nullptr) {
+          continue;
+        }
+        for (int kx = filter_x_start; kx < filter_x_end; ++kx) {
+          const int32_t value = rows[ky][(in_x_origin + kx) * depth + c];
+          max = std::max(max, value);
+          sum += value;
+          ++count;
+        }
+      }
+      int32_t value = max;
+      if (layer.kind == TiledLayerKind::kAveragePool) {
+        if (count == 0) {
+          return kTfLiteError;
+        }
+        value = sum > 0 ? (sum + count / 2) / count : (sum - count / 2) / count;
+      }
+      output[out_x * depth + c] = static_cast<int8_t>(Clamp(layer, value));
+    }
+  }
+  return kTfLiteOk;
+}
+
+inline TfLiteStatus ProduceRow(TiledLayer* layers, int index,
+                               const int8_t* input, int out_y,
+                               int8_t* output);
+
+// Makes rows up to `last_row` of the output of layer `index` available in its
+// rolling buffer.
+inline TfLiteStatus EnsureRows(TiledLayer* layers, int index,
+                               const int8_t* input, int last_row) {
+  TiledLayer& layer = layers[index];
+  while (layer.produced_rows <= last_row) {
+    int8_t* row = layer.rows + (layer.produced_rows % layer.row_capacity) *
+                                   TiledLayerRowBytes(layer);
+    TF_LITE_ENSURE_STATUS(
+        ProduceRow(layers, index, input, layer.produced_rows, row));
+    ++layer.produced_rows;
+  }
+  return kTfLiteOk;
+}
+
+// Computes row `out_y` of the output of layer `index` into `output`. `input`
+// is the input of the first layer.
+inline TfLiteStatus ProduceRow(TiledLayer* layers, int index,
+                               const int8_t* input, int out_y,
+                               int8_t* output) {
+  const TiledLayer& layer = layers[index];
+  const int first_row = out_y * layer.stride_height - layer.padding_top;
+  const int last_row =
+      std::min(first_row + TiledLayerInputRows(layer) - 1,
+               layer.input_height - 1);
+  if (index > 0 && last_row >= 0) {
+    TF_LITE_ENSURE_STATUS(EnsureRows(layers, index - 1, input, last_row));
+  }
+
+  const size_t input_row_bytes =
+      static_cast<size_t>(layer.input_width) * layer.input_depth;
+  const int8_t* rows[kMaxTiledFilterHeight];
+  for (int ky = 0; ky < layer.filter_height; ++ky) {
+    const int row = first_row + ky * layer.dilation_height;
+    if (row < 0 || row >= layer.input_height) {
+      rows[ky] = nullptr;
+    } else if (index == 0) {
+      rows[ky] = input + row * input_row_bytes;
+    } else {
+      const TiledLayer& producer = layers[index - 1];
+      rows[ky] = producer.rows + (row % producer.row_capacity) * input_row_bytes;
+    }
+  }
+
+  switch (layer.kind) {
+    case TiledLayerKind::kConv:
+      ConvRow(layer, rows, output);
+      return kTfLiteOk;
+    case TiledLayerKind::kDepthwiseConv:
+      DepthwiseConvRow(layer, rows, output);
+      return kTfLiteOk;
+    default:
+      return PoolRow(layer, rows, output);
+  }
+}
+
+}  // namespace tiled_conv_chain
+
+// Runs the chain on `input`, writing the output of the last layer to
+// `output`. The rolling buffers must have been assigned with
+// TiledChainAssignBuffers().
+inline TfLiteStatus TiledChainInvoke(TiledLayer* layers, int count,
+                                     const int8_t* input, int8_t* output) {
+  if (count < 1 || count > kMaxTiledChainLength) {
+    return kTfLiteError;
+  }
+  for (int i = 0; i < count; ++i) {
+    layers[i].produced_rows = 0;
+  }
+  const TiledLayer& last = layers[count - 1];
+  for (int out_y = 0; out_y < last.output_height; ++out_y) {
+    TF_LITE_ENSURE_STATUS(tiled_conv_chain::ProduceRow(
+        layers, count - 1, input, out_y,
+        output + out_y * TiledLayerRowBytes(last)));
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_KERNELS_TILED_CONV_CHAIN_H_
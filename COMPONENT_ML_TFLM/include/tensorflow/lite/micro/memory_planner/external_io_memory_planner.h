@@ -0,0 +1,191 @@
+/* Copyright 2025 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_EXTERNAL_IO_MEMORY_PLANNER_H_
+#define TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_EXTERNAL_IO_MEMORY_PLANNER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/compatibility.h"
+#include "tensorflow/lite/micro/flatbuffer_utils.h"
+#include "tensorflow/lite/micro/memory_planner/micro_memory_planner.h"
+#include "tensorflow/lite/micro/memory_planner/recording_memory_planner.h"
+#include "tensorflow/lite/micro/micro_log.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+
+/*   This is an experimental feature and subjected to change.
+ *
+The ExternalIoMemoryPlanner removes the model inputs and outputs that the
+application binds to its own buffers with MicroInterpreter::BindInput() and
+MicroInterpreter::BindOutput() from the arena. Those tensors are passed to the
+wrapped planner with a size of zero, so the arena shrinks by their size.
+
+Like the AliasingMemoryPlanner, this planner records all buffers first and uses
+the model flatbuffer to find out which planner buffer belongs to which tensor of
+the first subgraph (see recording_memory_planner.h). Tensors are only excluded
+when that mapping is verified against the buffers the MicroAllocator actually
+adds (buffer count, sizes and no offline planned buffers); otherwise every
+buffer is forwarded unchanged.
+
+Every excluded tensor must be bound after AllocateTensors() and before the
+first Invoke(); until then its data pointer refers to zero bytes of arena. Run
+the model with MicroInterpreter::InvokeExternalIo(), which refuses to run while
+an excluded tensor is unbound. Invoke() is implemented in the runtime library
+and can't check it.
+
+Example:
+
+  tflite::GreedyMemoryPlanner greedy;
+  tflite::ExternalIoMemoryPlanner planner(&greedy, model);
+  planner.ExcludeInput(0);
+  planner.ExcludeOutput(0);
+  tflite::MicroInterpreter interpreter(model, resolver,
+      tflite::MicroAllocator::Create(arena, arena_size, &planner));
+  interpreter.AllocateTensors();
+  interpreter.BindInput(0, dma_slot, sizeof(dma_slot));
+  interpreter.BindOutput(0, result, sizeof(result));
+  interpreter.InvokeExternalIo(planner);
+*/
+class ExternalIoMemoryPlanner : public RecordingMemoryPlanner {
+ public:
+  // Inputs and outputs are tracked in a bit mask each.
+  static constexpr int kMaxIoTensors = 32;
+
+  // Does not take ownership of planner or model, which must outlive this
+  // object.
+  ExternalIoMemoryPlanner(MicroMemoryPlanner* planner, const Model* model)
+      : RecordingMemoryPlanner(planner, model, "external I/O"),
+        excluded_inputs_(0),
+        excluded_outputs_(0),
+        applied_inputs_(0),
+        applied_outputs_(0),
+        excluded_bytes_(0) {}
+  ~ExternalIoMemoryPlanner() override {}
+
+  // Excludes the model input or output at `index` from the arena.
+  TfLiteStatus ExcludeInput(int index) {
+    return SetBit(index, &excluded_inputs_);
+  }
+  TfLiteStatus ExcludeOutput(int index) {
+    return SetBit(index, &excluded_outputs_);
+  }
+
+  // Returns true if the model input or output at `index` got no arena memory
+  // and must be bound by the application. Only valid once the buffers were
+  // planned, i.e. after AllocateTensors().
+  bool IsInputExcluded(int index) const {
+    return index >= 0 && index < kMaxIoTensors &&
+           (applied_inputs_ & (1u << index)) != 0;
+  }
+  bool IsOutputExcluded(int index) const {
+    return index >= 0 && index < kMaxIoTensors &&
+           (applied_outputs_ & (1u << index)) != 0;
+  }
+
+  TfLiteStatus Init(unsigned char* scratch_buffer,
+                    int scratch_buffer_size) override {
+    excluded_bytes_ = 0;
+    applied_inputs_ = 0;
+    applied_outputs_ = 0;
+    return RecordingMemoryPlanner::Init(scratch_buffer, scratch_buffer_size);
+  }
+
+  void PrintMemoryPlan() override {
+    MicroPrintf("External I/O planner: %d bytes excluded from the arena",
+                excluded_bytes_);
+    planner_->PrintMemoryPlan();
+  }
+
+  // Number of arena bytes saved by the excluded tensors.
+  int GetExcludedBytes() {
+    ForwardBuffersIfNeeded();
+    return excluded_bytes_;
+  }
+
+ private:
+  static TfLiteStatus SetBit(int index, uint32_t* mask) {
+    if (index < 0 || index >= kMaxIoTensors) {
+      MicroPrintf("I/O tensor index %d is outside range 0 to %d", index,
+                  kMaxIoTensors - 1);
+      return kTfLiteError;
+    }
+    *mask |= 1u << index;
+    return kTfLiteOk;
+  }
+
+  // Gives the buffers of the excluded tensors of `tensors` a size of zero and
+  // returns the bits of `mask` that were excluded.
+  uint32_t ExcludeBuffers(const flatbuffers::Vector<int32_t>* tensors,
+                          uint32_t mask) {
+    if (tensors == nullptr) {
+      return 0;
+    }
+    const size_t count = tensors->size() < static_cast<size_t>(kMaxIoTensors)
+                             ? tensors->size()
+                             : static_cast<size_t>(kMaxIoTensors);
+    uint32_t applied = 0;
+    for (size_t i = 0; i < count; ++i) {
+      const int buffer = BufferOf(tensors->Get(i));
+      if ((mask & (1u << i)) == 0 || buffer < 0) {
+        continue;
+      }
+      BufferRecord& record = records_[buffer];
+      excluded_bytes_ += record.planned_size;
+      record.planned_size = 0;
+      applied |= 1u << i;
+    }
+    return applied;
+  }
+
+  // Tensors are only excluded when the buffers match the model, otherwise
+  // every buffer is forwarded unchanged.
+  TfLiteStatus PlanBuffers() override {
+    excluded_bytes_ = 0;
+    applied_inputs_ = 0;
+    applied_outputs_ = 0;
+    if (excluded_inputs_ == 0 && excluded_outputs_ == 0) {
+      return kTfLiteOk;
+    }
+    if (!MapTensorsToBuffers()) {
+      MicroPrintf(
+          "External I/O planner: buffers don't match the model, nothing "
+          "excluded");
+      return kTfLiteOk;
+    }
+    const SubGraph* subgraph = model_->subgraphs()->Get(0);
+    applied_inputs_ = ExcludeBuffers(subgraph->inputs(), excluded_inputs_);
+    applied_outputs_ = ExcludeBuffers(subgraph->outputs(), excluded_outputs_);
+    return kTfLiteOk;
+  }
+
+  uint32_t excluded_inputs_;
+  uint32_t excluded_outputs_;
+  // Excluded I/O tensors that actually got a zero byte buffer.
+  uint32_t applied_inputs_;
+  uint32_t applied_outputs_;
+
+  int excluded_bytes_;
+
+ public:
+  TF_LITE_REMOVE_VIRTUAL_DELETE
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_EXTERNAL_IO_MEMORY_PLANNER_H_
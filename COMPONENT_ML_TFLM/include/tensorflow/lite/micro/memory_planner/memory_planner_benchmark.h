@@ -0,0 +1,184 @@
+/* Copyright 2025 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_MEMORY_PLANNER_BENCHMARK_H_
+#define TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_MEMORY_PLANNER_BENCHMARK_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/flatbuffer_utils.h"
+#include "tensorflow/lite/micro/memory_planner/greedy_memory_planner.h"
+#include "tensorflow/lite/micro/memory_planner/micro_memory_planner.h"
+#include "tensorflow/lite/micro/memory_planner/optimal_memory_planner.h"
+#include "tensorflow/lite/micro/micro_arena_constants.h"
+#include "tensorflow/lite/micro/micro_log.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+
+// Benchmark comparing the arena size planned by the OptimalMemoryPlanner
+// against the GreedyMemoryPlanner over a corpus of models. It links against
+// the runtime library for the GreedyMemoryPlanner, MicroPrintf() and
+// GetCurrentTimeTicks().
+//
+// The buffer lifetimes are derived directly from the flatbuffer of the first
+// subgraph, the same way the AllocationInfoBuilder does for activation
+// tensors: model inputs are created at time 0 and operator i runs at time
+// i + 1. Scratch buffers requested by kernels at Prepare time are not known
+// without running the kernels and are therefore not part of the comparison.
+//
+// Example:
+//
+//   const tflite::Model* models[] = {tflite::GetModel(kws_model),
+//                                    tflite::GetModel(vad_model)};
+//   static unsigned char scratch[64 * 1024];
+//   tflite::MemoryPlannerBenchmarkResult results[2];
+//   tflite::BenchmarkMemoryPlanners(models, 2, scratch, sizeof(scratch),
+//                                   /*max_search_steps=*/1000000,
+//                                   /*max_search_ticks=*/0, results);
+//   tflite::PrintMemoryPlannerBenchmark(results, 2);
+
+struct MemoryPlannerBenchmarkResult {
+  int buffer_count;
+  size_t greedy_bytes;
+  size_t optimal_bytes;
+  size_t lower_bound_bytes;
+  bool is_proven_optimal;
+  int search_steps;
+};
+
+// Adds one buffer per non-constant, non-variable tensor of the first subgraph
+// of `model` to `planner`. Sizes are rounded up to MicroArenaBufferAlignment()
+// and times are assigned like the MicroAllocator does: time 0 for the model
+// inputs, time i + 1 for operator i and model outputs live until the last
+// operator.
+inline TfLiteStatus AddModelBuffersToPlanner(const Model* model,
+                                             MicroMemoryPlanner* planner) {
+  if (model == nullptr || model->subgraphs() == nullptr ||
+      model->subgraphs()->size() == 0) {
+    return kTfLiteError;
+  }
+  const SubGraph* subgraph = model->subgraphs()->Get(0);
+  const auto* tensors = subgraph->tensors();
+  const auto* operators = subgraph->operators();
+  if (tensors == nullptr) {
+    return kTfLiteOk;
+  }
+  const int op_count = operators == nullptr ? 0 : operators->size();
+  const int last_time = op_count;
+
+  for (size_t t = 0; t < tensors->size(); ++t) {
+    const Tensor* tensor = tensors->Get(t);
+    if (tensor->is_variable() || FlatbufferTensorHasData(model, tensor)) {
+      continue;
+    }
+    int first_created =
+        FlatbufferVectorContains(subgraph->inputs(), t) ? 0 : -1;
+    int last_used =
+        FlatbufferVectorContains(subgraph->outputs(), t) ? last_time : -1;
+    for (int i = 0; i < op_count; ++i) {
+      const Operator* op = operators->Get(i);
+      if (op->outputs() != nullptr) {
+        for (int32_t output : *op->outputs()) {
+          if (output == static_cast<int32_t>(t) && first_created < 0) {
+            first_created = i + 1;
+          }
+        }
+      }
+      if (op->inputs() != nullptr) {
+        for (int32_t input : *op->inputs()) {
+          if (input == static_cast<int32_t>(t) && i + 1 > last_used) {
+            last_used = i + 1;
+          }
+        }
+      }
+    }
+    if (first_created < 0) {
+      // Not produced by anything in this subgraph.
+      continue;
+    }
+    if (last_used < first_created) {
+      last_used = first_created;
+    }
+
+    size_t bytes = FlatbufferTensorBytes(tensor);
+    const size_t alignment = MicroArenaBufferAlignment();
+    bytes = ((bytes + alignment - 1) / alignment) * alignment;
+    TF_LITE_ENSURE_STATUS(planner->AddBuffer(static_cast<int>(bytes),
+                                             first_created, last_used));
+  }
+  return kTfLiteOk;
+}
+
+// Plans each model with an OptimalMemoryPlanner and with a
+// GreedyMemoryPlanner, one after the other in `scratch`, and records both
+// arena sizes.
+inline TfLiteStatus BenchmarkMemoryPlanners(
+    const Model* const* models, int model_count, unsigned char* scratch,
+    int scratch_size, int max_search_steps, uint32_t max_search_ticks,
+    MemoryPlannerBenchmarkResult* results) {
+  for (int i = 0; i < model_count; ++i) {
+    OptimalMemoryPlanner planner;
+    planner.SetSearchBudget(max_search_steps, max_search_ticks);
+    TF_LITE_ENSURE_STATUS(planner.Init(scratch, scratch_size));
+    TF_LITE_ENSURE_STATUS(AddModelBuffersToPlanner(models[i], &planner));
+
+    MemoryPlannerBenchmarkResult* result = &results[i];
+    result->buffer_count = planner.GetBufferCount();
+    result->optimal_bytes = planner.GetMaximumMemorySize();
+    result->lower_bound_bytes = planner.GetLowerBoundMemorySize();
+    result->is_proven_optimal = planner.IsPlanProvenOptimal();
+    result->search_steps = planner.GetSearchSteps();
+
+    GreedyMemoryPlanner greedy_planner;
+    TF_LITE_ENSURE_STATUS(greedy_planner.Init(scratch, scratch_size));
+    TF_LITE_ENSURE_STATUS(AddModelBuffersToPlanner(models[i], &greedy_planner));
+    result->greedy_bytes = greedy_planner.GetMaximumMemorySize();
+  }
+  return kTfLiteOk;
+}
+
+// Prints the benchmark results as CSV, one line per model, followed by the
+// total over the corpus.
+inline void PrintMemoryPlannerBenchmark(
+    const MemoryPlannerBenchmarkResult* results, int model_count) {
+  size_t total_greedy = 0;
+  size_t total_optimal = 0;
+  // The planners lay out buffers differently, so saved_bytes can be negative.
+  MicroPrintf(
+      "model,buffers,greedy_bytes,optimal_bytes,lower_bound_bytes,"
+      "saved_bytes,proven_optimal,search_steps");
+  for (int i = 0; i < model_count; ++i) {
+    const MemoryPlannerBenchmarkResult& r = results[i];
+    MicroPrintf("%d,%d,%u,%u,%u,%d,%d,%d", i, r.buffer_count,
+                static_cast<unsigned>(r.greedy_bytes),
+                static_cast<unsigned>(r.optimal_bytes),
+                static_cast<unsigned>(r.lower_bound_bytes),
+                static_cast<int>(r.greedy_bytes) -
+                    static_cast<int>(r.optimal_bytes),
+                r.is_proven_optimal ? 1 : 0, r.search_steps);
+    total_greedy += r.greedy_bytes;
+    total_optimal += r.optimal_bytes;
+  }
+  MicroPrintf("total,,%u,%u,,%d,,", static_cast<unsigned>(total_greedy),
+              static_cast<unsigned>(total_optimal),
+              static_cast<int>(total_greedy) - static_cast<int>(total_optimal));
+}
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_MEMORY_PLANNER_BENCHMARK_H_
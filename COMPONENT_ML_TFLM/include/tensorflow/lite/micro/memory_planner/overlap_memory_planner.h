@@ -0,0 +1,224 @@
+/* Copyright 2025 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_OVERLAP_MEMORY_PLANNER_H_
+#define TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_OVERLAP_MEMORY_PLANNER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/compatibility.h"
+#include "tensorflow/lite/micro/flatbuffer_utils.h"
+#include "tensorflow/lite/micro/memory_planner/micro_memory_planner.h"
+#include "tensorflow/lite/micro/memory_planner/recording_memory_planner.h"
+#include "tensorflow/lite/micro/micro_async_accelerator.h"
+#include "tensorflow/lite/micro/micro_log.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+
+/*   This is an experimental feature and subjected to change.
+ *
+The OverlapMemoryPlanner prepares the arena plan for
+MicroInterpreter::InvokeOverlapped(). In that mode the CPU runs operator i + 1
+while operator i still runs on the accelerator, so every buffer operator i
+uses has to stay valid while operator i + 1 runs. A plain plan lets operator
+i + 1 reuse the inputs that die at operator i, the scratch buffers of
+operator i and outputs of operator i nobody consumes.
+
+For every accelerated operator followed by an independent CPU operator, this
+planner extends the lifetime of all buffers whose last use is the accelerated
+operator to the CPU operator, and forwards the buffers to the wrapped planner.
+Like the AliasingMemoryPlanner, the times of the operators are taken from the
+buffers of their output tensors, using a buffer to tensor mapping that is
+verified against the model. Planning fails if the mapping can't be verified.
+InvokeOverlapped() only overlaps operators if IsOverlapPlanned() reports that
+the lifetimes of every overlap candidate were extended.
+
+Example:
+
+  tflite::MicroAsyncAcceleratorEmulator accelerator;
+  accelerator.AccelerateDefaultNNLiteOps();
+  tflite::GreedyMemoryPlanner greedy;
+  tflite::OverlapMemoryPlanner planner(&greedy, model, &accelerator);
+  tflite::MicroInterpreter interpreter(model, resolver,
+      tflite::MicroAllocator::Create(arena, arena_size, &planner));
+  interpreter.AllocateTensors();
+  interpreter.InvokeOverlapped(&accelerator, &planner);
+
+Only models with a single subgraph and no offline planned buffers can be
+planned.
+*/
+class OverlapMemoryPlanner : public RecordingMemoryPlanner {
+ public:
+  // Does not take ownership of planner, model or accelerator, which must
+  // outlive this object.
+  OverlapMemoryPlanner(MicroMemoryPlanner* planner, const Model* model,
+                       const MicroAsyncAccelerator* accelerator)
+      : RecordingMemoryPlanner(planner, model, "overlap"),
+        accelerator_(accelerator),
+        extended_buffer_count_(0),
+        is_overlap_planned_(false) {}
+  ~OverlapMemoryPlanner() override {}
+
+  TfLiteStatus Init(unsigned char* scratch_buffer,
+                    int scratch_buffer_size) override {
+    extended_buffer_count_ = 0;
+    is_overlap_planned_ = false;
+    return RecordingMemoryPlanner::Init(scratch_buffer, scratch_buffer_size);
+  }
+
+  void PrintMemoryPlan() override {
+    MicroPrintf("Overlap planner: %d of %d buffers kept alive for overlap",
+                extended_buffer_count_, buffer_count_);
+    planner_->PrintMemoryPlan();
+  }
+
+  // Number of buffers whose lifetime was extended.
+  int GetExtendedBufferCount() {
+    ForwardBuffersIfNeeded();
+    return extended_buffer_count_;
+  }
+
+  // Returns true once the plan keeps the buffers of every accelerated
+  // operator of `accelerator` alive while the following CPU operator runs.
+  // Only valid after planning; doesn't touch the scratch memory.
+  bool IsOverlapPlanned(const MicroAsyncAccelerator* accelerator) const {
+    return is_overlap_planned_ && accelerator == accelerator_;
+  }
+
+ private:
+  bool IsAccelerated(const Operator* op) const {
+    const BuiltinOperator code = FlatbufferOperatorBuiltinCode(model_, op);
+    const char* custom_name = nullptr;
+    if (code == BuiltinOperator_CUSTOM) {
+      const OperatorCode* opcode =
+          model_->operator_codes()->Get(op->opcode_index());
+      if (opcode->custom_code() != nullptr) {
+        custom_name = opcode->custom_code()->c_str();
+      }
+    }
+    return accelerator_->IsAccelerated(code, custom_name);
+  }
+
+  // Returns true if `op` writes `tensor`: outputs, intermediates and
+  // variable inputs.
+  bool IsWrittenTensor(const Operator* op, int32_t tensor) const {
+    return FlatbufferVectorContains(op->outputs(), tensor) ||
+           FlatbufferVectorContains(op->intermediates(), tensor) ||
+           model_->subgraphs()->Get(0)->tensors()->Get(tensor)->is_variable();
+  }
+
+  // Static counterpart of the check the interpreter does before it overlaps
+  // two operators: no tensor written by one of them is used by the other.
+  bool AreOperatorsIndependent(const Operator* first,
+                               const Operator* second) const {
+    const flatbuffers::Vector<int32_t>* first_lists[] = {
+        first->inputs(), first->outputs(), first->intermediates()};
+    const flatbuffers::Vector<int32_t>* second_lists[] = {
+        second->inputs(), second->outputs(), second->intermediates()};
+    for (const auto* first_list : first_lists) {
+      if (first_list == nullptr) continue;
+      for (int32_t tensor : *first_list) {
+        if (tensor < 0) continue;
+        for (const auto* second_list : second_lists) {
+          if (!FlatbufferVectorContains(second_list, tensor)) continue;
+          if (IsWrittenTensor(first, tensor) ||
+              IsWrittenTensor(second, tensor)) {
+            return false;
+          }
+        }
+      }
+    }
+    return true;
+  }
+
+  // Returns the time the MicroAllocator assigned to `op`, taken from the
+  // buffer of its first arena planned output, or -1.
+  int OperatorTime(const Operator* op) const {
+    if (op->outputs() == nullptr) {
+      return -1;
+    }
+    for (int32_t output : *op->outputs()) {
+      if (BufferOf(output) >= 0) {
+        return records_[BufferOf(output)].first_time_used;
+      }
+    }
+    return -1;
+  }
+
+  // Returns false if an overlap candidate could not be extended.
+  bool ExtendLifetimes() {
+    const auto* operators = model_->subgraphs()->Get(0)->operators();
+    if (operators == nullptr) {
+      return true;
+    }
+    for (size_t i = 0; i + 1 < operators->size(); ++i) {
+      const Operator* op = operators->Get(i);
+      const Operator* next = operators->Get(i + 1);
+      if (!IsAccelerated(op) || IsAccelerated(next) ||
+          !MicroAsyncAccelerator::MayOverlap(
+              FlatbufferOperatorBuiltinCode(model_, op)) ||
+          !MicroAsyncAccelerator::MayOverlap(
+              FlatbufferOperatorBuiltinCode(model_, next)) ||
+          !AreOperatorsIndependent(op, next)) {
+        continue;
+      }
+      const int time = OperatorTime(op);
+      const int next_time = OperatorTime(next);
+      if (time < 0 || next_time <= time) {
+        return false;
+      }
+      for (int b = 0; b < buffer_count_; ++b) {
+        BufferRecord& record = records_[b];
+        if (record.first_time_used <= time &&
+            record.planned_last_time_used == time) {
+          record.planned_last_time_used = next_time;
+          ++extended_buffer_count_;
+        }
+      }
+    }
+    return true;
+  }
+
+  TfLiteStatus PlanBuffers() override {
+    extended_buffer_count_ = 0;
+    is_overlap_planned_ = false;
+    if (accelerator_ == nullptr) {
+      return kTfLiteOk;
+    }
+    if (!HasSingleSubgraph() || !MapTensorsToBuffers()) {
+      MicroPrintf(
+          "Overlap planner: buffers don't match the model, can't plan "
+          "overlapped execution");
+      return kTfLiteError;
+    }
+    is_overlap_planned_ = ExtendLifetimes();
+    return kTfLiteOk;
+  }
+
+  const MicroAsyncAccelerator* accelerator_;  // not owned
+
+  int extended_buffer_count_;
+  bool is_overlap_planned_;
+
+ public:
+  TF_LITE_REMOVE_VIRTUAL_DELETE
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_OVERLAP_MEMORY_PLANNER_H_
@@ -0,0 +1,327 @@
+/* Copyright 2025 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_RECORDING_MEMORY_PLANNER_H_
+#define TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_RECORDING_MEMORY_PLANNER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/compatibility.h"
+#include "tensorflow/lite/micro/flatbuffer_utils.h"
+#include "tensorflow/lite/micro/memory_planner/greedy_memory_planner.h"
+#include "tensorflow/lite/micro/memory_planner/micro_memory_planner.h"
+#include "tensorflow/lite/micro/micro_arena_constants.h"
+#include "tensorflow/lite/micro/micro_log.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+
+/*   This is an experimental feature and subjected to change.
+ *
+Base class of the planners that rewrite the buffers the MicroAllocator adds
+before another planner lays them out: the AliasingMemoryPlanner,
+ExternalIoMemoryPlanner, FusionMemoryPlanner and OverlapMemoryPlanner.
+
+The MicroAllocator only passes sizes and lifetimes to the memory planner. This
+planner records all buffers first and, once the plan is queried, maps the
+tensors of the first subgraph of the model to their buffers, lets the derived
+class rewrite the planned size and lifetime of the buffers in PlanBuffers(),
+and forwards them to the wrapped planner. A buffer can also reuse the memory
+of another buffer by setting its root, in which case it isn't forwarded.
+
+A buffer added after the others were forwarded starts a new planning pass on
+the recorded buffers, with the wrapped planner initialized again.
+*/
+class RecordingMemoryPlanner : public MicroMemoryPlanner {
+ public:
+  // Splits the scratch memory between this planner, which needs
+  // per_buffer_size() bytes per buffer plus one int per tensor, and the
+  // wrapped planner.
+  TfLiteStatus Init(unsigned char* scratch_buffer,
+                    int scratch_buffer_size) override {
+    buffer_count_ = 0;
+    need_to_forward_buffers_ = true;
+    buffers_forwarded_ = false;
+    forward_status_ = kTfLiteOk;
+
+    const int tensor_map_size =
+        static_cast<int>(AlignUp(sizeof(int) * tensor_count_));
+    if (scratch_buffer_size < tensor_map_size) {
+      MicroPrintf("Scratch buffer too small for the %s planner", name_);
+      return kTfLiteError;
+    }
+    tensor_to_buffer_ = reinterpret_cast<int*>(scratch_buffer);
+    const int remaining = scratch_buffer_size - tensor_map_size;
+
+    const size_t wrapped_per_buffer = planner_->GetPerBufferSize();
+    max_buffer_count_ =
+        wrapped_per_buffer > 0
+            ? static_cast<int>(remaining /
+                               (per_buffer_size() + wrapped_per_buffer))
+            : static_cast<int>(remaining / 2 / per_buffer_size());
+    records_ =
+        reinterpret_cast<BufferRecord*>(scratch_buffer + tensor_map_size);
+    const int records_size = static_cast<int>(
+        AlignUp(sizeof(BufferRecord) * max_buffer_count_));
+    wrapped_scratch_buffer_ = scratch_buffer + tensor_map_size + records_size;
+    wrapped_scratch_buffer_size_ = remaining - records_size;
+    return planner_->Init(wrapped_scratch_buffer_,
+                          wrapped_scratch_buffer_size_);
+  }
+
+  // Buffers are only recorded here. They are forwarded to the wrapped planner
+  // once all of them are known.
+  TfLiteStatus AddBuffer(int size, int first_time_used,
+                         int last_time_used) override {
+    return AddBuffer(size, first_time_used, last_time_used,
+                     kOnlinePlannedBuffer);
+  }
+
+  TfLiteStatus AddBuffer(int size, int first_time_used, int last_time_used,
+                         int offline_offset) override {
+    if (buffer_count_ >= max_buffer_count_) {
+      MicroPrintf("Too many buffers (max is %d)", max_buffer_count_);
+      return kTfLiteError;
+    }
+    BufferRecord* record = &records_[buffer_count_++];
+    record->size = size;
+    record->first_time_used = first_time_used;
+    record->last_time_used = last_time_used;
+    record->offline_offset = offline_offset;
+    need_to_forward_buffers_ = true;
+    return kTfLiteOk;
+  }
+
+  size_t GetMaximumMemorySize() override {
+    if (ForwardBuffersIfNeeded() != kTfLiteOk) {
+      return 0;
+    }
+    return planner_->GetMaximumMemorySize();
+  }
+
+  int GetBufferCount() override { return buffer_count_; }
+
+  TfLiteStatus GetOffsetForBuffer(int buffer_index, int* offset) override {
+    TF_LITE_ENSURE_STATUS(ForwardBuffersIfNeeded());
+    if ((buffer_index < 0) || (buffer_index >= buffer_count_)) {
+      MicroPrintf("buffer index %d is outside range 0 to %d", buffer_index,
+                  buffer_count_);
+      return kTfLiteError;
+    }
+    const BufferRecord& record = records_[buffer_index];
+    const int source = record.root >= 0 ? record.root : buffer_index;
+    return planner_->GetOffsetForBuffer(records_[source].forwarded_index,
+                                        offset);
+  }
+
+  bool preserves_all_tensors() const override {
+    return planner_->preserves_all_tensors();
+  }
+
+  size_t GetPerBufferSize() override {
+    return per_buffer_size() + planner_->GetPerBufferSize();
+  }
+
+  // Number of bytes this planner needs per buffer, excluding the wrapped
+  // planner.
+  static size_t per_buffer_size() { return sizeof(BufferRecord); }
+
+ protected:
+  struct BufferRecord {
+    // As added by the MicroAllocator.
+    int size;
+    int first_time_used;
+    int last_time_used;
+    int offline_offset;
+    // As forwarded to the wrapped planner. Reset to the values above before
+    // every PlanBuffers().
+    int planned_size;
+    int planned_last_time_used;
+    // Buffer whose memory this buffer reuses, or -1. Must be a buffer with
+    // root -1 that is used until this buffer dies.
+    int root;
+    // Index in the wrapped planner, valid for buffers with root -1.
+    int forwarded_index;
+  };
+
+  // Does not take ownership of planner or model, which must outlive this
+  // object. `name` is used in messages.
+  RecordingMemoryPlanner(MicroMemoryPlanner* planner, const Model* model,
+                         const char* name)
+      : planner_(planner),
+        model_(model),
+        name_(name),
+        tensor_count_(0),
+        max_buffer_count_(0),
+        buffer_count_(0),
+        tensor_to_buffer_(nullptr),
+        records_(nullptr),
+        wrapped_scratch_buffer_(nullptr),
+        wrapped_scratch_buffer_size_(0),
+        need_to_forward_buffers_(true),
+        buffers_forwarded_(false),
+        forward_status_(kTfLiteOk) {
+    if (model_ != nullptr && model_->subgraphs() != nullptr &&
+        model_->subgraphs()->size() > 0 &&
+        model_->subgraphs()->Get(0)->tensors() != nullptr) {
+      tensor_count_ = model_->subgraphs()->Get(0)->tensors()->size();
+    }
+  }
+  ~RecordingMemoryPlanner() override {}
+
+  // Rewrites the planned sizes, lifetimes and roots of the recorded buffers.
+  // A failure fails the memory plan.
+  virtual TfLiteStatus PlanBuffers() = 0;
+
+  // Called after all buffers were forwarded successfully.
+  virtual void OnBuffersForwarded() {}
+
+  // Plans and forwards the buffers if one was added since the last time.
+  TfLiteStatus ForwardBuffersIfNeeded() {
+    if (!need_to_forward_buffers_) {
+      return forward_status_;
+    }
+    need_to_forward_buffers_ = false;
+    if (buffers_forwarded_) {
+      // A buffer was added after the others were forwarded; start over so
+      // the wrapped planner doesn't get them twice.
+      forward_status_ =
+          planner_->Init(wrapped_scratch_buffer_, wrapped_scratch_buffer_size_);
+      if (forward_status_ != kTfLiteOk) {
+        return forward_status_;
+      }
+    }
+    buffers_forwarded_ = true;
+    for (int i = 0; i < buffer_count_; ++i) {
+      BufferRecord& record = records_[i];
+      record.planned_size = record.size;
+      record.planned_last_time_used = record.last_time_used;
+      record.root = -1;
+      record.forwarded_index = -1;
+    }
+    forward_status_ = PlanBuffers();
+    if (forward_status_ != kTfLiteOk) {
+      return forward_status_;
+    }
+    int forwarded = 0;
+    for (int i = 0; i < buffer_count_; ++i) {
+      BufferRecord& record = records_[i];
+      if (record.root >= 0) {
+        continue;
+      }
+      forward_status_ =
+          record.offline_offset == kOnlinePlannedBuffer
+              ? planner_->AddBuffer(record.planned_size,
+                                    record.first_time_used,
+                                    record.planned_last_time_used)
+              : planner_->AddBuffer(record.planned_size,
+                                    record.first_time_used,
+                                    record.planned_last_time_used,
+                                    record.offline_offset);
+      if (forward_status_ != kTfLiteOk) {
+        return forward_status_;
+      }
+      record.forwarded_index = forwarded++;
+    }
+    OnBuffersForwarded();
+    return forward_status_;
+  }
+
+  bool HasSingleSubgraph() const {
+    return model_ != nullptr && model_->subgraphs() != nullptr &&
+           model_->subgraphs()->size() == 1;
+  }
+
+  // The MicroAllocator adds one buffer per arena planned tensor of the first
+  // subgraph, in tensor order, followed by the buffers of other subgraphs and
+  // scratch buffers. Maps the tensors of the first subgraph to their buffers.
+  // Returns false if the buffers don't match the model or a buffer is
+  // offline planned.
+  bool MapTensorsToBuffers() {
+    if (model_ == nullptr || tensor_count_ == 0) {
+      return false;
+    }
+    const auto* tensors = model_->subgraphs()->Get(0)->tensors();
+    int buffer_index = 0;
+    for (int t = 0; t < tensor_count_; ++t) {
+      const Tensor* tensor = tensors->Get(t);
+      if (tensor->is_variable() || FlatbufferTensorHasData(model_, tensor)) {
+        tensor_to_buffer_[t] = -1;
+        continue;
+      }
+      if (buffer_index >= buffer_count_) {
+        return false;
+      }
+      const BufferRecord& record = records_[buffer_index];
+      const size_t alignment = MicroArenaBufferAlignment();
+      const size_t aligned_bytes =
+          ((FlatbufferTensorBytes(tensor) + alignment - 1) / alignment) *
+          alignment;
+      if (record.offline_offset != kOnlinePlannedBuffer ||
+          static_cast<size_t>(record.size) != aligned_bytes) {
+        return false;
+      }
+      tensor_to_buffer_[t] = buffer_index++;
+    }
+    for (int i = buffer_index; i < buffer_count_; ++i) {
+      if (records_[i].offline_offset != kOnlinePlannedBuffer) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Returns the buffer of tensor `tensor` of the first subgraph, or -1. Only
+  // valid after MapTensorsToBuffers() succeeded.
+  int BufferOf(int32_t tensor) const {
+    return tensor >= 0 && tensor < tensor_count_ ? tensor_to_buffer_[tensor]
+                                                 : -1;
+  }
+
+  MicroMemoryPlanner* planner_;  // not owned, can't be null
+  const Model* model_;           // not owned
+  const char* name_;
+  int tensor_count_;
+  int max_buffer_count_;
+  int buffer_count_;
+
+  // Working arrays in the scratch memory given to Init().
+  int* tensor_to_buffer_;
+  BufferRecord* records_;
+
+ private:
+  static size_t AlignUp(size_t size) {
+    constexpr size_t kAlignment = alignof(BufferRecord);
+    return ((size + kAlignment - 1) / kAlignment) * kAlignment;
+  }
+
+  // Scratch memory of the wrapped planner, to initialize it again when the
+  // buffers are forwarded again.
+  unsigned char* wrapped_scratch_buffer_;
+  int wrapped_scratch_buffer_size_;
+
+  bool need_to_forward_buffers_;
+  bool buffers_forwarded_;
+  TfLiteStatus forward_status_;
+
+ public:
+  TF_LITE_REMOVE_VIRTUAL_DELETE
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_RECORDING_MEMORY_PLANNER_H_
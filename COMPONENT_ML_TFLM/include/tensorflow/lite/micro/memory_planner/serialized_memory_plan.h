@@ -0,0 +1,409 @@
+/* Copyright 2025 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_SERIALIZED_MEMORY_PLAN_H_
+#define TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_SERIALIZED_MEMORY_PLAN_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/compatibility.h"
+#include "tensorflow/lite/micro/memory_planner/memory_plan_struct.h"
+#include "tensorflow/lite/micro/memory_planner/micro_memory_planner.h"
+#include "tensorflow/lite/micro/memory_planner/non_persistent_buffer_planner_shim.h"
+#include "tensorflow/lite/micro/micro_log.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+
+/*   This is an experimental feature and subjected to change.
+ *
+Captures the memory plan of a model into a compact binary blob on one boot and
+reuses it on later boots, so that MicroAllocator::FinishModelAllocation() does
+not have to run the memory planner again.
+
+The buffer list the MicroAllocator passes to a MicroMemoryPlanner is the
+activation tensors followed by the kernel scratch buffer requests, so the plan
+covers the offsets of the scratch buffer handles as well.
+
+Recording, e.g. on the first boot or on a development board:
+
+  alignas(4) static uint8_t plan_blob[2048];
+  tflite::GreedyMemoryPlanner greedy;
+  tflite::MemoryPlanRecorder recorder(&greedy, plan_blob, sizeof(plan_blob));
+  tflite::MicroAllocator* allocator =
+      tflite::MicroAllocator::Create(arena, arena_size, &recorder);
+  tflite::MicroInterpreter interpreter(model, resolver, allocator);
+  interpreter.AllocateTensors();
+  size_t plan_bytes = recorder.Finish(model);  // Store plan_blob[0..plan_bytes)
+
+Reusing, on later boots:
+
+  if (tflite::ValidateSerializedMemoryPlan(model, stored_plan, stored_bytes) ==
+      kTfLiteOk) {
+    static tflite::SerializedMemoryPlannerShim planner(stored_plan);
+    allocator = tflite::MicroAllocator::Create(arena, arena_size, &planner);
+  }
+
+The blob is laid out as a SerializedMemoryPlanHeader, followed by the size of
+every buffer as int32_t, followed by a BufferPlan. All fields are 32-bit and
+native endian. GetBufferPlanFromSerializedMemoryPlan() returns the embedded
+BufferPlan for use with a plain NonPersistentMemoryPlannerShim.
+*/
+
+constexpr uint32_t kSerializedMemoryPlanMagic = 0x504d4654;  // "TFMP"
+constexpr uint32_t kSerializedMemoryPlanVersion = 1;
+
+struct SerializedMemoryPlanHeader {
+  uint32_t magic;
+  uint32_t version;
+  // ComputeModelPlanHash() of the model the plan was recorded for.
+  uint32_t model_hash;
+  // High-water mark of the plan in bytes.
+  uint32_t arena_bytes;
+  // Number of planned buffers, including scratch buffers.
+  int32_t buffer_count;
+};
+
+// Returns the size of a serialized memory plan for a given buffer count.
+constexpr size_t SizeOfSerializedMemoryPlan(int32_t buffer_count) {
+  return sizeof(SerializedMemoryPlanHeader) +
+         sizeof(int32_t) * Max(buffer_count, 0) +
+         SizeOfBufferPlan(buffer_count);
+}
+
+// Hashes everything in a model that the memory plan depends on: tensor types,
+// shapes and constness, variable flags and the operator graph of every
+// subgraph. Changes to weight values do not affect the hash. FNV-1a is used
+// since it's small and needs no tables.
+inline uint32_t ComputeModelPlanHash(const Model* model) {
+  uint32_t hash = 2166136261u;
+  auto mix = [&hash](uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+      hash ^= (value >> (8 * i)) & 0xff;
+      hash *= 16777619u;
+    }
+  };
+  auto mix_vector = [&mix](const flatbuffers::Vector<int32_t>* values) {
+    if (values == nullptr) {
+      mix(0xffffffff);
+      return;
+    }
+    mix(values->size());
+    for (int32_t value : *values) {
+      mix(static_cast<uint32_t>(value));
+    }
+  };
+
+  mix(model->version());
+  const auto* subgraphs = model->subgraphs();
+  if (subgraphs == nullptr) {
+    return hash;
+  }
+  const auto* buffers = model->buffers();
+  mix(subgraphs->size());
+  for (const SubGraph* subgraph : *subgraphs) {
+    const auto* tensors = subgraph->tensors();
+    mix(tensors == nullptr ? 0 : tensors->size());
+    if (tensors != nullptr) {
+      for (const Tensor* tensor : *tensors) {
+        bool has_data = false;
+        if (buffers != nullptr && tensor->buffer() < buffers->size()) {
+          const Buffer* buffer = buffers->Get(tensor->buffer());
+          has_data = buffer != nullptr &&
+                     ((buffer->data() != nullptr && buffer->data()->size()) ||
+                      buffer->offset() > 1);
+        }
+        mix(static_cast<uint32_t>(tensor->type()));
+        mix((tensor->is_variable() ? 1u : 0u) | (has_data ? 2u : 0u));
+        mix_vector(tensor->shape());
+      }
+    }
+    mix_vector(subgraph->inputs());
+    mix_vector(subgraph->outputs());
+    const auto* operators = subgraph->operators();
+    mix(operators == nullptr ? 0 : operators->size());
+    if (operators != nullptr) {
+      for (const Operator* op : *operators) {
+        mix(op->opcode_index());
+        mix_vector(op->inputs());
+        mix_vector(op->outputs());
+        mix_vector(op->intermediates());
+      }
+    }
+  }
+  return hash;
+}
+
+namespace internal {
+
+inline const SerializedMemoryPlanHeader* SerializedMemoryPlanHeaderOf(
+    const uint8_t* serialized_plan) {
+  return reinterpret_cast<const SerializedMemoryPlanHeader*>(serialized_plan);
+}
+
+inline const int32_t* SerializedMemoryPlanSizes(const uint8_t* serialized_plan) {
+  return reinterpret_cast<const int32_t*>(serialized_plan +
+                                          sizeof(SerializedMemoryPlanHeader));
+}
+
+}  // namespace internal
+
+// Returns the BufferPlan embedded in a serialized memory plan. The plan must
+// have been checked with ValidateSerializedMemoryPlan().
+inline const BufferPlan* GetBufferPlanFromSerializedMemoryPlan(
+    const uint8_t* serialized_plan) {
+  const int32_t buffer_count =
+      internal::SerializedMemoryPlanHeaderOf(serialized_plan)->buffer_count;
+  return reinterpret_cast<const BufferPlan*>(
+      internal::SerializedMemoryPlanSizes(serialized_plan) + buffer_count);
+}
+
+// Checks that a serialized memory plan is well formed and was recorded for a
+// model with the same memory layout requirements as `model`. Stale plans must
+// be rejected, a plan that doesn't match the model corrupts tensors.
+inline TfLiteStatus ValidateSerializedMemoryPlan(const Model* model,
+                                                 const uint8_t* serialized_plan,
+                                                 size_t serialized_plan_size) {
+  if (serialized_plan == nullptr ||
+      serialized_plan_size < sizeof(SerializedMemoryPlanHeader) ||
+      reinterpret_cast<uintptr_t>(serialized_plan) % alignof(int32_t) != 0) {
+    MicroPrintf("Serialized memory plan is missing or misaligned");
+    return kTfLiteError;
+  }
+  const SerializedMemoryPlanHeader* header =
+      internal::SerializedMemoryPlanHeaderOf(serialized_plan);
+  if (header->magic != kSerializedMemoryPlanMagic ||
+      header->version != kSerializedMemoryPlanVersion) {
+    MicroPrintf("Serialized memory plan has an unsupported format");
+    return kTfLiteError;
+  }
+  if (header->buffer_count < 0 ||
+      SizeOfSerializedMemoryPlan(header->buffer_count) > serialized_plan_size) {
+    MicroPrintf("Serialized memory plan is truncated");
+    return kTfLiteError;
+  }
+  const BufferPlan* buffer_plan =
+      GetBufferPlanFromSerializedMemoryPlan(serialized_plan);
+  if (buffer_plan->buffer_count != header->buffer_count) {
+    MicroPrintf("Serialized memory plan is inconsistent");
+    return kTfLiteError;
+  }
+  if (header->model_hash != ComputeModelPlanHash(model)) {
+    MicroPrintf("Serialized memory plan was recorded for a different model");
+    return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
+// A MicroMemoryPlanner that forwards to another planner and records the
+// resulting plan into a caller-provided buffer. The offsets are captured when
+// the MicroAllocator first reads the plan, because the wrapped planner keeps
+// them in arena scratch memory that is overwritten afterwards.
+class MemoryPlanRecorder : public MicroMemoryPlanner {
+ public:
+  // Does not take ownership of planner or plan_buffer, which must outlive
+  // this object. plan_buffer must be 4 byte aligned.
+  MemoryPlanRecorder(MicroMemoryPlanner* planner, uint8_t* plan_buffer,
+                     size_t plan_buffer_size)
+      : planner_(planner),
+        plan_buffer_(plan_buffer),
+        max_buffer_count_(0),
+        buffer_count_(0),
+        arena_bytes_(0),
+        offsets_captured_(false),
+        capture_status_(kTfLiteOk) {
+    const size_t fixed_size = sizeof(SerializedMemoryPlanHeader) +
+                              sizeof(BufferPlan) - sizeof(BufferDescriptor);
+    if (plan_buffer_size > fixed_size) {
+      max_buffer_count_ = static_cast<int>(
+          (plan_buffer_size - fixed_size) /
+          (sizeof(int32_t) + sizeof(BufferDescriptor)));
+    }
+  }
+  ~MemoryPlanRecorder() override {}
+
+  TfLiteStatus Init(unsigned char* scratch_buffer,
+                    int scratch_buffer_size) override {
+    buffer_count_ = 0;
+    offsets_captured_ = false;
+    return planner_->Init(scratch_buffer, scratch_buffer_size);
+  }
+
+  TfLiteStatus AddBuffer(int size, int first_time_used,
+                         int last_time_used) override {
+    TF_LITE_ENSURE_STATUS(RecordSize(size));
+    return planner_->AddBuffer(size, first_time_used, last_time_used);
+  }
+
+  TfLiteStatus AddBuffer(int size, int first_time_used, int last_time_used,
+                         int offline_offset) override {
+    TF_LITE_ENSURE_STATUS(RecordSize(size));
+    return planner_->AddBuffer(size, first_time_used, last_time_used,
+                               offline_offset);
+  }
+
+  size_t GetMaximumMemorySize() override {
+    CaptureOffsetsIfNeeded();
+    return planner_->GetMaximumMemorySize();
+  }
+
+  int GetBufferCount() override { return planner_->GetBufferCount(); }
+
+  TfLiteStatus GetOffsetForBuffer(int buffer_index, int* offset) override {
+    CaptureOffsetsIfNeeded();
+    return planner_->GetOffsetForBuffer(buffer_index, offset);
+  }
+
+  bool preserves_all_tensors() const override {
+    return planner_->preserves_all_tensors();
+  }
+
+  void PrintMemoryPlan() override { planner_->PrintMemoryPlan(); }
+
+  size_t GetPerBufferSize() override { return planner_->GetPerBufferSize(); }
+
+  // Completes the serialized plan with the header for `model`. Must be called
+  // after MicroInterpreter::AllocateTensors(). Returns the number of valid
+  // bytes in the plan buffer, or 0 if no plan could be recorded.
+  size_t Finish(const Model* model) {
+    if (!offsets_captured_ || capture_status_ != kTfLiteOk) {
+      MicroPrintf("No memory plan was recorded");
+      return 0;
+    }
+    SerializedMemoryPlanHeader* header =
+        reinterpret_cast<SerializedMemoryPlanHeader*>(plan_buffer_);
+    header->magic = kSerializedMemoryPlanMagic;
+    header->version = kSerializedMemoryPlanVersion;
+    header->model_hash = ComputeModelPlanHash(model);
+    header->arena_bytes = static_cast<uint32_t>(arena_bytes_);
+    header->buffer_count = buffer_count_;
+    return SizeOfSerializedMemoryPlan(buffer_count_);
+  }
+
+ private:
+  int32_t* sizes() {
+    return reinterpret_cast<int32_t*>(plan_buffer_ +
+                                      sizeof(SerializedMemoryPlanHeader));
+  }
+
+  TfLiteStatus RecordSize(int size) {
+    if (buffer_count_ >= max_buffer_count_) {
+      MicroPrintf("Memory plan buffer too small (max is %d buffers)",
+                  max_buffer_count_);
+      capture_status_ = kTfLiteError;
+      return kTfLiteError;
+    }
+    sizes()[buffer_count_++] = size;
+    offsets_captured_ = false;
+    return kTfLiteOk;
+  }
+
+  void CaptureOffsetsIfNeeded() {
+    if (offsets_captured_) {
+      return;
+    }
+    offsets_captured_ = true;
+    // The sizes are final now, so the BufferPlan goes right after them.
+    BufferPlan* buffer_plan =
+        reinterpret_cast<BufferPlan*>(sizes() + buffer_count_);
+    buffer_plan->buffer_count = buffer_count_;
+    for (int i = 0; i < buffer_count_; ++i) {
+      int offset = 0;
+      if (planner_->GetOffsetForBuffer(i, &offset) != kTfLiteOk) {
+        capture_status_ = kTfLiteError;
+        return;
+      }
+      buffer_plan->buffer_plan_entries[i].offset = offset;
+    }
+    arena_bytes_ = planner_->GetMaximumMemorySize();
+  }
+
+  MicroMemoryPlanner* planner_;  // not owned, can't be null
+  uint8_t* plan_buffer_;         // not owned, can't be null
+  int max_buffer_count_;
+  int buffer_count_;
+  size_t arena_bytes_;
+  bool offsets_captured_;
+  TfLiteStatus capture_status_;
+
+ public:
+  TF_LITE_REMOVE_VIRTUAL_DELETE
+};
+
+// A NonPersistentMemoryPlannerShim that reads its BufferPlan from a serialized
+// memory plan. Unlike the plain shim it also rejects buffers larger than the
+// ones the plan was recorded for, and reports the recorded high-water mark so
+// the MicroAllocator reserves the right amount of arena.
+class SerializedMemoryPlannerShim : public NonPersistentMemoryPlannerShim {
+ public:
+  // Does not take ownership of serialized_plan, which must have been checked
+  // with ValidateSerializedMemoryPlan() and must outlive this object.
+  explicit SerializedMemoryPlannerShim(const uint8_t* serialized_plan)
+      : NonPersistentMemoryPlannerShim(
+            GetBufferPlanFromSerializedMemoryPlan(serialized_plan)),
+        serialized_plan_(serialized_plan),
+        buffer_count_(0) {}
+  ~SerializedMemoryPlannerShim() override {}
+
+  TfLiteStatus AddBuffer(int size, int first_time_used,
+                         int last_time_used) override {
+    const SerializedMemoryPlanHeader* header =
+        internal::SerializedMemoryPlanHeaderOf(serialized_plan_);
+    if (buffer_count_ >= header->buffer_count ||
+        size > internal::SerializedMemoryPlanSizes(
+                   serialized_plan_)[buffer_count_]) {
+      MicroPrintf("Buffer %d (%d bytes) does not match the serialized plan",
+                  buffer_count_, size);
+      return kTfLiteError;
+    }
+    ++buffer_count_;
+    return NonPersistentMemoryPlannerShim::AddBuffer(size, first_time_used,
+                                                     last_time_used);
+  }
+
+  // Offline planned offsets are already part of the serialized plan, they
+  // must match it.
+  TfLiteStatus AddBuffer(int size, int first_time_used, int last_time_used,
+                         int offline_offset) override {
+    const BufferPlan* plan =
+        GetBufferPlanFromSerializedMemoryPlan(serialized_plan_);
+    if (buffer_count_ < plan->buffer_count &&
+        plan->buffer_plan_entries[buffer_count_].offset != offline_offset) {
+      MicroPrintf("Buffer %d offline offset %d does not match the serialized "
+                  "plan",
+                  buffer_count_, offline_offset);
+      return kTfLiteError;
+    }
+    return AddBuffer(size, first_time_used, last_time_used);
+  }
+
+  size_t GetMaximumMemorySize() override {
+    return internal::SerializedMemoryPlanHeaderOf(serialized_plan_)
+        ->arena_bytes;
+  }
+
+ private:
+  const uint8_t* serialized_plan_;  // not owned, can't be null
+  int buffer_count_;
+
+ public:
+  TF_LITE_REMOVE_VIRTUAL_DELETE
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_SERIALIZED_MEMORY_PLAN_H_
@@ -0,0 +1,229 @@
+/* Copyright 2025 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_MICRO_ASYNC_ACCELERATOR_H_
+#define TENSORFLOW_LITE_MICRO_MICRO_ASYNC_ACCELERATOR_H_
+
+#include <cstdint>
+#include <cstring>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/compatibility.h"
+#include "tensorflow/lite/micro/micro_common.h"
+#include "tensorflow/lite/micro/micro_log.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+
+// Signals the completion of an operator submitted to a MicroAsyncAccelerator.
+// May be called from an interrupt handler.
+typedef void (*MicroAsyncCompletionCallback)(void* user_data,
+                                             TfLiteStatus status);
+
+// Interface between the interpreter's overlapped execution mode
+// (MicroInterpreter::InvokeOverlapped()) and an accelerator such as the
+// NNLite NPU.
+//
+// The accelerator declares which operators it executes. While such an
+// operator runs on the accelerator, the interpreter runs the next operator on
+// the CPU if it is independent of the accelerated one, and then waits for the
+// completion callback. Operators are only overlapped with an
+// OverlapMemoryPlanner, which keeps the buffers of the accelerated operator
+// alive while the CPU operator runs.
+class MicroAsyncAccelerator {
+ public:
+  static constexpr int kMaxCustomOps = 4;
+
+  MicroAsyncAccelerator() : custom_op_count_(0) {
+    for (uint32_t& word : accelerated_ops_) {
+      word = 0;
+    }
+  }
+  virtual ~MicroAsyncAccelerator() {}
+
+  // Starts `registration` on `node` and returns without waiting for it.
+  // `callback` must be called exactly once when the operator completed, also
+  // if it failed after being started. Returns an error if the operator could
+  // not be started, in which case `callback` is not called.
+  virtual TfLiteStatus Submit(TfLiteContext* context, TfLiteNode* node,
+                              const TFLMRegistration* registration,
+                              MicroAsyncCompletionCallback callback,
+                              void* user_data) = 0;
+
+  // Called repeatedly while the interpreter waits for a completion callback.
+  // Implementations typically sleep until the next interrupt (e.g. __WFE()).
+  virtual void WaitForEvent() {}
+
+  // Called after the CPU ran operator `operator_index` while the accelerator
+  // was busy.
+  virtual void OnOverlappedOperator(int /*operator_index*/) {}
+
+  // Declares that the accelerator executes the builtin operator `op`.
+  void Accelerate(BuiltinOperator op) {
+    const int code = static_cast<int>(op);
+    if (code >= 0 && code <= BuiltinOperator_MAX) {
+      accelerated_ops_[code / 32] |= 1u << (code % 32);
+    }
+  }
+
+  // Declares that the accelerator executes the custom operator `name`. The
+  // string must outlive this object.
+  TfLiteStatus AccelerateCustom(const char* name) {
+    if (custom_op_count_ >= kMaxCustomOps) {
+      MicroPrintf("Too many accelerated custom operators (max is %d)",
+                  kMaxCustomOps);
+      return kTfLiteError;
+    }
+    custom_ops_[custom_op_count_++] = name;
+    return kTfLiteOk;
+  }
+
+  // Declares the operators the NNLite kernels offload to the NPU. SOFTMAX
+  // and UNIDIRECTIONAL_SEQUENCE_LSTM run on the CPU.
+  void AccelerateDefaultNNLiteOps() {
+    constexpr BuiltinOperator kNNLiteOps[] = {
+        BuiltinOperator_ADD,
+        BuiltinOperator_AVERAGE_POOL_2D,
+        BuiltinOperator_CONV_2D,
+        BuiltinOperator_DEPTHWISE_CONV_2D,
+        BuiltinOperator_FULLY_CONNECTED,
+        BuiltinOperator_MAX_POOL_2D,
+        BuiltinOperator_MUL,
+        BuiltinOperator_SUB,
+    };
+    for (BuiltinOperator op : kNNLiteOps) {
+      Accelerate(op);
+    }
+  }
+
+  bool IsAccelerated(int32_t builtin_code, const char* custom_name) const {
+    if (builtin_code == BuiltinOperator_CUSTOM) {
+      if (custom_name == nullptr) {
+        return false;
+      }
+      for (int i = 0; i < custom_op_count_; ++i) {
+        if (strcmp(custom_ops_[i], custom_name) == 0) {
+          return true;
+        }
+      }
+      return false;
+    }
+    return builtin_code >= 0 && builtin_code <= BuiltinOperator_MAX &&
+           (accelerated_ops_[builtin_code / 32] &
+            (1u << (builtin_code % 32))) != 0;
+  }
+
+  // Operators that invoke other subgraphs or access resource variables touch
+  // memory that is not visible in their node and are never overlapped.
+  static bool MayOverlap(int32_t builtin_code) {
+    switch (builtin_code) {
+      case BuiltinOperator_ASSIGN_VARIABLE:
+      case BuiltinOperator_CALL_ONCE:
+      case BuiltinOperator_IF:
+      case BuiltinOperator_READ_VARIABLE:
+      case BuiltinOperator_VAR_HANDLE:
+      case BuiltinOperator_WHILE:
+        return false;
+      default:
+        return true;
+    }
+  }
+
+  bool IsAccelerated(const TFLMRegistration* registration) const {
+    return IsAccelerated(registration->builtin_code,
+                         registration->custom_name);
+  }
+
+ private:
+  uint32_t accelerated_ops_[BuiltinOperator_MAX / 32 + 1];
+  const char* custom_ops_[kMaxCustomOps];
+  int custom_op_count_;
+
+ public:
+  TF_LITE_REMOVE_VIRTUAL_DELETE
+};
+
+// Accelerator for host builds and tests. Submit() only queues the operator;
+// it is executed, with the kernel that was registered for it, when the
+// interpreter waits for it. This models an NPU that reads its inputs as late
+// as possible, so an overlapped CPU operator that wrongly overwrites them
+// changes the results compared to a plain Invoke().
+class MicroAsyncAcceleratorEmulator : public MicroAsyncAccelerator {
+ public:
+  MicroAsyncAcceleratorEmulator() { ResetStatistics(); }
+
+  TfLiteStatus Submit(TfLiteContext* context, TfLiteNode* node,
+                      const TFLMRegistration* registration,
+                      MicroAsyncCompletionCallback callback,
+                      void* user_data) override {
+    if (pending_.callback != nullptr) {
+      MicroPrintf("Accelerator busy");
+      return kTfLiteError;
+    }
+    pending_.context = context;
+    pending_.node = node;
+    pending_.registration = registration;
+    pending_.callback = callback;
+    pending_.user_data = user_data;
+    ++submitted_jobs_;
+    return kTfLiteOk;
+  }
+
+  void WaitForEvent() override {
+    if (pending_.callback == nullptr) {
+      return;
+    }
+    Job job = pending_;
+    pending_.callback = nullptr;
+    const TfLiteStatus status =
+        job.registration->invoke(job.context, job.node);
+    job.callback(job.user_data, status);
+  }
+
+  void OnOverlappedOperator(int /*operator_index*/) override {
+    ++overlapped_operators_;
+  }
+
+  void ResetStatistics() {
+    pending_.callback = nullptr;
+    submitted_jobs_ = 0;
+    overlapped_operators_ = 0;
+  }
+
+  // Number of operators executed by the emulator.
+  int submitted_jobs() const { return submitted_jobs_; }
+  // Number of CPU operators that ran while a job was pending.
+  int overlapped_operators() const { return overlapped_operators_; }
+
+ private:
+  struct Job {
+    TfLiteContext* context;
+    TfLiteNode* node;
+    const TFLMRegistration* registration;
+    MicroAsyncCompletionCallback callback;
+    void* user_data;
+  };
+
+  Job pending_;
+  int submitted_jobs_;
+  int overlapped_operators_;
+
+ public:
+  TF_LITE_REMOVE_VIRTUAL_DELETE
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MICRO_ASYNC_ACCELERATOR_H_
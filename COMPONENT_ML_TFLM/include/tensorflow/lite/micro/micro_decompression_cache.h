@@ -0,0 +1,372 @@
+/* Copyright 2025 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_MICRO_DECOMPRESSION_CACHE_H_
+#define TENSORFLOW_LITE_MICRO_MICRO_DECOMPRESSION_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/compatibility.h"
+#include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/micro_ops.h"
+#include "tensorflow/lite/micro/memory_helpers.h"
+#include "tensorflow/lite/micro/micro_arena_constants.h"
+#include "tensorflow/lite/micro/micro_context.h"
+#include "tensorflow/lite/micro/micro_log.h"
+#include "tensorflow/lite/micro/micro_time.h"
+
+namespace tflite {
+
+// Keeps decompressed tensors across invocations, so that weights are not
+// decompressed again on every Invoke(). The cache has a byte budget. When a
+// tensor does not fit, the least recently used entries whose decompression
+// cost per byte is lower than the one of the new tensor are evicted. If
+// evicting all of them would not make room, the new tensor is not cached.
+// Entries used in the current invocation are never evicted: a hit skipped
+// decoding, so the restored pointer would reference undecoded memory.
+//
+// Entries are keyed by an address identifying the tensor, e.g. its
+// TfLiteEvalTensor, and are packed at the start of the cache memory. Evicting
+// an entry moves the entries behind it down.
+//
+// An entry can redirect a pointer, e.g. TfLiteEvalTensor::data.data, to the
+// cached data. The pointer is updated when the entry moves and restored when
+// it is evicted.
+class MicroDecompressionCache {
+ public:
+  static constexpr int kMaxEntries = 32;
+
+  explicit MicroDecompressionCache(size_t budget_bytes)
+      : budget_bytes_(budget_bytes),
+        memory_(nullptr),
+        used_bytes_(0),
+        entry_count_(0),
+        epoch_(0),
+        hits_(0),
+        misses_(0),
+        evictions_(0) {}
+
+  // Uses `buffer` as cache memory instead of alternate decompression memory.
+  // Must be called before the model is prepared.
+  TfLiteStatus SetMemory(void* buffer, size_t bytes) {
+    if (buffer == nullptr || entry_count_ != 0) {
+      return kTfLiteError;
+    }
+    memory_ = static_cast<uint8_t*>(buffer);
+    budget_bytes_ = bytes;
+    return kTfLiteOk;
+  }
+
+  // Allocates the cache memory from the regions registered with
+  // MicroContext::SetDecompressionMemory(), unless SetMemory() was called.
+  // Can only be called during the MicroInterpreter kPrepare state.
+  TfLiteStatus AllocateMemory(MicroContext* micro_context) {
+    if (memory_ != nullptr) {
+      return kTfLiteOk;
+    }
+    memory_ = static_cast<uint8_t*>(micro_context->AllocateDecompressionMemory(
+        budget_bytes_, MicroArenaBufferAlignment()));
+    if (memory_ == nullptr) {
+      MicroPrintf("No decompression memory for a cache of %d bytes.",
+                  static_cast<int>(budget_bytes_));
+      return kTfLiteError;
+    }
+    return kTfLiteOk;
+  }
+
+  // Returns the cached data of `key` or nullptr, and counts a hit or a miss.
+  const void* Find(const void* key) {
+    const int index = IndexOf(key);
+    if (index < 0) {
+      ++misses_;
+      return nullptr;
+    }
+    ++hits_;
+    entries_[index].last_use = epoch_;
+    return memory_ + entries_[index].offset;
+  }
+
+  bool Contains(const void* key) const { return IndexOf(key) >= 0; }
+
+  // Starts a new invocation. Entries found or inserted before become
+  // evictable again.
+  void NextEpoch() { ++epoch_; }
+
+  // Copies `bytes` of `data` into the cache, if the decompression cost per
+  // byte justifies it. `cost` is the time decompression took, in ticks. If
+  // `redirect` is not nullptr, it is pointed at the cached data. Returns the
+  // cached data or nullptr if the tensor is not cached.
+  const void* Insert(const void* key, const void* data, size_t bytes,
+                     uint32_t cost, void** redirect) {
+    if (memory_ == nullptr || key == nullptr || Contains(key)) {
+      return nullptr;
+    }
+    const size_t aligned_bytes =
+        AlignSizeUp(bytes, MicroArenaBufferAlignment());
+    if (aligned_bytes > budget_bytes_) {
+      return nullptr;
+    }
+
+    // Only evict if that makes enough room.
+    size_t free_bytes = budget_bytes_ - used_bytes_;
+    if (free_bytes < aligned_bytes || entry_count_ == kMaxEntries) {
+      size_t evictable_bytes = 0;
+      int evictable_count = 0;
+      for (int i = 0; i < entry_count_; ++i) {
+        if (IsEvictable(entries_[i], cost, bytes)) {
+          evictable_bytes += entries_[i].aligned_bytes;
+          ++evictable_count;
+        }
+      }
+      if (free_bytes + evictable_bytes < aligned_bytes ||
+          (entry_count_ == kMaxEntries && evictable_count == 0)) {
+        return nullptr;
+      }
+      while (free_bytes < aligned_bytes || entry_count_ == kMaxEntries) {
+        int victim = -1;
+        for (int i = 0; i < entry_count_; ++i) {
+          if (IsEvictable(entries_[i], cost, bytes) &&
+              (victim < 0 || entries_[i].last_use < entries_[victim].last_use)) {
+            victim = i;
+          }
+        }
+        Evict(victim);
+        ++evictions_;
+        free_bytes = budget_bytes_ - used_bytes_;
+      }
+    }
+
+    Entry& entry = entries_[entry_count_++];
+    entry.key = key;
+    entry.offset = used_bytes_;
+    entry.bytes = bytes;
+    entry.aligned_bytes = aligned_bytes;
+    entry.cost = cost;
+    entry.last_use = epoch_;
+    entry.redirect = redirect;
+    entry.original = redirect != nullptr ? *redirect : nullptr;
+    used_bytes_ += aligned_bytes;
+
+    uint8_t* cached = memory_ + entry.offset;
+    memcpy(cached, data, bytes);
+    if (redirect != nullptr) {
+      *redirect = cached;
+    }
+    return cached;
+  }
+
+  // Evicts `key`, if it is cached.
+  void Remove(const void* key) {
+    const int index = IndexOf(key);
+    if (index >= 0) {
+      Evict(index);
+    }
+  }
+
+  // Evicts all entries. The cache memory is kept.
+  void Clear() {
+    while (entry_count_ > 0) {
+      Evict(entry_count_ - 1);
+    }
+  }
+
+  size_t budget_bytes() const { return budget_bytes_; }
+  size_t used_bytes() const { return used_bytes_; }
+  int entry_count() const { return entry_count_; }
+  uint32_t hits() const { return hits_; }
+  uint32_t misses() const { return misses_; }
+  uint32_t evictions() const { return evictions_; }
+
+ private:
+  struct Entry {
+    const void* key;
+    size_t offset;
+    size_t bytes;
+    size_t aligned_bytes;
+    uint32_t cost;
+    // Epoch of the last invocation that found or inserted the entry.
+    uint32_t last_use;
+    void** redirect;
+    void* original;
+  };
+
+  int IndexOf(const void* key) const {
+    for (int i = 0; i < entry_count_; ++i) {
+      if (entries_[i].key == key) {
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  // Compares the cost per byte of `entry` to cost / bytes without dividing.
+  static bool IsCheaper(const Entry& entry, uint32_t cost, size_t bytes) {
+    return static_cast<uint64_t>(entry.cost) * bytes <
+           static_cast<uint64_t>(cost) * entry.bytes;
+  }
+
+  bool IsEvictable(const Entry& entry, uint32_t cost, size_t bytes) const {
+    return entry.last_use != epoch_ && IsCheaper(entry, cost, bytes);
+  }
+
+  // Entries are ordered by offset, so the ones behind `index` move down.
+  void Evict(int index) {
+    Entry& victim = entries_[index];
+    if (victim.redirect != nullptr) {
+      *victim.redirect = victim.original;
+    }
+    const size_t end = victim.offset + victim.aligned_bytes;
+    memmove(memory_ + victim.offset, memory_ + end, used_bytes_ - end);
+    used_bytes_ -= victim.aligned_bytes;
+    const size_t moved_by = victim.aligned_bytes;
+    for (int i = index + 1; i < entry_count_; ++i) {
+      entries_[i - 1] = entries_[i];
+      Entry& entry = entries_[i - 1];
+      entry.offset -= moved_by;
+      if (entry.redirect != nullptr) {
+        *entry.redirect = memory_ + entry.offset;
+      }
+    }
+    --entry_count_;
+  }
+
+  size_t budget_bytes_;
+  uint8_t* memory_;
+  size_t used_bytes_;
+  Entry entries_[kMaxEntries];
+  int entry_count_;
+  uint32_t epoch_;
+  uint32_t hits_;
+  uint32_t misses_;
+  uint32_t evictions_;
+
+ public:
+  TF_LITE_REMOVE_VIRTUAL_DELETE
+};
+
+namespace decompression_cache {
+
+inline TFLMRegistration& WrappedDecode() {
+  static TFLMRegistration registration = {};
+  return registration;
+}
+
+inline MicroDecompressionCache*& Cache() {
+  static MicroDecompressionCache* cache = nullptr;
+  return cache;
+}
+
+// First DECODE node invoked after the model was prepared. Invoking it again
+// starts the next invocation of the model.
+inline TfLiteNode*& FirstNode() {
+  static TfLiteNode* node = nullptr;
+  return node;
+}
+
+// Drops the outputs of the node from the cache, the tensors are planned
+// again, and allocates the cache memory.
+inline TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
+  TF_LITE_ENSURE_STATUS(WrappedDecode().prepare(context, node));
+  MicroDecompressionCache* cache = Cache();
+  FirstNode() = nullptr;
+  for (int i = 0; i < node->outputs->size; ++i) {
+    cache->Remove(tflite::micro::GetEvalOutput(context, node, i));
+  }
+  return cache->AllocateMemory(GetMicroContext(context));
+}
+
+// Skips decoding if all outputs are cached. Their data already points into
+// the cache. Otherwise decodes and offers the outputs to the cache, each with
+// its share of the decoding time.
+inline TfLiteStatus Invoke(TfLiteContext* context, TfLiteNode* node) {
+  MicroDecompressionCache* cache = Cache();
+  if (FirstNode() == nullptr) {
+    FirstNode() = node;
+  }
+  if (FirstNode() == node) {
+    cache->NextEpoch();
+  }
+  bool all_cached = true;
+  for (int i = 0; i < node->outputs->size; ++i) {
+    if (cache->Find(tflite::micro::GetEvalOutput(context, node, i)) ==
+        nullptr) {
+      all_cached = false;
+    }
+  }
+  if (all_cached) {
+    return kTfLiteOk;
+  }
+
+  const uint32_t start = GetCurrentTimeTicks();
+  TF_LITE_ENSURE_STATUS(WrappedDecode().invoke(context, node));
+  const uint32_t ticks = GetCurrentTimeTicks() - start;
+
+  size_t total_bytes = 0;
+  for (int i = 0; i < node->outputs->size; ++i) {
+    size_t bytes = 0;
+    TF_LITE_ENSURE_STATUS(TfLiteEvalTensorByteLength(
+        tflite::micro::GetEvalOutput(context, node, i), &bytes));
+    total_bytes += bytes;
+  }
+  for (int i = 0; i < node->outputs->size; ++i) {
+    TfLiteEvalTensor* output = tflite::micro::GetEvalOutput(context, node, i);
+    size_t bytes = 0;
+    TF_LITE_ENSURE_STATUS(TfLiteEvalTensorByteLength(output, &bytes));
+    if (bytes == 0 || cache->Contains(output)) {
+      continue;
+    }
+    // Without a timer all tensors cost the same per byte.
+    const uint32_t cost =
+        ticks != 0 ? static_cast<uint32_t>(static_cast<uint64_t>(ticks) *
+                                           bytes / total_bytes)
+                   : static_cast<uint32_t>(bytes);
+    cache->Insert(output, output->data.data, bytes, cost, &output->data.data);
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace decompression_cache
+
+// DECODE kernel that keeps the decoded tensors in `cache` across
+// invocations. The cache memory is allocated from the alternate decompression
+// memory when the model is prepared, so the regions must be registered
+// before:
+//
+//   static tflite::MicroDecompressionCache cache(64 * 1024);
+//   resolver.AddCustom("TFLM_DECODE", tflite::Register_DECODE_CACHED(&cache));
+//   interpreter.SetDecompressionMemory({{psram_buffer, 64 * 1024}});
+//   interpreter.AllocateTensors();
+//
+// `decode` can be another DECODE kernel, e.g.
+// Register_DECODE_HUFFMAN_MULTI_SYMBOL(). Decoded tensors are read from the
+// cache by the consuming kernels, so keeping them in slow memory trades
+// decoding time for memory bandwidth. There is one cache per application.
+inline TFLMRegistration Register_DECODE_CACHED(
+    MicroDecompressionCache* cache,
+    const TFLMRegistration& decode = Register_DECODE()) {
+  decompression_cache::WrappedDecode() = decode;
+  decompression_cache::Cache() = cache;
+  TFLMRegistration registration = decode;
+  registration.prepare = decompression_cache::Prepare;
+  registration.invoke = decompression_cache::Invoke;
+  return registration;
+}
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MICRO_DECOMPRESSION_CACHE_H_
@@ -0,0 +1,950 @@
+/* Copyright 2025 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_MICRO_FUSION_PLAN_H_
+#define TENSORFLOW_LITE_MICRO_MICRO_FUSION_PLAN_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/quantization_util.h"
+#include "tensorflow/lite/kernels/padding.h"
+#include "tensorflow/lite/micro/compatibility.h"
+#include "tensorflow/lite/micro/flatbuffer_utils.h"
+#include "tensorflow/lite/micro/kernels/tiled_conv_chain.h"
+#include "tensorflow/lite/micro/micro_common.h"
+#include "tensorflow/lite/micro/micro_context.h"
+#include "tensorflow/lite/micro/micro_log.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+
+/*   This is an experimental feature and subjected to change.
+ *
+The MicroFusionPlan removes operators whose work the following operator can do
+itself, so that their output tensor never has to be written to the arena:
+
+  PAD -> CONV_2D / DEPTHWISE_CONV_2D
+      The convolution reads the PAD input with SAME padding instead of the
+      padded tensor. Only VALID convolutions whose explicit spatial padding is
+      exactly the SAME padding of the unpadded input are fused; the implicit
+      padding value is the input zero point, like the one of PAD.
+  DEQUANTIZE -> QUANTIZE
+      The QUANTIZE reads the integer DEQUANTIZE input and requantizes it
+      directly, skipping the float tensor. The single fixed-point rescale may
+      round differently from the float round trip by one step.
+  chains of CONV_2D / DEPTHWISE_CONV_2D / MAX_POOL_2D / AVERAGE_POOL_2D
+      Found by AnalyzeTiledChains(). The last operator of the chain runs the
+      whole chain depth-first (see kernels/tiled_conv_chain.h), keeping only
+      a few rows of each intermediate feature map in a scratch buffer. Only
+      int8 layers with batch 1 are tiled; the result is bit exact with the
+      reference kernels.
+
+A pattern is only fused when the intermediate tensor has no other consumer and
+is not a model output, and only in models with a single subgraph.
+
+The fused operators run with the original kernels: the registrations wrapped by
+the Wrap*() functions skip the producer and point input 0 of the consumer to
+the producer input at Prepare time. Both operators of a fusion must be
+registered through Wrap*(); Prepare of the consumer fails if the producer was
+not skipped, and Invoke of the producer fails if the consumer was not rewired.
+The FusionMemoryPlanner drops the intermediate tensors from the memory plan and
+keeps the producer inputs alive until the consumer ran; kernels only fuse when
+such a planner is attached, and fused operators only run once it applied the
+plan.
+
+Example:
+
+  tflite::MicroFusionPlan::Fusion fusions[16];
+  tflite::MicroFusionPlan fusion_plan(model, fusions, 16);
+  fusion_plan.Analyze();
+  fusion_plan.AnalyzeTiledChains(16 * 1024);
+
+  resolver.AddPad(tflite::MicroFusionPlan::WrapPad(tflite::Register_PAD()));
+  resolver.AddConv2D(
+      tflite::MicroFusionPlan::WrapConv2D(tflite::Register_CONV_2D()));
+  ...
+  tflite::GreedyMemoryPlanner greedy;
+  tflite::FusionMemoryPlanner planner(&greedy, &fusion_plan);
+  tflite::MicroInterpreter interpreter(model, resolver,
+      tflite::MicroAllocator::Create(arena, arena_size, &planner));
+  interpreter.SetMicroExternalContext(&fusion_plan);
+  interpreter.AllocateTensors();
+
+The plan is found by the kernels through the external context of the
+interpreter, so it can't be combined with kernels that use another external
+context. The plan starts with a tag that the wrapped kernels check; when the
+external context is not a MicroFusionPlan they run the wrapped kernel
+unchanged.
+
+The Wrap*() functions keep the wrapped kernel in ONE PROCESS-WIDE SLOT PER
+OPERATOR: wrapping a different CONV_2D kernel for a second resolver replaces
+the kernel run by every interpreter that uses a wrapped CONV_2D. Only one set
+of wrapped kernels can be used per process; Wrap*() reports an error when a
+slot is rewrapped with another kernel.
+*/
+class MicroFusionPlan {
+ public:
+  enum class FusionKind : uint8_t {
+    kPadConv,     // PAD -> CONV_2D / DEPTHWISE_CONV_2D
+    kRequantize,  // DEQUANTIZE -> QUANTIZE
+    kTiledChain,  // One link of a depth-first conv chain.
+  };
+
+  struct Fusion {
+    FusionKind kind;
+    int producer;           // Operator index of the removed PAD/DEQUANTIZE.
+    int consumer;           // Operator index of the operator doing its work.
+    int32_t source;         // Input tensor of the producer.
+    int32_t intermediate;   // Output tensor of the producer.
+    int32_t consumer_output;
+
+    // Tiled chains only: first operator of the chain, and the layers and
+    // rolling buffers set up when the last operator is prepared.
+    int chain_head;
+    TiledLayer* layers;
+    int scratch_index;
+
+    // Set by the wrapped registrations when the producer was skipped and the
+    // consumer was rewired at Prepare time.
+    bool producer_prepared;
+    bool consumer_prepared;
+  };
+
+  // Does not take ownership of `model` or `fusions`, which must outlive this
+  // object.
+  MicroFusionPlan(const Model* model, Fusion* fusions, int capacity)
+      : tag_(kTag),
+        model_(model),
+        fusions_(fusions),
+        capacity_(fusions != nullptr ? capacity : 0),
+        fusion_count_(0),
+        planner_attached_(false),
+        memory_planned_(false) {}
+
+  // Finds the fusable patterns of the model. Returns the number of fusions.
+  int Analyze() {
+    fusion_count_ = 0;
+    if (model_ == nullptr || model_->subgraphs() == nullptr ||
+        model_->subgraphs()->size() != 1) {
+      return 0;
+    }
+    const auto* operators = model_->subgraphs()->Get(0)->operators();
+    if (operators == nullptr || model_->subgraphs()->Get(0)->tensors() ==
+                                    nullptr) {
+      return 0;
+    }
+    for (size_t i = 0; i < operators->size(); ++i) {
+      const Operator* op = operators->Get(i);
+      const BuiltinOperator code = FlatbufferOperatorBuiltinCode(model_, op);
+      if (code != BuiltinOperator_PAD && code != BuiltinOperator_DEQUANTIZE) {
+        continue;
+      }
+      if (op->inputs() == nullptr || op->inputs()->size() < 1 ||
+          op->outputs() == nullptr || op->outputs()->size() != 1) {
+        continue;
+      }
+      Fusion fusion = {};
+      fusion.producer = static_cast<int>(i);
+      fusion.chain_head = fusion.producer;
+      fusion.source = op->inputs()->Get(0);
+      fusion.intermediate = op->outputs()->Get(0);
+      fusion.consumer = SingleConsumer(fusion.intermediate);
+      if (fusion.source < 0 || fusion.consumer < 0) {
+        continue;
+      }
+      const Operator* consumer = operators->Get(fusion.consumer);
+      if (consumer->outputs() == nullptr || consumer->outputs()->size() < 1) {
+        continue;
+      }
+      fusion.consumer_output = consumer->outputs()->Get(0);
+      bool fusable = false;
+      if (code == BuiltinOperator_PAD) {
+        fusion.kind = FusionKind::kPadConv;
+        fusable = IsFusablePadConv(op, consumer);
+      } else {
+        fusion.kind = FusionKind::kRequantize;
+        fusable = IsFusableRequantize(op, consumer);
+      }
+      if (!fusable) {
+        continue;
+      }
+      if (!Append(fusion)) {
+        break;
+      }
+    }
+    return fusion_count_;
+  }
+
+  // Finds chains of tileable operators, each feeding only the next one, whose
+  // largest intermediate feature map has at least `min_intermediate_bytes`.
+  // Call after Analyze(); operators that are already part of a fusion are not
+  // tiled. Returns the number of chains. The registrations are not known
+  // here; Prepare of the last operator of a chain fails unless every
+  // operator of the chain is registered through Wrap*().
+  int AnalyzeTiledChains(size_t min_intermediate_bytes = 0) {
+    if (model_ == nullptr || model_->subgraphs() == nullptr ||
+        model_->subgraphs()->size() != 1 ||
+        model_->subgraphs()->Get(0)->operators() == nullptr) {
+      return 0;
+    }
+    const auto* operators = model_->subgraphs()->Get(0)->operators();
+    const int operator_count = static_cast<int>(operators->size());
+    int chain_count = 0;
+    for (int head = 0; head < operator_count; ++head) {
+      if (!IsTileable(operators->Get(head)) || IsFused(head)) {
+        continue;
+      }
+      int tail = head;
+      size_t largest = 0;
+      while (tail + 1 < operator_count &&
+             tail + 1 - head + 1 <= kMaxTiledChainLength) {
+        const Operator* op = operators->Get(tail);
+        const Operator* next = operators->Get(tail + 1);
+        const int32_t output = op->outputs()->Get(0);
+        if (!IsTileable(next) || IsFused(tail + 1) ||
+            next->inputs()->Get(0) != output ||
+            SingleConsumer(output) != tail + 1) {
+          break;
+        }
+        const size_t bytes = FlatbufferTensorBytes(GetTensor(output));
+        largest = bytes > largest ? bytes : largest;
+        ++tail;
+      }
+      if (tail == head || largest < min_intermediate_bytes) {
+        continue;
+      }
+      for (int op = head; op < tail; ++op) {
+        Fusion fusion = {};
+        fusion.kind = FusionKind::kTiledChain;
+        fusion.producer = op;
+        fusion.consumer = op + 1;
+        fusion.source = operators->Get(head)->inputs()->Get(0);
+        fusion.intermediate = operators->Get(op)->outputs()->Get(0);
+        fusion.consumer_output = operators->Get(op + 1)->outputs()->Get(0);
+        fusion.chain_head = head;
+        fusion.scratch_index = -1;
+        if (!Append(fusion)) {
+          return chain_count;
+        }
+      }
+      ++chain_count;
+      head = tail;
+    }
+    return chain_count;
+  }
+
+  const Model* model() const { return model_; }
+  int fusion_count() const { return fusion_count_; }
+  const Fusion& fusion(int index) const { return fusions_[index]; }
+
+  // Set by the FusionMemoryPlanner while it exists. Kernels are only rewired
+  // when a planner is attached.
+  void set_planner_attached(bool planner_attached) {
+    planner_attached_ = planner_attached;
+  }
+  bool planner_attached() const { return planner_attached_; }
+
+  // Set by the FusionMemoryPlanner once the fusions are applied to the memory
+  // plan, which makes the rewired graph safe to run.
+  void set_memory_planned(bool memory_planned) {
+    memory_planned_ = memory_planned;
+  }
+  bool memory_planned() const { return memory_planned_; }
+
+  // Registration wrappers for the operators of the supported patterns.
+  // Operators that are not part of a fusion run the wrapped kernel unchanged.
+  //
+  // The wrapped kernel is kept in a process-wide slot per wrapper, so all
+  // interpreters use the kernel wrapped last. Only use the wrappers for
+  // resolvers of one model, or wrap the same kernels for every model.
+  // Rewrapping a slot with another kernel is reported as an error, but the
+  // new kernel still replaces the old one.
+  static TFLMRegistration WrapPad(const TFLMRegistration& registration) {
+    return Wrap<kPadSlot>(registration);
+  }
+  static TFLMRegistration WrapDequantize(const TFLMRegistration& registration) {
+    return Wrap<kDequantizeSlot>(registration);
+  }
+  static TFLMRegistration WrapConv2D(const TFLMRegistration& registration) {
+    return Wrap<kConv2DSlot>(registration);
+  }
+  static TFLMRegistration WrapDepthwiseConv2D(
+      const TFLMRegistration& registration) {
+    return Wrap<kDepthwiseConv2DSlot>(registration);
+  }
+  static TFLMRegistration WrapQuantize(const TFLMRegistration& registration) {
+    return Wrap<kQuantizeSlot>(registration);
+  }
+  static TFLMRegistration WrapMaxPool2D(const TFLMRegistration& registration) {
+    return Wrap<kMaxPool2DSlot>(registration);
+  }
+  static TFLMRegistration WrapAveragePool2D(
+      const TFLMRegistration& registration) {
+    return Wrap<kAveragePool2DSlot>(registration);
+  }
+
+ private:
+  enum Slot {
+    kPadSlot,
+    kDequantizeSlot,
+    kConv2DSlot,
+    kDepthwiseConv2DSlot,
+    kQuantizeSlot,
+    kMaxPool2DSlot,
+    kAveragePool2DSlot,
+  };
+
+  // The kernels wrapped for each slot. The last wrapped registration of a
+  // slot is used by all interpreters.
+  template <int kSlot>
+  static TFLMRegistration& Wrapped() {
+    static TFLMRegistration registration = {};
+    return registration;
+  }
+
+  template <int kSlot>
+  static TFLMRegistration Wrap(const TFLMRegistration& registration) {
+    const TFLMRegistration& wrapped = Wrapped<kSlot>();
+    if (wrapped.invoke != nullptr &&
+        (wrapped.invoke != registration.invoke ||
+         wrapped.prepare != registration.prepare)) {
+      MicroPrintf(
+          "MicroFusionPlan: operator slot %d rewrapped with another kernel, "
+          "all interpreters now use the new kernel",
+          kSlot);
+    }
+    Wrapped<kSlot>() = registration;
+    TFLMRegistration wrapper = registration;
+    wrapper.prepare = PrepareOperator<kSlot>;
+    wrapper.invoke = InvokeOperator<kSlot>;
+    return wrapper;
+  }
+
+  // Returns the plan set as external context of the interpreter, or nullptr
+  // if there is none, it is not a MicroFusionPlan, or no planner is attached.
+  // The tag is the first member, so it is read before anything else of an
+  // external context of another type.
+  static MicroFusionPlan* FromContext(TfLiteContext* context) {
+    void* external_context = GetMicroContext(context)->external_context();
+    if (external_context == nullptr ||
+        *static_cast<const uint32_t*>(external_context) != kTag) {
+      return nullptr;
+    }
+    MicroFusionPlan* plan = static_cast<MicroFusionPlan*>(external_context);
+    return plan->planner_attached_ ? plan : nullptr;
+  }
+
+  bool Append(const Fusion& fusion) {
+    if (fusion_count_ >= capacity_) {
+      MicroPrintf("Fusion plan full, %d fusions kept", capacity_);
+      return false;
+    }
+    fusions_[fusion_count_++] = fusion;
+    return true;
+  }
+
+  // Returns the fusion that removes the operator writing `node`, or nullptr.
+  Fusion* FindByProducer(const TfLiteNode* node) const {
+    if (node->outputs == nullptr || node->outputs->size < 1) {
+      return nullptr;
+    }
+    for (int i = 0; i < fusion_count_; ++i) {
+      if (fusions_[i].intermediate == node->outputs->data[0]) {
+        return &fusions_[i];
+      }
+    }
+    return nullptr;
+  }
+
+  Fusion* FindByConsumer(const TfLiteNode* node) const {
+    if (node->outputs == nullptr || node->outputs->size < 1) {
+      return nullptr;
+    }
+    for (int i = 0; i < fusion_count_; ++i) {
+      if (fusions_[i].consumer_output == node->outputs->data[0]) {
+        return &fusions_[i];
+      }
+    }
+    return nullptr;
+  }
+
+  // Returns true if operator `op` is part of a fusion.
+  bool IsFused(int op) const {
+    for (int i = 0; i < fusion_count_; ++i) {
+      if (fusions_[i].producer == op || fusions_[i].consumer == op) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Producers are skipped. Consumers are rewired, or run the tiled chain
+  // they end. Operators are prepared in order, so the producer of a fusion
+  // has been prepared when its consumer is.
+  template <int kSlot>
+  static TfLiteStatus PrepareOperator(TfLiteContext* context,
+                                      TfLiteNode* node) {
+    MicroFusionPlan* plan = FromContext(context);
+    if (plan != nullptr) {
+      Fusion* consumed = plan->FindByConsumer(node);
+      if (consumed != nullptr) {
+        if (!consumed->producer_prepared) {
+          MicroPrintf(
+              "Operator %d is fused into operator %d but not registered "
+              "through MicroFusionPlan::Wrap*()",
+              consumed->producer, consumed->consumer);
+          return kTfLiteError;
+        }
+        consumed->consumer_prepared = true;
+      }
+      Fusion* produced = plan->FindByProducer(node);
+      if (produced != nullptr) {
+        produced->producer_prepared = true;
+        return kTfLiteOk;
+      }
+      if (consumed != nullptr && consumed->kind == FusionKind::kTiledChain) {
+        return plan->PrepareTiledChain(context, consumed);
+      }
+      if (consumed != nullptr) {
+        TF_LITE_ENSURE_STATUS(Rewire(context, node, *consumed));
+      }
+    }
+    if (Wrapped<kSlot>().prepare == nullptr) {
+      return kTfLiteOk;
+    }
+    return Wrapped<kSlot>().prepare(context, node);
+  }
+
+  template <int kSlot>
+  static TfLiteStatus InvokeOperator(TfLiteContext* context,
+                                     TfLiteNode* node) {
+    MicroFusionPlan* plan = FromContext(context);
+    if (plan != nullptr) {
+      const Fusion* produced = plan->FindByProducer(node);
+      const Fusion* consumed = plan->FindByConsumer(node);
+      if ((produced != nullptr || consumed != nullptr) &&
+          !plan->memory_planned_) {
+        MicroPrintf("Fusion plan was not applied to the memory plan");
+        return kTfLiteError;
+      }
+      if (produced != nullptr) {
+        if (!produced->consumer_prepared) {
+          MicroPrintf(
+              "Operator %d is fused into operator %d but not registered "
+              "through MicroFusionPlan::Wrap*()",
+              produced->producer, produced->consumer);
+          return kTfLiteError;
+        }
+        return kTfLiteOk;
+      }
+      if (consumed != nullptr && consumed->kind == FusionKind::kTiledChain) {
+        return InvokeTiledChain(context, *consumed);
+      }
+    }
+    return Wrapped<kSlot>().invoke(context, node);
+  }
+
+  // Points input 0 of the consumer to the producer input. The node inputs may
+  // point into the model flatbuffer, so the list is copied to the arena.
+  static TfLiteStatus Rewire(TfLiteContext* context, TfLiteNode* node,
+                             const Fusion& fusion) {
+    TF_LITE_ENSURE(context, node->inputs != nullptr && node->inputs->size > 0);
+    if (node->inputs->data[0] != fusion.source) {
+      TF_LITE_ENSURE(context, node->inputs->data[0] == fusion.intermediate);
+      const int size = node->inputs->size;
+      TfLiteIntArray* inputs =
+          static_cast<TfLiteIntArray*>(context->AllocatePersistentBuffer(
+              context, sizeof(int) * (static_cast<size_t>(size) + 1)));
+      TF_LITE_ENSURE(context, inputs != nullptr);
+      inputs->size = size;
+      for (int i = 0; i < size; ++i) {
+        inputs->data[i] = node->inputs->data[i];
+      }
+      inputs->data[0] = fusion.source;
+      node->inputs = inputs;
+    }
+    if (fusion.kind == FusionKind::kPadConv) {
+      TF_LITE_ENSURE(context, node->builtin_data != nullptr);
+      // TfLiteConvParams and TfLiteDepthwiseConvParams both start with the
+      // padding.
+      static_cast<TfLiteConvParams*>(node->builtin_data)->padding =
+          kTfLitePaddingSame;
+    }
+    return kTfLiteOk;
+  }
+
+  const Tensor* GetTensor(int32_t index) const {
+    return model_->subgraphs()->Get(0)->tensors()->Get(index);
+  }
+
+  // Returns the index of the only operator reading `tensor`, or -1 if the
+  // tensor has several consumers, none, or is a model output.
+  int SingleConsumer(int32_t tensor) const {
+    const SubGraph* subgraph = model_->subgraphs()->Get(0);
+    if (FlatbufferVectorContains(subgraph->outputs(), tensor)) {
+      return -1;
+    }
+    int consumer = -1;
+    const auto* operators = subgraph->operators();
+    for (size_t i = 0; i < operators->size(); ++i) {
+      const Operator* op = operators->Get(i);
+      if (FlatbufferVectorContains(op->inputs(), tensor) ||
+          FlatbufferVectorContains(op->intermediates(), tensor)) {
+        if (consumer >= 0) {
+          return -1;
+        }
+        consumer = static_cast<int>(i);
+      }
+    }
+    return consumer;
+  }
+
+  static bool SameQuantization(const Tensor* a, const Tensor* b) {
+    if (a->type() != b->type()) {
+      return false;
+    }
+    const QuantizationParameters* qa = a->quantization();
+    const QuantizationParameters* qb = b->quantization();
+    const bool a_quantized = qa != nullptr && qa->scale() != nullptr &&
+                             qa->scale()->size() > 0;
+    const bool b_quantized = qb != nullptr && qb->scale() != nullptr &&
+                             qb->scale()->size() > 0;
+    if (!a_quantized || !b_quantized) {
+      return a_quantized == b_quantized;
+    }
+    return qa->scale()->size() == 1 && qb->scale()->size() == 1 &&
+           qa->scale()->Get(0) == qb->scale()->Get(0) &&
+           qa->zero_point() != nullptr && qb->zero_point() != nullptr &&
+           qa->zero_point()->size() == 1 && qb->zero_point()->size() == 1 &&
+           qa->zero_point()->Get(0) == qb->zero_point()->Get(0);
+  }
+
+  // Reads entry `index` of a constant int32 or int64 tensor.
+  bool ReadConstant(const Tensor* tensor, int index, int64_t* value) const {
+    const Buffer* buffer = model_->buffers()->Get(tensor->buffer());
+    if (buffer->data() == nullptr) {
+      return false;
+    }
+    const uint8_t* data = buffer->data()->data();
+    if (tensor->type() == TensorType_INT32 &&
+        buffer->data()->size() >= sizeof(int32_t) * (index + 1)) {
+      int32_t v;
+      memcpy(&v, data + sizeof(int32_t) * index, sizeof(v));
+      *value = v;
+      return true;
+    }
+    if (tensor->type() == TensorType_INT64 &&
+        buffer->data()->size() >= sizeof(int64_t) * (index + 1)) {
+      memcpy(value, data + sizeof(int64_t) * index, sizeof(*value));
+      return true;
+    }
+    return false;
+  }
+
+  static bool HasRank4(const Tensor* tensor) {
+    return tensor->shape() != nullptr && tensor->shape()->size() == 4;
+  }
+
+  bool IsFusablePadConv(const Operator* pad, const Operator* conv) const {
+    const BuiltinOperator code = FlatbufferOperatorBuiltinCode(model_, conv);
+    int stride_h, stride_w, dilation_h, dilation_w;
+    if (code == BuiltinOperator_CONV_2D) {
+      const Conv2DOptions* options = conv->builtin_options_as_Conv2DOptions();
+      if (options == nullptr || options->padding() != Padding_VALID) {
+        return false;
+      }
+      stride_h = options->stride_h();
+      stride_w = options->stride_w();
+      dilation_h = options->dilation_h_factor();
+      dilation_w = options->dilation_w_factor();
+    } else if (code == BuiltinOperator_DEPTHWISE_CONV_2D) {
+      const DepthwiseConv2DOptions* options =
+          conv->builtin_options_as_DepthwiseConv2DOptions();
+      if (options == nullptr || options->padding() != Padding_VALID) {
+        return false;
+      }
+      stride_h = options->stride_h();
+      stride_w = options->stride_w();
+      dilation_h = options->dilation_h_factor();
+      dilation_w = options->dilation_w_factor();
+    } else {
+      return false;
+    }
+    if (pad->inputs()->size() != 2 || conv->inputs() == nullptr ||
+        conv->inputs()->size() < 2 || conv->inputs()->Get(0) !=
+                                          pad->outputs()->Get(0)) {
+      return false;
+    }
+    const Tensor* input = GetTensor(pad->inputs()->Get(0));
+    const Tensor* padded = GetTensor(pad->outputs()->Get(0));
+    const Tensor* paddings = GetTensor(pad->inputs()->Get(1));
+    const Tensor* filter = GetTensor(conv->inputs()->Get(1));
+    const Tensor* output = GetTensor(conv->outputs()->Get(0));
+    if (!HasRank4(input) || !HasRank4(filter) || !HasRank4(output) ||
+        !SameQuantization(input, padded) ||
+        !FlatbufferTensorHasData(model_, paddings)) {
+      return false;
+    }
+
+    // Paddings are [[batch], [height], [width], [channels]] x [before, after].
+    int64_t pads[8];
+    for (int i = 0; i < 8; ++i) {
+      if (!ReadConstant(paddings, i, &pads[i])) {
+        return false;
+      }
+    }
+    if (pads[0] != 0 || pads[1] != 0 || pads[6] != 0 || pads[7] != 0) {
+      return false;
+    }
+
+    int out_height, out_width;
+    const TfLitePaddingValues same = ComputePaddingHeightWidth(
+        stride_h, stride_w, dilation_h, dilation_w, input->shape()->Get(1),
+        input->shape()->Get(2), filter->shape()->Get(1),
+        filter->shape()->Get(2), kTfLitePaddingSame, &out_height, &out_width);
+    return pads[2] == same.height &&
+           pads[3] == same.height + same.height_offset &&
+           pads[4] == same.width &&
+           pads[5] == same.width + same.width_offset &&
+           output->shape()->Get(1) == out_height &&
+           output->shape()->Get(2) == out_width;
+  }
+
+  static bool IsRequantizeType(TensorType type) {
+    return type == TensorType_INT8 || type == TensorType_INT16;
+  }
+
+  bool IsFusableRequantize(const Operator* dequantize,
+                           const Operator* quantize) const {
+    if (FlatbufferOperatorBuiltinCode(model_, quantize) !=
+            BuiltinOperator_QUANTIZE ||
+        quantize->inputs() == nullptr || quantize->inputs()->size() != 1) {
+      return false;
+    }
+    const Tensor* input = GetTensor(dequantize->inputs()->Get(0));
+    const Tensor* output = GetTensor(quantize->outputs()->Get(0));
+    const QuantizationParameters* quantization = input->quantization();
+    return !FlatbufferTensorHasData(model_, input) &&
+           IsRequantizeType(input->type()) &&
+           (IsRequantizeType(output->type()) ||
+            output->type() == TensorType_INT32) &&
+           quantization != nullptr && quantization->scale() != nullptr &&
+           quantization->scale()->size() == 1;
+  }
+
+  static bool IsInt8Quantized(const Tensor* tensor) {
+    const QuantizationParameters* quantization = tensor->quantization();
+    return tensor->type() == TensorType_INT8 && quantization != nullptr &&
+           quantization->scale() != nullptr &&
+           quantization->zero_point() != nullptr &&
+           quantization->scale()->size() >= 1 &&
+           quantization->zero_point()->size() >= 1;
+  }
+
+  static bool HasBatch1Rank4(const Tensor* tensor) {
+    return HasRank4(tensor) && tensor->shape()->Get(0) == 1;
+  }
+
+  bool IsTileable(const Operator* op) const {
+    const BuiltinOperator code = FlatbufferOperatorBuiltinCode(model_, op);
+    if (op->inputs() == nullptr || op->inputs()->size() < 1 ||
+        op->outputs() == nullptr || op->outputs()->size() != 1 ||
+        op->inputs()->Get(0) < 0) {
+      return false;
+    }
+    const Tensor* input = GetTensor(op->inputs()->Get(0));
+    const Tensor* output = GetTensor(op->outputs()->Get(0));
+    if (!HasBatch1Rank4(input) || !HasBatch1Rank4(output) ||
+        !IsInt8Quantized(input) || !IsInt8Quantized(output) ||
+        input->quantization()->scale()->size() != 1 ||
+        output->quantization()->scale()->size() != 1 ||
+        FlatbufferTensorHasData(model_, input)) {
+      return false;
+    }
+    if (code == BuiltinOperator_MAX_POOL_2D ||
+        code == BuiltinOperator_AVERAGE_POOL_2D) {
+      const Pool2DOptions* options = op->builtin_options_as_Pool2DOptions();
+      return options != nullptr &&
+             options->filter_height() <= kMaxTiledFilterHeight &&
+             SameQuantization(input, output);
+    }
+    int dilated_height;
+    if (code == BuiltinOperator_CONV_2D) {
+      const Conv2DOptions* options = op->builtin_options_as_Conv2DOptions();
+      if (options == nullptr) {
+        return false;
+      }
+      dilated_height = options->dilation_h_factor();
+    } else if (code == BuiltinOperator_DEPTHWISE_CONV_2D) {
+      const DepthwiseConv2DOptions* options =
+          op->builtin_options_as_DepthwiseConv2DOptions();
+      if (options == nullptr) {
+        return false;
+      }
+      dilated_height = options->dilation_h_factor();
+    } else {
+      return false;
+    }
+    if (op->inputs()->size() < 2 || op->inputs()->Get(1) < 0) {
+      return false;
+    }
+    const Tensor* filter = GetTensor(op->inputs()->Get(1));
+    if (!HasRank4(filter) || !IsInt8Quantized(filter) ||
+        !FlatbufferTensorHasData(model_, filter)) {
+      return false;
+    }
+    // Custom quantization details, such as sub-8-bit packing or compression,
+    // change the filter layout the tiled kernels read.
+    if (filter->quantization()->details() != nullptr) {
+      return false;
+    }
+    const size_t filter_scales = filter->quantization()->scale()->size();
+    const int output_depth = output->shape()->Get(3);
+    if (filter_scales != 1 &&
+        filter_scales != static_cast<size_t>(output_depth)) {
+      return false;
+    }
+    if (code == BuiltinOperator_CONV_2D &&
+        (filter->shape()->Get(3) != input->shape()->Get(3) ||
+         filter->shape()->Get(0) != output_depth)) {
+      return false;  // Grouped convolutions are not tiled.
+    }
+    if (code == BuiltinOperator_DEPTHWISE_CONV_2D &&
+        (filter->shape()->Get(0) != 1 ||
+         filter->shape()->Get(3) != output_depth ||
+         output_depth % input->shape()->Get(3) != 0)) {
+      return false;
+    }
+    if (op->inputs()->size() > 2 && op->inputs()->Get(2) >= 0) {
+      const Tensor* bias = GetTensor(op->inputs()->Get(2));
+      if (bias->type() != TensorType_INT32 ||
+          !FlatbufferTensorHasData(model_, bias)) {
+        return false;
+      }
+    }
+    dilated_height = (filter->shape()->Get(1) - 1) * dilated_height + 1;
+    return dilated_height >= 1 && dilated_height <= kMaxTiledFilterHeight;
+  }
+
+  // Activation range like CalculateActivationRangeQuantized() for int8.
+  static void ActivationRange(ActivationFunctionType activation, float scale,
+                              int32_t zero_point, TiledLayer* layer) {
+    auto quantize = [scale, zero_point](float value) {
+      return zero_point + static_cast<int32_t>(std::round(value / scale));
+    };
+    int32_t min = std::numeric_limits<int8_t>::min();
+    int32_t max = std::numeric_limits<int8_t>::max();
+    if (activation == ActivationFunctionType_RELU) {
+      min = std::max(min, quantize(0.0f));
+    } else if (activation == ActivationFunctionType_RELU6) {
+      min = std::max(min, quantize(0.0f));
+      max = std::min(max, quantize(6.0f));
+    } else if (activation == ActivationFunctionType_RELU_N1_TO_1) {
+      min = std::max(min, quantize(-1.0f));
+      max = std::min(max, quantize(1.0f));
+    }
+    layer->activation_min = min;
+    layer->activation_max = max;
+  }
+
+  TfLiteStatus BuildTiledLayer(TfLiteContext* context, const Operator* op,
+                               TiledLayer* layer) const {
+    const BuiltinOperator code = FlatbufferOperatorBuiltinCode(model_, op);
+    const Tensor* input = GetTensor(op->inputs()->Get(0));
+    const Tensor* output = GetTensor(op->outputs()->Get(0));
+    *layer = {};
+    layer->input_height = input->shape()->Get(1);
+    layer->input_width = input->shape()->Get(2);
+    layer->input_depth = input->shape()->Get(3);
+    layer->output_height = output->shape()->Get(1);
+    layer->output_width = output->shape()->Get(2);
+    layer->output_depth = output->shape()->Get(3);
+    layer->dilation_height = 1;
+    layer->dilation_width = 1;
+    layer->depth_multiplier = 1;
+    const float input_scale = input->quantization()->scale()->Get(0);
+    const float output_scale = output->quantization()->scale()->Get(0);
+    const int32_t output_zero_point = static_cast<int32_t>(
+        output->quantization()->zero_point()->Get(0));
+    layer->input_offset = -static_cast<int32_t>(
+        input->quantization()->zero_point()->Get(0));
+    layer->output_offset = output_zero_point;
+
+    Padding padding;
+    ActivationFunctionType activation;
+    if (code == BuiltinOperator_MAX_POOL_2D ||
+        code == BuiltinOperator_AVERAGE_POOL_2D) {
+      const Pool2DOptions* options = op->builtin_options_as_Pool2DOptions();
+      layer->kind = code == BuiltinOperator_MAX_POOL_2D
+                        ? TiledLayerKind::kMaxPool
+                        : TiledLayerKind::kAveragePool;
+      layer->filter_height = options->filter_height();
+      layer->filter_width = options->filter_width();
+      layer->stride_height = options->stride_h();
+      layer->stride_width = options->stride_w();
+      padding = options->padding();
+      activation = options->fused_activation_function();
+    } else {
+      const Tensor* filter = GetTensor(op->inputs()->Get(1));
+      layer->filter_height = filter->shape()->Get(1);
+      layer->filter_width = filter->shape()->Get(2);
+      if (code == BuiltinOperator_CONV_2D) {
+        const Conv2DOptions* options = op->builtin_options_as_Conv2DOptions();
+        layer->kind = TiledLayerKind::kConv;
+        layer->stride_height = options->stride_h();
+        layer->stride_width = options->stride_w();
+        layer->dilation_height = options->dilation_h_factor();
+        layer->dilation_width = options->dilation_w_factor();
+        padding = options->padding();
+        activation = options->fused_activation_function();
+      } else {
+        const DepthwiseConv2DOptions* options =
+            op->builtin_options_as_DepthwiseConv2DOptions();
+        layer->kind = TiledLayerKind::kDepthwiseConv;
+        layer->stride_height = options->stride_h();
+        layer->stride_width = options->stride_w();
+        layer->dilation_height = options->dilation_h_factor();
+        layer->dilation_width = options->dilation_w_factor();
+        layer->depth_multiplier = layer->output_depth / layer->input_depth;
+        padding = options->padding();
+        activation = options->fused_activation_function();
+      }
+
+      MicroContext* micro_context = GetMicroContext(context);
+      const TfLiteEvalTensor* filter_data =
+          micro_context->GetEvalTensor(op->inputs()->Get(1));
+      TF_LITE_ENSURE(context, filter_data != nullptr);
+      layer->filter = filter_data->data.int8;
+      if (op->inputs()->size() > 2 && op->inputs()->Get(2) >= 0) {
+        const TfLiteEvalTensor* bias_data =
+            micro_context->GetEvalTensor(op->inputs()->Get(2));
+        TF_LITE_ENSURE(context, bias_data != nullptr);
+        layer->bias = bias_data->data.i32;
+      }
+
+      const int channels = layer->output_depth;
+      int32_t* multipliers =
+          static_cast<int32_t*>(context->AllocatePersistentBuffer(
+              context, 2 * sizeof(int32_t) * channels));
+      TF_LITE_ENSURE(context, multipliers != nullptr);
+      int32_t* shifts = multipliers + channels;
+      const auto* filter_scales = filter->quantization()->scale();
+      for (int c = 0; c < channels; ++c) {
+        const float filter_scale =
+            filter_scales->Get(filter_scales->size() > 1 ? c : 0);
+        const double effective_scale = static_cast<double>(input_scale) *
+                                       static_cast<double>(filter_scale) /
+                                       static_cast<double>(output_scale);
+        int shift;
+        QuantizeMultiplier(effective_scale, &multipliers[c], &shift);
+        shifts[c] = shift;
+      }
+      layer->output_multiplier = multipliers;
+      layer->output_shift = shifts;
+    }
+
+    if (padding == Padding_SAME) {
+      int out_height, out_width;
+      const TfLitePaddingValues values = ComputePaddingHeightWidth(
+          layer->stride_height, layer->stride_width, layer->dilation_height,
+          layer->dilation_width, layer->input_height, layer->input_width,
+          layer->filter_height, layer->filter_width, kTfLitePaddingSame,
+          &out_height, &out_width);
+      layer->padding_top = values.height;
+      layer->padding_left = values.width;
+    }
+    ActivationRange(activation, output_scale, output_zero_point, layer);
+    return kTfLiteOk;
+  }
+
+  // Called for the last operator of a chain, which runs the whole chain.
+  // Every other operator of the chain must have been skipped by a wrapped
+  // registration, since the chain reads none of their outputs.
+  TfLiteStatus PrepareTiledChain(TfLiteContext* context, Fusion* fusion) {
+    const auto* operators = model_->subgraphs()->Get(0)->operators();
+    const int count = fusion->consumer - fusion->chain_head + 1;
+    TF_LITE_ENSURE(context, count >= 2 && count <= kMaxTiledChainLength);
+    for (int i = 0; i < fusion_count_; ++i) {
+      const Fusion& link = fusions_[i];
+      if (link.kind == FusionKind::kTiledChain &&
+          link.chain_head == fusion->chain_head &&
+          link.consumer <= fusion->consumer && !link.producer_prepared) {
+        MicroPrintf(
+            "Operator %d of the tiled chain ending at operator %d is not "
+            "registered through MicroFusionPlan::Wrap*()",
+            link.producer, fusion->consumer);
+        return kTfLiteError;
+      }
+    }
+    TiledLayer* layers = static_cast<TiledLayer*>(
+        context->AllocatePersistentBuffer(context, sizeof(TiledLayer) * count));
+    TF_LITE_ENSURE(context, layers != nullptr);
+    for (int i = 0; i < count; ++i) {
+      TF_LITE_ENSURE_STATUS(BuildTiledLayer(
+          context, operators->Get(fusion->chain_head + i), &layers[i]));
+    }
+    TF_LITE_ENSURE_STATUS(context->RequestScratchBufferInArena(
+        context, TiledChainBufferBytes(layers, count),
+        &fusion->scratch_index));
+    fusion->layers = layers;
+    return kTfLiteOk;
+  }
+
+  static TfLiteStatus InvokeTiledChain(TfLiteContext* context,
+                                       const Fusion& fusion) {
+    MicroContext* micro_context = GetMicroContext(context);
+    const TfLiteEvalTensor* input = micro_context->GetEvalTensor(fusion.source);
+    TfLiteEvalTensor* output =
+        micro_context->GetEvalTensor(fusion.consumer_output);
+    int8_t* buffer = static_cast<int8_t*>(
+        context->GetScratchBuffer(context, fusion.scratch_index));
+    TF_LITE_ENSURE(context, input != nullptr && output != nullptr &&
+                                buffer != nullptr && fusion.layers != nullptr);
+    const int count = fusion.consumer - fusion.chain_head + 1;
+    TiledChainAssignBuffers(fusion.layers, count, buffer);
+    return TiledChainInvoke(fusion.layers, count, input->data.int8,
+                            output->data.int8);
+  }
+
+  // "FUSE", marks the external context as a MicroFusionPlan.
+  static constexpr uint32_t kTag = 0x46555345;
+
+  const uint32_t tag_;  // Must stay the first member, see FromContext().
+  const Model* model_;  // not owned
+  Fusion* fusions_;     // not owned
+  int capacity_;
+  int fusion_count_;
+  bool planner_attached_;
+  bool memory_planned_;
+
+ public:
+  TF_LITE_REMOVE_VIRTUAL_DELETE
+};
+
+// FromContext() reads the tag through a pointer to the object.
+static_assert(std::is_standard_layout<MicroFusionPlan>::value,
+              "MicroFusionPlan must keep its tag at offset 0");
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MICRO_FUSION_PLAN_H_
@@ -29,9 +29,13 @@ limitations under the License.
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/core/api/error_reporter.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/micro/memory_helpers.h"
+#include "tensorflow/lite/micro/memory_planner/external_io_memory_planner.h"
 #include "tensorflow/lite/micro/micro_allocator.h"
+#include "tensorflow/lite/micro/micro_arena_constants.h"
 #include "tensorflow/lite/micro/micro_interpreter_context.h"
 #include "tensorflow/lite/micro/micro_interpreter_graph.h"
+#include "tensorflow/lite/micro/micro_log.h"
 #include "tensorflow/lite/micro/micro_op_resolver.h"
 #include "tensorflow/lite/micro/micro_profiler_interface.h"
 #include "tensorflow/lite/portable_type_to_tflitetype.h"
@@ -96,6 +100,66 @@ class MicroInterpreter {
   // TODO(b/149795762): Add this to the TfLiteStatus enum.
   TfLiteStatus Invoke();
 
+  // Time-sliced variants of Invoke() for running inference in the idle time
+  // of a control loop without an RTOS. They run a bounded number of operators
+  // of the main subgraph; while IsInvokePending() returns true, operators
+  // are left and the next call resumes where the previous one stopped. See
+  // MicroInterpreterGraph::InvokeSteps() and
+  // MicroInterpreterGraph::InvokeFor().
+  // Invoke(), AllocateTensors() and Reset() are implemented in the runtime
+  // library and do not know about the resume position: call
+  // CancelPendingInvoke() before them while an invoke is pending.
+  TfLiteStatus InvokeSteps(uint32_t max_ops) {
+    TF_LITE_ENSURE_STATUS(PrepareInvoke());
+    return graph_.InvokeSteps(0, max_ops);
+  }
+  TfLiteStatus InvokeFor(uint32_t max_ticks) {
+    TF_LITE_ENSURE_STATUS(PrepareInvoke());
+    return graph_.InvokeFor(0, max_ticks);
+  }
+
+  // Variant of Invoke() that overlaps operators run by an asynchronous
+  // accelerator with independent CPU operators, if `planner` planned the
+  // arena for it. See MicroInterpreterGraph::InvokeSubgraphOverlapped().
+  TfLiteStatus InvokeOverlapped(MicroAsyncAccelerator* accelerator,
+                                const OverlapMemoryPlanner* planner) {
+    if (accelerator == nullptr) {
+      return Invoke();
+    }
+    TF_LITE_ENSURE_STATUS(PrepareInvoke());
+    return graph_.InvokeSubgraphOverlapped(0, accelerator, planner);
+  }
+
+  // Variant of Invoke() for models whose inputs or outputs `planner` removed
+  // from the arena. Fails while one of them is not bound with BindInput() or
+  // BindOutput(), since it has no memory of its own.
+  TfLiteStatus InvokeExternalIo(const ExternalIoMemoryPlanner& planner) {
+    TF_LITE_ENSURE_STATUS(PrepareInvoke());
+    for (size_t i = 0; i < inputs_size(); ++i) {
+      if (planner.IsInputExcluded(static_cast<int>(i)) &&
+          input(i)->allocation_type != kTfLiteCustom) {
+        MicroPrintf("Input %d is not in the arena and must be bound.",
+                    static_cast<int>(i));
+        return kTfLiteError;
+      }
+    }
+    for (size_t i = 0; i < outputs_size(); ++i) {
+      if (planner.IsOutputExcluded(static_cast<int>(i)) &&
+          output(i)->allocation_type != kTfLiteCustom) {
+        MicroPrintf("Output %d is not in the arena and must be bound.",
+                    static_cast<int>(i));
+        return kTfLiteError;
+      }
+    }
+    return Invoke();
+  }
+
+  // Returns true while a time-sliced invoke is in progress.
+  bool IsInvokePending() const { return graph_.IsInvokePending(0); }
+
+  // Abandons a time-sliced invoke in progress.
+  void CancelPendingInvoke() { graph_.CancelPendingInvoke(); }
+
   // This is the recommended API for an application to pass an external payload
   // pointer as an external context to kernels. The life time of the payload
   // pointer should be at least as long as this interpreter. TFLM supports only
@@ -141,9 +205,39 @@ class MicroInterpreter {
   // Returns a pointer to the tensor for the corresponding tensor_index
   TfLiteEvalTensor* GetTensor(int tensor_index, int subgraph_index = 0);
 
+  // Zero-copy I/O: points the model input or output at `index` to a
+  // caller-owned buffer of `bytes` bytes, e.g. a DMA ring buffer slot, so
+  // the application no longer copies data into input() or out of output().
+  // Must be called after AllocateTensors() and can be called again before
+  // every Invoke() to switch buffers. The buffer must be large enough for the
+  // tensor, aligned to MicroArenaBufferAlignment() and stay valid while the
+  // interpreter uses it. Use an ExternalIoMemoryPlanner to also remove the
+  // bound tensors from the arena, and InvokeExternalIo() to run the model.
+  TfLiteStatus BindInput(size_t index, void* buffer, size_t bytes) {
+    if (index >= inputs_size()) {
+      MicroPrintf("Input index %d out of range (length is %d)",
+                  static_cast<int>(index), static_cast<int>(inputs_size()));
+      return kTfLiteError;
+    }
+    return BindTensor(inputs().Get(index), input(index), buffer, bytes);
+  }
+  TfLiteStatus BindOutput(size_t index, void* buffer, size_t bytes) {
+    if (index >= outputs_size()) {
+      MicroPrintf("Output index %d out of range (length is %d)",
+                  static_cast<int>(index), static_cast<int>(outputs_size()));
+      return kTfLiteError;
+    }
+    return BindTensor(outputs().Get(index), output(index), buffer, bytes);
+  }
+
 
   size_t operators_size() const { return model_->subgraphs()->Get(0)->operators()->size(); }
 
+  // Subgraph and operator being invoked, for profilers that attribute their
+  // events to operators.
+  int current_subgraph_index() { return graph_.GetCurrentSubgraphIndex(); }
+  int current_operator_index() { return graph_.GetCurrentOperatorIndex(); }
+
   inline const NodeAndRegistration node_and_registration(int graph, size_t node) const {
     return graph_.GetAllocations()->node_and_registrations[node];
   }
@@ -228,6 +322,49 @@ class MicroInterpreter {
   // No-op in normal interpreter usage.
   static void NotifyNodeIndex(const struct TfLiteContext* context, size_t node);
 
+  // Checks done by Invoke() before running the graph.
+  TfLiteStatus PrepareInvoke() {
+    if (initialization_status_ != kTfLiteOk) {
+      MicroPrintf("Invoke() called after initialization failed\n");
+      return kTfLiteError;
+    }
+    if (!tensors_allocated_) {
+      TF_LITE_ENSURE_STATUS(AllocateTensors());
+    }
+    return kTfLiteOk;
+  }
+
+  // Redirects both the TfLiteEvalTensor used by the kernels and the
+  // TfLiteTensor returned by input()/output() to `buffer`, and marks the
+  // TfLiteTensor as bound with the kTfLiteCustom allocation type.
+  TfLiteStatus BindTensor(int tensor_index, TfLiteTensor* tensor, void* buffer,
+                          size_t bytes) {
+    if (!tensors_allocated_ || tensor == nullptr) {
+      MicroPrintf("AllocateTensors() must be called before binding tensors.");
+      return kTfLiteError;
+    }
+    TfLiteEvalTensor* eval_tensor = GetTensor(tensor_index);
+    size_t required_bytes = 0;
+    TF_LITE_ENSURE_STATUS(
+        TfLiteEvalTensorByteLength(eval_tensor, &required_bytes));
+    if (buffer == nullptr || bytes < required_bytes) {
+      MicroPrintf("Tensor %d needs a buffer of %d bytes, got %d.",
+                  tensor_index, static_cast<int>(required_bytes),
+                  static_cast<int>(bytes));
+      return kTfLiteError;
+    }
+    if (reinterpret_cast<uintptr_t>(buffer) % MicroArenaBufferAlignment() !=
+        0) {
+      MicroPrintf("Buffer for tensor %d is not %d byte aligned.",
+                  tensor_index, static_cast<int>(MicroArenaBufferAlignment()));
+      return kTfLiteError;
+    }
+    eval_tensor->data.data = buffer;
+    tensor->data.data = buffer;
+    tensor->allocation_type = kTfLiteCustom;
+    return kTfLiteOk;
+  }
+
   const Model* model_;
   const MicroOpResolver& op_resolver_;
   TfLiteContext context_ = {};
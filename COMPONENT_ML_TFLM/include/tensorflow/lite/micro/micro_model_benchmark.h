@@ -0,0 +1,731 @@
+/* Copyright 2025 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_MICRO_MODEL_BENCHMARK_H_
+#define TENSORFLOW_LITE_MICRO_MICRO_MODEL_BENCHMARK_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/compatibility.h"
+#include "tensorflow/lite/micro/flatbuffer_utils.h"
+#include "tensorflow/lite/micro/micro_benchmark_clock.h"
+#include "tensorflow/lite/micro/micro_json_writer.h"
+#include "tensorflow/lite/micro/micro_log.h"
+#include "tensorflow/lite/micro/micro_op_resolver.h"
+#include "tensorflow/lite/micro/micro_profiler_interface.h"
+#include "tensorflow/lite/micro/recording_micro_allocator.h"
+#include "tensorflow/lite/micro/recording_micro_interpreter.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+
+namespace micro_model_benchmark_internal {
+
+// Max number of operator codes of a benchmarked model.
+constexpr int kMaxOperatorCodes = 64;
+
+// The registration of one operator code, with its prepare wrapped to count
+// the scratch buffers the kernel requests.
+struct Slot {
+  TFLMRegistration original;
+  TFLMRegistration wrapped;
+  size_t scratch_bytes;
+  uint32_t scratch_buffers;
+};
+
+struct State {
+  Slot slots[kMaxOperatorCodes];
+  Slot* active;
+  TfLiteStatus (*request_scratch_buffer_in_arena)(TfLiteContext* context,
+                                                  size_t bytes,
+                                                  int* buffer_index);
+};
+
+inline State& GetState() {
+  static State state = {};
+  return state;
+}
+
+inline TfLiteStatus CountingRequestScratchBufferInArena(TfLiteContext* context,
+                                                        size_t bytes,
+                                                        int* buffer_index) {
+  State& state = GetState();
+  state.active->scratch_bytes += bytes;
+  ++state.active->scratch_buffers;
+  return state.request_scratch_buffer_in_arena(context, bytes, buffer_index);
+}
+
+// Prepare has no way to find its registration, so there is one instantiation
+// per slot.
+template <size_t kSlot>
+TfLiteStatus SlotPrepare(TfLiteContext* context, TfLiteNode* node) {
+  State& state = GetState();
+  Slot& slot = state.slots[kSlot];
+  if (slot.original.prepare == nullptr) {
+    return kTfLiteOk;
+  }
+  state.active = &slot;
+  state.request_scratch_buffer_in_arena = context->RequestScratchBufferInArena;
+  context->RequestScratchBufferInArena = CountingRequestScratchBufferInArena;
+  const TfLiteStatus status = slot.original.prepare(context, node);
+  context->RequestScratchBufferInArena = state.request_scratch_buffer_in_arena;
+  state.active = nullptr;
+  return status;
+}
+
+typedef TfLiteStatus (*PrepareFunction)(TfLiteContext* context,
+                                        TfLiteNode* node);
+
+template <size_t... kSlots>
+inline PrepareFunction SlotPrepareFunction(size_t slot,
+                                           std::index_sequence<kSlots...>) {
+  static const PrepareFunction kFunctions[] = {&SlotPrepare<kSlots>...};
+  return kFunctions[slot];
+}
+
+inline PrepareFunction SlotPrepareFunction(size_t slot) {
+  return SlotPrepareFunction(slot,
+                             std::make_index_sequence<kMaxOperatorCodes>());
+}
+
+}  // namespace micro_model_benchmark_internal
+
+// Op resolver built from the operator codes of a model: it holds the
+// registrations `source` (e.g. an AllOpsResolver) has for them, with prepare
+// wrapped to count the scratch buffers of each operator code. Operator codes
+// `source` does not resolve are listed by unsupported_op().
+//
+// The counters are static, so only one instance can be used at a time. Models
+// with more than kMaxOperatorCodes operator codes are not supported, see
+// too_many_op_codes().
+class MicroModelOpResolver : public MicroOpResolver {
+ public:
+  static constexpr int kMaxOperatorCodes =
+      micro_model_benchmark_internal::kMaxOperatorCodes;
+
+  MicroModelOpResolver(const Model* model, const MicroOpResolver& source)
+      : source_(source),
+        count_(0),
+        unsupported_count_(0),
+        too_many_op_codes_(false) {
+    using micro_model_benchmark_internal::GetState;
+    memset(&GetState(), 0, sizeof(GetState()));
+    const auto* op_codes = model->operator_codes();
+    const int size = op_codes != nullptr ? op_codes->size() : 0;
+    if (size > kMaxOperatorCodes) {
+      too_many_op_codes_ = true;
+      return;
+    }
+    for (int i = 0; i < size; ++i) {
+      const OperatorCode* op_code = op_codes->Get(i);
+      const BuiltinOperator builtin = FlatbufferOperatorBuiltinCode(op_code);
+      const TFLMRegistration* registration = nullptr;
+      if (builtin != BuiltinOperator_CUSTOM) {
+        registration = source.FindOp(builtin);
+      } else if (op_code->custom_code() != nullptr) {
+        registration = source.FindOp(op_code->custom_code()->c_str());
+      }
+      if (registration == nullptr) {
+        unsupported_[unsupported_count_++] = i;
+        continue;
+      }
+      micro_model_benchmark_internal::Slot& slot = GetState().slots[count_];
+      slot.original = *registration;
+      slot.wrapped = *registration;
+      slot.wrapped.prepare =
+          micro_model_benchmark_internal::SlotPrepareFunction(count_);
+      ++count_;
+    }
+  }
+
+  const TFLMRegistration* FindOp(BuiltinOperator op) const override {
+    for (int i = 0; i < count_; ++i) {
+      const TFLMRegistration& registration = GetSlot(i).wrapped;
+      if (registration.builtin_code == op && op != BuiltinOperator_CUSTOM) {
+        return &registration;
+      }
+    }
+    return nullptr;
+  }
+
+  const TFLMRegistration* FindOp(const char* op) const override {
+    for (int i = 0; i < count_; ++i) {
+      const TFLMRegistration& registration = GetSlot(i).wrapped;
+      if (registration.builtin_code == BuiltinOperator_CUSTOM &&
+          registration.custom_name != nullptr &&
+          strcmp(registration.custom_name, op) == 0) {
+        return &registration;
+      }
+    }
+    return nullptr;
+  }
+
+  TfLiteBridgeBuiltinParseFunction GetOpDataParser(
+      BuiltinOperator op) const override {
+    return source_.GetOpDataParser(op);
+  }
+
+  int registration_count() const { return count_; }
+  const TFLMRegistration& registration_at(int i) const {
+    return GetSlot(i).wrapped;
+  }
+
+  // Scratch buffers requested by all prepare calls since ResetScratch().
+  size_t scratch_bytes_at(int i) const { return GetSlot(i).scratch_bytes; }
+  uint32_t scratch_buffers_at(int i) const {
+    return GetSlot(i).scratch_buffers;
+  }
+
+  void ResetScratch() {
+    for (int i = 0; i < count_; ++i) {
+      GetSlot(i).scratch_bytes = 0;
+      GetSlot(i).scratch_buffers = 0;
+    }
+  }
+
+  // True if the model has more operator codes than the resolver can hold.
+  // Nothing is resolved then.
+  bool too_many_op_codes() const { return too_many_op_codes_; }
+
+  // Indices into the model's operator codes.
+  int unsupported_op_count() const { return unsupported_count_; }
+  int unsupported_op(int i) const { return unsupported_[i]; }
+
+ private:
+  static micro_model_benchmark_internal::Slot& GetSlot(int i) {
+    return micro_model_benchmark_internal::GetState().slots[i];
+  }
+
+  const MicroOpResolver& source_;
+  int count_;
+  int unsupported_[kMaxOperatorCodes];
+  int unsupported_count_;
+  bool too_many_op_codes_;
+
+ public:
+  TF_LITE_REMOVE_VIRTUAL_DELETE
+};
+
+// Measured time of one operator of the first subgraph.
+struct MicroModelBenchmarkOp {
+  const char* name;
+  uint32_t invocations;
+  uint64_t ns;  // Summed over all invocations.
+};
+
+// Attributes the interpreter's per-operator events to operators through
+// MicroInterpreter::current_operator_index(), as MicroRooflineProfiler does,
+// but times them with a MicroBenchmarkClock.
+class MicroModelBenchmarkProfiler : public MicroProfilerInterface {
+ public:
+  MicroModelBenchmarkProfiler(MicroModelBenchmarkOp* ops, size_t capacity,
+                              MicroBenchmarkClock clock)
+      : ops_(ops),
+        capacity_(capacity),
+        op_count_(0),
+        clock_(clock),
+        interpreter_(nullptr),
+        depth_(0),
+        active_op_(-1),
+        active_depth_(0),
+        active_start_(0) {}
+  ~MicroModelBenchmarkProfiler() override {}
+
+  // Starts attributing events of `interpreter`, whose tensors must be
+  // allocated, and clears the measurements.
+  void Attach(MicroInterpreter* interpreter) {
+    interpreter_ = interpreter;
+    op_count_ = std::min(interpreter->operators_size(), capacity_);
+    for (size_t i = 0; i < op_count_; ++i) {
+      ops_[i].name = RegistrationName(i);
+      ops_[i].invocations = 0;
+      ops_[i].ns = 0;
+    }
+    depth_ = 0;
+    active_op_ = -1;
+  }
+
+  uint32_t BeginEvent(const char* tag) override {
+    if (active_op_ < 0 && interpreter_ != nullptr &&
+        interpreter_->current_subgraph_index() == 0) {
+      const int op = interpreter_->current_operator_index();
+      if (op >= 0 && static_cast<size_t>(op) < op_count_ &&
+          tag != nullptr && ops_[op].name != nullptr &&
+          (tag == ops_[op].name || strcmp(tag, ops_[op].name) == 0)) {
+        active_op_ = op;
+        active_depth_ = depth_;
+        active_start_ = clock_();
+      }
+    }
+    ++depth_;
+    return 0;
+  }
+
+  void EndEvent(uint32_t /*event_handle*/) override {
+    if (depth_ > 0) {
+      --depth_;
+    }
+    if (active_op_ >= 0 && depth_ == active_depth_) {
+      ops_[active_op_].ns += clock_() - active_start_;
+      ++ops_[active_op_].invocations;
+      active_op_ = -1;
+    }
+  }
+
+  size_t op_count() const { return op_count_; }
+  const MicroModelBenchmarkOp& op(size_t i) const { return ops_[i]; }
+
+ private:
+  const char* RegistrationName(size_t op) const {
+    const TFLMRegistration* registration =
+        interpreter_->node_and_registration(0, op).registration;
+    if (registration == nullptr) {
+      return nullptr;
+    }
+    return registration->builtin_code == BuiltinOperator_CUSTOM
+               ? registration->custom_name
+               : EnumNameBuiltinOperator(static_cast<BuiltinOperator>(
+                     registration->builtin_code));
+  }
+
+  MicroModelBenchmarkOp* ops_;
+  size_t capacity_;
+  size_t op_count_;
+  MicroBenchmarkClock clock_;
+  MicroInterpreter* interpreter_;
+  int depth_;
+  int active_op_;
+  int active_depth_;
+  uint64_t active_start_;
+
+  TF_LITE_REMOVE_VIRTUAL_DELETE
+};
+
+struct MicroModelBenchmarkConfig {
+  // The arena bisection searches in [0, arena_size).
+  uint8_t* arena;
+  size_t arena_size;
+  uint32_t warmup_invocations;
+  // Timed invocations, `latencies` holds one entry per invocation.
+  uint32_t invocations;
+  uint64_t* latencies;
+  // One entry per operator of the first subgraph. Operators past `op_capacity`
+  // are not broken down.
+  MicroModelBenchmarkOp* ops;
+  size_t op_capacity;
+  // MicroBenchmarkDefaultClock() if null.
+  MicroBenchmarkClock clock;
+};
+
+// Arena and latency figures of a model, in the units of the JSON report.
+struct MicroModelBenchmarkResult {
+  size_t minimum_arena_bytes;
+  uint32_t bisection_steps;
+  size_t arena_used_bytes;
+  size_t persistent_bytes;
+  size_t non_persistent_bytes;
+  size_t scratch_bytes;
+  uint32_t scratch_buffers;
+  uint32_t invocations;
+  uint64_t min_ns;
+  uint64_t p50_ns;
+  uint64_t p99_ns;
+  uint64_t max_ns;
+  uint64_t mean_ns;
+};
+
+// End-to-end model benchmark. For a model in memory it
+//   - builds a MicroModelOpResolver from the model's operator codes,
+//   - finds the smallest arena AllocateTensors() succeeds with, by bisection
+//     with RecordingMicroAllocator, to 16 bytes,
+//   - runs warmup and then timed invocations in an arena of that size plus
+//     `kArenaMargin`,
+// and writes one JSON object:
+//
+//   {"model":{"subgraphs":1,"operators":31,"operator_codes":6,
+//             "unsupported_ops":[]},
+//    "arena":{"minimum_bytes":53248,"bisection_steps":12,
+//             "used_bytes":53200,"persistent_bytes":9760,
+//             "non_persistent_bytes":43440,"scratch_bytes":2048,
+//             "scratch_buffers":3,"recorded":{"tflite_eval_tensor_data":...}},
+//    "latency":{"invocations":100,"min_ns":...,"p50_ns":...,"p99_ns":...,
+//               "max_ns":...,"mean_ns":...},
+//    "operators":[{"index":0,"op":"CONV_2D","invocations":100,
+//                  "mean_ns":...,"share":12.345},...],
+//    "scratch":[{"op":"CONV_2D","scratch_bytes":2048,
+//                "scratch_buffers":3},...],
+//    "status":"ok"}
+//
+// Latencies are wall time of Invoke() without a profiler. The operator times
+// come from a second, profiled run of as many invocations in a fresh
+// interpreter. "share" is the percentage of the summed operator times.
+// Inputs are filled with deterministic pseudo random bytes. Failed bisection
+// steps print the allocation errors of the interpreter.
+//
+// A Linux host tool reads the .tflite file and writes to stdout:
+//
+//   std::vector<uint8_t> model = ReadFile(argv[1]);
+//   static uint8_t arena[16 << 20];
+//   static uint64_t latencies[1000];
+//   static tflite::MicroModelBenchmarkOp ops[512];
+//   tflite::AllOpsResolver all_ops;
+//   tflite::MicroModelBenchmark benchmark(WriteToStdout, nullptr);
+//   tflite::MicroModelBenchmarkConfig config = {
+//       arena, sizeof(arena), 10, 1000, latencies, ops, 512, nullptr};
+//   return benchmark.Run(model.data(), all_ops, config) == kTfLiteOk ? 0 : 1;
+//
+// On the ETISS RISC-V simulator, set `config.clock` to
+// RiscvEtissBenchmarkClock from riscv_benchmark_clock.h.
+class MicroModelBenchmark {
+ public:
+  // Added to the minimum arena for the timed run, for the recording overhead
+  // and kernels whose temporary allocations vary between invocations.
+  static constexpr size_t kArenaMargin = 1024;
+
+  MicroModelBenchmark(MicroTextSink sink, void* context)
+      : writer_(sink, context) {}
+
+  TfLiteStatus Run(const void* model_data, const MicroOpResolver& ops,
+                   const MicroModelBenchmarkConfig& config,
+                   MicroModelBenchmarkResult* result_out = nullptr) {
+    MicroModelBenchmarkResult result = {};
+    const Model* model = GetModel(model_data);
+    if (model->version() != TFLITE_SCHEMA_VERSION) {
+      MicroPrintf("Model schema version %d is not supported, expected %d",
+                  static_cast<int>(model->version()), TFLITE_SCHEMA_VERSION);
+      return kTfLiteError;
+    }
+    if (config.arena == nullptr || config.invocations == 0 ||
+        config.latencies == nullptr) {
+      return kTfLiteError;
+    }
+    const MicroBenchmarkClock clock =
+        config.clock != nullptr ? config.clock : MicroBenchmarkDefaultClock;
+    MicroModelOpResolver resolver(model, ops);
+
+    writer_.Append("{\"model\":{");
+    writer_.AppendNumber("subgraphs",
+                         model->subgraphs() != nullptr
+                             ? model->subgraphs()->size()
+                             : 0,
+                         /*first=*/true);
+    writer_.AppendNumber("operators", NumSubgraphOperators(model, 0));
+    writer_.AppendNumber("operator_codes",
+                         model->operator_codes() != nullptr
+                             ? model->operator_codes()->size()
+                             : 0);
+    writer_.AppendKey("unsupported_ops");
+    writer_.Append('[');
+    for (int i = 0; i < resolver.unsupported_op_count(); ++i) {
+      const OperatorCode* op_code =
+          model->operator_codes()->Get(resolver.unsupported_op(i));
+      const BuiltinOperator builtin = FlatbufferOperatorBuiltinCode(op_code);
+      writer_.Append(i == 0 ? "\"" : ",\"");
+      writer_.AppendEscaped(builtin == BuiltinOperator_CUSTOM &&
+                                    op_code->custom_code() != nullptr
+                                ? op_code->custom_code()->c_str()
+                                : EnumNameBuiltinOperator(builtin));
+      writer_.Append('"');
+    }
+    writer_.Append("]}");
+
+    TfLiteStatus status =
+        resolver.unsupported_op_count() == 0 ? kTfLiteOk : kTfLiteError;
+    if (resolver.too_many_op_codes()) {
+      MicroPrintf("Model has %d operator codes, at most %d are supported",
+                  static_cast<int>(model->operator_codes()->size()),
+                  MicroModelOpResolver::kMaxOperatorCodes);
+      status = kTfLiteError;
+    }
+    if (status == kTfLiteOk) {
+      status = FindMinimumArena(model, resolver, config, &result);
+    }
+    if (status == kTfLiteOk) {
+      status = Measure(model, &resolver, config, clock, &result);
+    }
+    writer_.Append(",\"status\":\"");
+    writer_.Append(status == kTfLiteOk ? "ok" : "error");
+    writer_.Append("\"}\n");
+    writer_.Flush();
+    if (result_out != nullptr) {
+      *result_out = result;
+    }
+    return status;
+  }
+
+ private:
+  static constexpr size_t kArenaGranularity = 16;
+
+  static size_t AlignUp(size_t bytes) {
+    return (bytes + kArenaGranularity - 1) & ~(kArenaGranularity - 1);
+  }
+
+  // Returns true if AllocateTensors() succeeds in `arena_size` bytes, and the
+  // used bytes in `used_bytes`.
+  static bool Fits(const Model* model, const MicroOpResolver& resolver,
+                   uint8_t* arena, size_t arena_size, size_t* used_bytes) {
+    RecordingMicroAllocator* allocator =
+        RecordingMicroAllocator::Create(arena, arena_size);
+    if (allocator == nullptr) {
+      return false;
+    }
+    RecordingMicroInterpreter interpreter(model, resolver, allocator);
+    if (interpreter.AllocateTensors() != kTfLiteOk) {
+      return false;
+    }
+    *used_bytes = interpreter.arena_used_bytes();
+    return true;
+  }
+
+  static TfLiteStatus FindMinimumArena(const Model* model,
+                                       const MicroOpResolver& resolver,
+                                       const MicroModelBenchmarkConfig& config,
+                                       MicroModelBenchmarkResult* result) {
+    // Invariant: `low` does not fit, `high` does.
+    size_t used_bytes = 0;
+    size_t high = config.arena_size & ~(kArenaGranularity - 1);
+    ++result->bisection_steps;
+    if (!Fits(model, resolver, config.arena, high, &used_bytes)) {
+      MicroPrintf("Model does not fit in an arena of %d bytes",
+                  static_cast<int>(config.arena_size));
+      return kTfLiteError;
+    }
+    // Smaller arenas cannot even hold the allocator, which Create() does not
+    // check for.
+    size_t low = RecordingMicroAllocator::GetDefaultTailUsage() &
+                 ~(kArenaGranularity - 1);
+    // The used bytes of the full arena are usually close to the minimum.
+    const size_t guess = AlignUp(used_bytes);
+    if (guess > low && guess < high) {
+      ++result->bisection_steps;
+      if (Fits(model, resolver, config.arena, guess, &used_bytes)) {
+        high = guess;
+      } else {
+        low = guess;
+      }
+    }
+    while (high - low > kArenaGranularity) {
+      const size_t middle = AlignUp(low + (high - low) / 2);
+      ++result->bisection_steps;
+      if (Fits(model, resolver, config.arena, middle, &used_bytes)) {
+        high = middle;
+      } else {
+        low = middle;
+      }
+    }
+    result->minimum_arena_bytes = high;
+    return kTfLiteOk;
+  }
+
+  TfLiteStatus Measure(const Model* model, MicroModelOpResolver* resolver,
+                       const MicroModelBenchmarkConfig& config,
+                       MicroBenchmarkClock clock,
+                       MicroModelBenchmarkResult* result) {
+    const size_t arena_size =
+        std::min(result->minimum_arena_bytes + kArenaMargin, config.arena_size);
+    {
+      RecordingMicroAllocator* allocator =
+          RecordingMicroAllocator::Create(config.arena, arena_size);
+      if (allocator == nullptr) {
+        return kTfLiteError;
+      }
+      RecordingMicroInterpreter interpreter(model, *resolver, allocator);
+      resolver->ResetScratch();
+      TF_LITE_ENSURE_STATUS(interpreter.AllocateTensors());
+      for (int i = 0; i < resolver->registration_count(); ++i) {
+        result->scratch_bytes += resolver->scratch_bytes_at(i);
+        result->scratch_buffers += resolver->scratch_buffers_at(i);
+      }
+      result->arena_used_bytes = interpreter.arena_used_bytes();
+      const RecordingSingleArenaBufferAllocator* memory =
+          allocator->GetSimpleMemoryAllocator();
+      result->persistent_bytes = memory->GetPersistentUsedBytes();
+      result->non_persistent_bytes = memory->GetNonPersistentUsedBytes();
+      WriteArena(*allocator, *result);
+
+      FillInputs(&interpreter);
+      for (uint32_t i = 0; i < config.warmup_invocations; ++i) {
+        TF_LITE_ENSURE_STATUS(interpreter.Invoke());
+      }
+      uint64_t total_ns = 0;
+      for (uint32_t i = 0; i < config.invocations; ++i) {
+        const uint64_t start = clock();
+        TF_LITE_ENSURE_STATUS(interpreter.Invoke());
+        config.latencies[i] = clock() - start;
+        total_ns += config.latencies[i];
+        ++result->invocations;
+      }
+      std::sort(config.latencies, config.latencies + config.invocations);
+      result->min_ns = config.latencies[0];
+      result->p50_ns = Percentile(config.latencies, config.invocations, 50);
+      result->p99_ns = Percentile(config.latencies, config.invocations, 99);
+      result->max_ns = config.latencies[config.invocations - 1];
+      result->mean_ns = total_ns / config.invocations;
+      WriteLatency(*result);
+    }
+
+    // The per-operator breakdown runs in its own interpreter, so that the
+    // profiler does not distort the latencies above.
+    MicroModelBenchmarkProfiler profiler(config.ops, config.op_capacity,
+                                         clock);
+    if (config.ops != nullptr) {
+      RecordingMicroAllocator* allocator =
+          RecordingMicroAllocator::Create(config.arena, arena_size);
+      if (allocator == nullptr) {
+        return kTfLiteError;
+      }
+      RecordingMicroInterpreter interpreter(model, *resolver, allocator,
+                                            nullptr, &profiler);
+      resolver->ResetScratch();
+      TF_LITE_ENSURE_STATUS(interpreter.AllocateTensors());
+      FillInputs(&interpreter);
+      for (uint32_t i = 0; i < config.warmup_invocations; ++i) {
+        TF_LITE_ENSURE_STATUS(interpreter.Invoke());
+      }
+      profiler.Attach(&interpreter);
+      for (uint32_t i = 0; i < config.invocations; ++i) {
+        TF_LITE_ENSURE_STATUS(interpreter.Invoke());
+      }
+    }
+    WriteOperators(profiler);
+    WriteScratch(*resolver);
+    return kTfLiteOk;
+  }
+
+  // Fills the inputs with deterministic pseudo random bytes.
+  static void FillInputs(MicroInterpreter* interpreter) {
+    uint32_t seed = 1;
+    for (size_t i = 0; i < interpreter->inputs_size(); ++i) {
+      TfLiteTensor* input = interpreter->input(i);
+      for (size_t j = 0; input != nullptr && j < input->bytes; ++j) {
+        seed = seed * 1664525u + 1013904223u;
+        input->data.uint8[j] = static_cast<uint8_t>(seed >> 24);
+      }
+    }
+  }
+
+  // Nearest rank percentile of sorted `values`.
+  static uint64_t Percentile(const uint64_t* values, uint32_t count,
+                             uint32_t percent) {
+    const uint64_t rank =
+        (static_cast<uint64_t>(count) * percent + 99) / 100;
+    return values[rank > 0 ? rank - 1 : 0];
+  }
+
+  void WriteArena(const RecordingMicroAllocator& allocator,
+                  const MicroModelBenchmarkResult& result) {
+    writer_.Append(",\"arena\":{");
+    writer_.AppendNumber("minimum_bytes", result.minimum_arena_bytes,
+                         /*first=*/true);
+    writer_.AppendNumber("bisection_steps", result.bisection_steps);
+    writer_.AppendNumber("used_bytes", result.arena_used_bytes);
+    writer_.AppendNumber("persistent_bytes", result.persistent_bytes);
+    writer_.AppendNumber("non_persistent_bytes", result.non_persistent_bytes);
+    writer_.AppendNumber("scratch_bytes", result.scratch_bytes);
+    writer_.AppendNumber("scratch_buffers", result.scratch_buffers);
+    writer_.AppendKey("recorded");
+    writer_.Append('{');
+    static const struct {
+      RecordedAllocationType type;
+      const char* name;
+    } kRecorded[] = {
+        {RecordedAllocationType::kTfLiteEvalTensorData,
+         "tflite_eval_tensor_data"},
+        {RecordedAllocationType::kPersistentTfLiteTensorData,
+         "persistent_tflite_tensor_data"},
+        {RecordedAllocationType::kPersistentTfLiteTensorQuantizationData,
+         "persistent_tflite_tensor_quantization_data"},
+        {RecordedAllocationType::kPersistentBufferData,
+         "persistent_buffer_data"},
+        {RecordedAllocationType::kTfLiteTensorVariableBufferData,
+         "tflite_tensor_variable_buffer_data"},
+        {RecordedAllocationType::kNodeAndRegistrationArray,
+         "node_and_registration_array"},
+        {RecordedAllocationType::kOpData, "op_data"},
+    };
+    for (size_t i = 0; i < sizeof(kRecorded) / sizeof(kRecorded[0]); ++i) {
+      writer_.AppendNumber(
+          kRecorded[i].name,
+          allocator.GetRecordedAllocation(kRecorded[i].type).used_bytes,
+          /*first=*/i == 0);
+    }
+    writer_.Append("}}");
+  }
+
+  void WriteLatency(const MicroModelBenchmarkResult& result) {
+    writer_.Append(",\"latency\":{");
+    writer_.AppendNumber("invocations", result.invocations, /*first=*/true);
+    writer_.AppendNumber("min_ns", result.min_ns);
+    writer_.AppendNumber("p50_ns", result.p50_ns);
+    writer_.AppendNumber("p99_ns", result.p99_ns);
+    writer_.AppendNumber("max_ns", result.max_ns);
+    writer_.AppendNumber("mean_ns", result.mean_ns);
+    writer_.Append('}');
+  }
+
+  void WriteOperators(const MicroModelBenchmarkProfiler& profiler) {
+    writer_.Append(",\"operators\":[");
+    uint64_t total_ns = 0;
+    for (size_t i = 0; i < profiler.op_count(); ++i) {
+      total_ns += profiler.op(i).ns;
+    }
+    for (size_t i = 0; i < profiler.op_count(); ++i) {
+      const MicroModelBenchmarkOp& op = profiler.op(i);
+      writer_.Append(i == 0 ? "\n{" : ",\n{");
+      writer_.AppendNumber("index", i, /*first=*/true);
+      writer_.AppendString("op", op.name);
+      writer_.AppendNumber("invocations", op.invocations);
+      writer_.AppendNumber("mean_ns",
+                           op.invocations > 0 ? op.ns / op.invocations : 0);
+      writer_.AppendKey("share");
+      writer_.AppendThousandths(total_ns > 0 ? op.ns * 100000u / total_ns
+                                             : 0);
+      writer_.Append('}');
+    }
+    writer_.Append(']');
+  }
+
+  // Scratch buffers are counted in the prepare of each registration, so they
+  // are reported per operator code rather than per operator.
+  void WriteScratch(const MicroModelOpResolver& resolver) {
+    writer_.Append(",\"scratch\":[");
+    for (int i = 0; i < resolver.registration_count(); ++i) {
+      const TFLMRegistration& registration = resolver.registration_at(i);
+      writer_.Append(i == 0 ? "\n{" : ",\n{");
+      writer_.AppendString(
+          "op",
+          registration.builtin_code == BuiltinOperator_CUSTOM
+              ? registration.custom_name
+              : EnumNameBuiltinOperator(
+                    static_cast<BuiltinOperator>(registration.builtin_code)),
+          /*first=*/true);
+      writer_.AppendNumber("scratch_bytes", resolver.scratch_bytes_at(i));
+      writer_.AppendNumber("scratch_buffers", resolver.scratch_buffers_at(i));
+      writer_.Append('}');
+    }
+    writer_.Append(']');
+  }
+
+  MicroJsonWriter writer_;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MICRO_MODEL_BENCHMARK_H_
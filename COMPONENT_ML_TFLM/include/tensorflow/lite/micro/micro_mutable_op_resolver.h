@@ -734,6 +734,20 @@ class MicroMutableOpResolver : public MicroOpResolver {
 
   unsigned int GetRegistrationLength() { return registrations_len_; }
 
+ protected:
+  // Access for resolvers that index the registrations, in registration order.
+  unsigned int registration_count() const { return registrations_len_; }
+  const TFLMRegistration& registration_at(unsigned int index) const {
+    return registrations_[index];
+  }
+  unsigned int builtin_op_count() const { return num_buitin_ops_; }
+  BuiltinOperator builtin_code_at(unsigned int index) const {
+    return builtin_codes_[index];
+  }
+  TfLiteBridgeBuiltinParseFunction builtin_parser_at(unsigned int index) const {
+    return builtin_parsers_[index];
+  }
+
  private:
   TfLiteStatus AddBuiltin(tflite::BuiltinOperator op,
                           const TFLMRegistration& registration,
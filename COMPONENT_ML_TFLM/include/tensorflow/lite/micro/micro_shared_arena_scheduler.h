@@ -0,0 +1,285 @@
+/* Copyright 2025 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_MICRO_SHARED_ARENA_SCHEDULER_H_
+#define TENSORFLOW_LITE_MICRO_MICRO_SHARED_ARENA_SCHEDULER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/compatibility.h"
+#include "tensorflow/lite/micro/micro_allocator.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/micro_log.h"
+
+namespace tflite {
+
+// Lets several MicroInterpreters keep private persistent arenas while
+// time-sharing a single non-persistent arena.
+//
+// Every model gets a MicroAllocator created with the persistent/non-persistent
+// split MicroAllocator::Create() overload. All of these allocators plan their
+// activation tensors and scratch buffers into the same non-persistent arena,
+// so it only has to be as large as the biggest single model needs instead of
+// the sum over all models. Persistent data (TfLiteTensor/TfLiteEvalTensor
+// structs, kernel op data, variable tensors and resource variables) stays in
+// the per-model persistent arena and survives a model switch.
+//
+// The price is that only one model owns the contents of the shared arena at a
+// time. The scheduler tracks that owner:
+//   - AllocateTensors(), AcquireInputs() and Invoke() make a model the owner.
+//   - Invoke() of a model fails if another model took ownership since this
+//     model's inputs were written, because the inputs were overwritten.
+//   - AreTensorsValid() tells whether the input and output tensors of a model
+//     still hold its data, i.e. whether it is safe to read its outputs.
+// Calls are serialized through an optional Lock. Without a lock, a call that
+// enters the scheduler while another one is in progress (e.g. from an
+// interrupt or another thread) is rejected instead of corrupting the shared
+// arena. That check is an atomic test-and-set, so it also holds between
+// cores, but the rejected caller has to retry; use a Lock to wait instead.
+//
+// Example:
+//
+//   alignas(16) static uint8_t shared_arena[96 * 1024];
+//   alignas(16) static uint8_t vad_arena[8 * 1024];
+//   alignas(16) static uint8_t kws_arena[12 * 1024];
+//
+//   tflite::MicroSharedArenaScheduler<2> scheduler(shared_arena,
+//                                                  sizeof(shared_arena));
+//   tflite::MicroInterpreter vad(vad_model, resolver,
+//       scheduler.CreateAllocator(vad_arena, sizeof(vad_arena)));
+//   tflite::MicroInterpreter kws(kws_model, resolver,
+//       scheduler.CreateAllocator(kws_arena, sizeof(kws_arena)));
+//   int vad_id, kws_id;
+//   scheduler.AddModel(&vad, &vad_id);
+//   scheduler.AddModel(&kws, &kws_id);
+//   scheduler.AllocateTensors(vad_id);
+//   scheduler.AllocateTensors(kws_id);
+//
+//   scheduler.AcquireInputs(vad_id);
+//   FillAudio(vad.input(0));
+//   scheduler.Invoke(vad_id);
+//   bool speech = ReadVad(vad.output(0));  // Before the next switch.
+//   if (speech) {
+//     scheduler.AcquireInputs(kws_id);
+//     FillFeatures(kws.input(0));
+//     scheduler.Invoke(kws_id);
+//   }
+template <unsigned int tMaxModels>
+class MicroSharedArenaScheduler {
+ public:
+  // Optional mutual exclusion for use from several RTOS threads. `acquire` is
+  // expected to block until the lock is available.
+  struct Lock {
+    void (*acquire)(void* context);
+    void (*release)(void* context);
+    void* context;
+  };
+
+  static constexpr int kNoModel = -1;
+
+  MicroSharedArenaScheduler(uint8_t* non_persistent_arena,
+                            size_t non_persistent_arena_size,
+                            const Lock* lock = nullptr)
+      : non_persistent_arena_(non_persistent_arena),
+        non_persistent_arena_size_(non_persistent_arena_size),
+        lock_(lock) {}
+
+  // Creates a MicroAllocator whose persistent allocations are made from
+  // `persistent_arena` and whose non-persistent allocations share the arena
+  // of this scheduler. Returns nullptr on failure.
+  MicroAllocator* CreateAllocator(
+      uint8_t* persistent_arena, size_t persistent_arena_size,
+      MemoryPlannerType memory_planner_type = MemoryPlannerType::kGreedy) {
+    if (memory_planner_type == MemoryPlannerType::kLinear) {
+      MicroPrintf(
+          "The linear memory planner preserves all tensors and cannot share "
+          "a non-persistent arena.");
+      return nullptr;
+    }
+    return MicroAllocator::Create(persistent_arena, persistent_arena_size,
+                                  non_persistent_arena_,
+                                  non_persistent_arena_size_,
+                                  memory_planner_type);
+  }
+
+  // Registers an interpreter that was constructed with an allocator from
+  // CreateAllocator(). The id to use with the other methods is returned in
+  // `model_id`.
+  TfLiteStatus AddModel(MicroInterpreter* interpreter, int* model_id) {
+    if (interpreter == nullptr || model_id == nullptr) {
+      return kTfLiteError;
+    }
+    if (model_count_ >= static_cast<int>(tMaxModels)) {
+      MicroPrintf("MicroSharedArenaScheduler is full (%d models).",
+                  static_cast<int>(tMaxModels));
+      return kTfLiteError;
+    }
+    if (interpreter->preserve_all_tensors()) {
+      MicroPrintf(
+          "Interpreters preserving all tensors cannot share a non-persistent "
+          "arena.");
+      return kTfLiteError;
+    }
+    models_[model_count_].interpreter = interpreter;
+    models_[model_count_].allocated = false;
+    *model_id = model_count_++;
+    return kTfLiteOk;
+  }
+
+  // Allocates the tensors of a model. Prepare() of the kernels uses the
+  // shared arena for temporary data, so this makes the model the owner.
+  // Afterwards it is validated that no input or output tensor ended up
+  // outside of the shared arena, which would mean the allocator was not
+  // created through CreateAllocator().
+  TfLiteStatus AllocateTensors(int model_id) {
+    TF_LITE_ENSURE_STATUS(Enter(model_id));
+    Model& model = models_[model_id];
+    active_model_ = model_id;
+    TfLiteStatus status = model.interpreter->AllocateTensors();
+    if (status == kTfLiteOk) {
+      status = ValidateTensorPlacement(model_id);
+    }
+    model.allocated = status == kTfLiteOk;
+    Exit();
+    return status;
+  }
+
+  // Makes `model_id` the owner of the shared arena. Must be called before the
+  // input tensors of the model are written; any data other models left in the
+  // shared arena is invalid afterwards.
+  TfLiteStatus AcquireInputs(int model_id) {
+    TF_LITE_ENSURE_STATUS(Enter(model_id));
+    TfLiteStatus status = kTfLiteOk;
+    if (!models_[model_id].allocated) {
+      MicroPrintf("Model %d: AllocateTensors() has not been called.",
+                  model_id);
+      status = kTfLiteError;
+    } else {
+      active_model_ = model_id;
+    }
+    Exit();
+    return status;
+  }
+
+  // Runs a model. Fails without running it if another model has owned the
+  // shared arena since its inputs were acquired.
+  TfLiteStatus Invoke(int model_id) {
+    TF_LITE_ENSURE_STATUS(Enter(model_id));
+    TfLiteStatus status = kTfLiteOk;
+    if (active_model_ != model_id) {
+      MicroPrintf(
+          "Model %d: inputs were overwritten by model %d, call "
+          "AcquireInputs() and write the inputs again.",
+          model_id, active_model_);
+      status = kTfLiteError;
+    } else {
+      status = models_[model_id].interpreter->Invoke();
+    }
+    Exit();
+    return status;
+  }
+
+  // Returns true while the input and output tensors of `model_id` are backed
+  // by its own data.
+  bool AreTensorsValid(int model_id) const {
+    return model_id >= 0 && model_id == active_model_;
+  }
+
+  int active_model() const { return active_model_; }
+
+  int model_count() const { return model_count_; }
+
+  uint8_t* non_persistent_arena() const { return non_persistent_arena_; }
+
+  size_t non_persistent_arena_size() const {
+    return non_persistent_arena_size_;
+  }
+
+ private:
+  struct Model {
+    MicroInterpreter* interpreter;
+    bool allocated;
+  };
+
+  TfLiteStatus Enter(int model_id) {
+    if (model_id < 0 || model_id >= model_count_) {
+      MicroPrintf("Invalid model id %d.", model_id);
+      return kTfLiteError;
+    }
+    if (lock_ != nullptr) {
+      lock_->acquire(lock_->context);
+    } else if (busy_.test_and_set(std::memory_order_acquire)) {
+      MicroPrintf("Model %d: scheduler re-entered while model %d is running.",
+                  model_id, active_model_);
+      return kTfLiteError;
+    }
+    return kTfLiteOk;
+  }
+
+  void Exit() {
+    if (lock_ != nullptr) {
+      lock_->release(lock_->context);
+    } else {
+      busy_.clear(std::memory_order_release);
+    }
+  }
+
+  bool IsInSharedArena(const TfLiteTensor* tensor) const {
+    if (tensor == nullptr || tensor->data.raw == nullptr) {
+      return true;
+    }
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(tensor->data.raw);
+    return data >= non_persistent_arena_ &&
+           data < non_persistent_arena_ + non_persistent_arena_size_;
+  }
+
+  TfLiteStatus ValidateTensorPlacement(int model_id) {
+    MicroInterpreter* interpreter = models_[model_id].interpreter;
+    for (size_t i = 0; i < interpreter->inputs_size(); ++i) {
+      if (!IsInSharedArena(interpreter->input(i))) {
+        MicroPrintf("Model %d: input %d is not in the shared arena.", model_id,
+                    static_cast<int>(i));
+        return kTfLiteError;
+      }
+    }
+    for (size_t i = 0; i < interpreter->outputs_size(); ++i) {
+      if (!IsInSharedArena(interpreter->output(i))) {
+        MicroPrintf("Model %d: output %d is not in the shared arena.",
+                    model_id, static_cast<int>(i));
+        return kTfLiteError;
+      }
+    }
+    return kTfLiteOk;
+  }
+
+  uint8_t* non_persistent_arena_;
+  size_t non_persistent_arena_size_;
+  const Lock* lock_;
+
+  Model models_[tMaxModels] = {};
+  int model_count_ = 0;
+  int active_model_ = kNoModel;
+  std::atomic_flag busy_ = ATOMIC_FLAG_INIT;
+
+ public:
+  TF_LITE_REMOVE_VIRTUAL_DELETE
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MICRO_SHARED_ARENA_SCHEDULER_H_
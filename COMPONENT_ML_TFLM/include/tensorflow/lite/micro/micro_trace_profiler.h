@@ -0,0 +1,220 @@
+/* Copyright 2025 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_MICRO_TRACE_PROFILER_H_
+#define TENSORFLOW_LITE_MICRO_MICRO_TRACE_PROFILER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/compatibility.h"
+#include "tensorflow/lite/micro/micro_json_writer.h"
+#include "tensorflow/lite/micro/micro_log.h"
+#include "tensorflow/lite/micro/micro_profiler_interface.h"
+#include "tensorflow/lite/micro/micro_time.h"
+
+namespace tflite {
+
+// One profiled event. `bytes` and `macs` are an optional payload that code
+// inside the event adds with MicroTraceProfiler::AddPayload().
+struct MicroTraceEvent {
+  const char* tag;
+  uint32_t start_ticks;
+  uint32_t end_ticks;
+  uint32_t bytes;
+  uint32_t macs;
+  uint16_t depth;  // Nesting level, 0 for outermost events.
+  uint16_t complete;
+};
+
+// Receives chunks of exported trace data, e.g. to write them to a UART or a
+// file. Chunks are not null terminated.
+typedef MicroTextSink MicroTraceSink;
+
+// Profiler that records events into a ring buffer provided by the application,
+// for continuous profiling of production builds.
+//
+// Compared to MicroProfiler:
+//   - BeginEvent() and EndEvent() are O(1) and never search by tag.
+//   - When the buffer is full the oldest events are overwritten, so the buffer
+//     always holds the most recent history.
+//   - Events nest (operator -> kernel variant -> NPU job -> decompression);
+//     the nesting depth is recorded with each event.
+//   - Events carry a payload of bytes moved and MACs.
+//   - ExportChromeTrace() writes the events as Chrome trace-event JSON, which
+//     chrome://tracing and the Perfetto UI open directly. It formats numbers
+//     itself, so it also works with TF_LITE_STRIP_ERROR_STRINGS.
+//
+// The profiler is not thread or interrupt safe; use one instance per thread.
+//
+// Example:
+//
+//   static tflite::MicroTraceEvent events[256];
+//   tflite::MicroTraceProfiler profiler(events, 256);
+//   tflite::MicroInterpreter interpreter(model, resolver, arena, arena_size,
+//                                        nullptr, &profiler);
+//   ...
+//   profiler.ExportChromeTrace(WriteToUart, nullptr);
+class MicroTraceProfiler : public MicroProfilerInterface {
+ public:
+  // Open events deeper than this are still recorded, but AddPayload() cannot
+  // address them through the innermost-event shortcut.
+  static constexpr int kMaxDepth = 8;
+
+  // `capacity` must be a power of two. `events` must outlive the profiler.
+  MicroTraceProfiler(MicroTraceEvent* events, uint32_t capacity)
+      : events_(events),
+        mask_((capacity & (capacity - 1)) == 0 ? capacity - 1 : 0),
+        next_(0),
+        depth_(0) {
+    if (events_ == nullptr || capacity == 0 || mask_ == 0) {
+      MicroPrintf("MicroTraceProfiler capacity must be a power of two >= 2");
+      events_ = nullptr;
+    }
+  }
+  ~MicroTraceProfiler() override {}
+
+  // The returned handle is the sequence number of the event.
+  uint32_t BeginEvent(const char* tag) override {
+    const uint32_t handle = next_++;
+    if (events_ == nullptr) {
+      return handle;
+    }
+    MicroTraceEvent& event = events_[handle & mask_];
+    event.tag = tag;
+    event.bytes = 0;
+    event.macs = 0;
+    event.depth = static_cast<uint16_t>(depth_);
+    event.complete = 0;
+    if (depth_ < kMaxDepth) {
+      open_[depth_] = handle;
+    }
+    ++depth_;
+    event.start_ticks = GetCurrentTimeTicks();
+    event.end_ticks = event.start_ticks;
+    return handle;
+  }
+
+  void EndEvent(uint32_t event_handle) override {
+    const uint32_t end_ticks = GetCurrentTimeTicks();
+    if (depth_ > 0) {
+      --depth_;
+    }
+    MicroTraceEvent* event = Lookup(event_handle);
+    if (event != nullptr) {
+      event->end_ticks = end_ticks;
+      event->complete = 1;
+    }
+  }
+
+  // Adds to the payload of an event that has not been overwritten yet.
+  void AddPayload(uint32_t event_handle, uint32_t bytes, uint32_t macs) {
+    MicroTraceEvent* event = Lookup(event_handle);
+    if (event != nullptr) {
+      event->bytes += bytes;
+      event->macs += macs;
+    }
+  }
+
+  // Adds to the payload of the innermost open event, for code that does not
+  // own the event handle (e.g. a kernel reporting its MACs).
+  void AddPayload(uint32_t bytes, uint32_t macs) {
+    if (depth_ > 0 && depth_ <= kMaxDepth) {
+      AddPayload(open_[depth_ - 1], bytes, macs);
+    }
+  }
+
+  void ClearEvents() {
+    next_ = 0;
+    depth_ = 0;
+  }
+
+  // Number of events currently held, oldest first in GetEvent().
+  uint32_t event_count() const {
+    if (events_ == nullptr) {
+      return 0;
+    }
+    return next_ > mask_ ? mask_ + 1 : next_;
+  }
+
+  // Number of events that were overwritten since the last ClearEvents().
+  uint32_t dropped_events() const { return next_ - event_count(); }
+
+  const MicroTraceEvent& GetEvent(uint32_t index) const {
+    return events_[(next_ - event_count() + index) & mask_];
+  }
+
+  // Writes the held events as Chrome trace-event JSON ("X" complete events,
+  // timestamps in microseconds relative to the oldest event). Events that
+  // have not ended yet are exported with a duration of zero.
+  void ExportChromeTrace(MicroTraceSink sink, void* sink_context) const {
+    MicroJsonWriter writer(sink, sink_context);
+    writer.Append("{\"traceEvents\":[");
+    const uint32_t count = event_count();
+    const uint32_t base = count > 0 ? GetEvent(0).start_ticks : 0;
+    uint32_t tick_rate = ticks_per_second();
+    tick_rate = tick_rate > 0 ? tick_rate : 1;
+    for (uint32_t i = 0; i < count; ++i) {
+      const MicroTraceEvent& event = GetEvent(i);
+      writer.Append(i == 0 ? "\n{\"name\":\"" : ",\n{\"name\":\"");
+      writer.AppendEscaped(event.tag);
+      writer.Append("\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":");
+      writer.AppendThousandths(
+          Nanoseconds(event.start_ticks - base, tick_rate));
+      writer.Append(",\"dur\":");
+      writer.AppendThousandths(Nanoseconds(
+          event.complete ? event.end_ticks - event.start_ticks : 0, tick_rate));
+      writer.Append(",\"args\":{\"depth\":");
+      writer.AppendUnsigned(event.depth);
+      writer.Append(",\"bytes\":");
+      writer.AppendUnsigned(event.bytes);
+      writer.Append(",\"macs\":");
+      writer.AppendUnsigned(event.macs);
+      writer.Append("}}");
+    }
+    writer.Append("\n],\"otherData\":{\"dropped_events\":");
+    writer.AppendUnsigned(dropped_events());
+    writer.Append("}}\n");
+    writer.Flush();
+  }
+
+ private:
+  // Timestamps are exported in microseconds with three decimals.
+  static uint64_t Nanoseconds(uint32_t ticks, uint32_t tick_rate) {
+    return static_cast<uint64_t>(ticks) * 1000000000u / tick_rate;
+  }
+
+  MicroTraceEvent* Lookup(uint32_t event_handle) {
+    // Handles older than the buffer capacity refer to overwritten events.
+    if (events_ == nullptr || next_ - event_handle - 1 > mask_) {
+      return nullptr;
+    }
+    return &events_[event_handle & mask_];
+  }
+
+  MicroTraceEvent* events_;
+  uint32_t mask_;
+  uint32_t next_;
+  int depth_;
+  uint32_t open_[kMaxDepth];
+
+ public:
+  TF_LITE_REMOVE_VIRTUAL_DELETE
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MICRO_TRACE_PROFILER_H_
@@ -16,7 +16,11 @@ limitations under the License.
 #include <cstring>
 #include <cstdint>
 
+#ifdef IFX_NNLITE_EMULATOR_DRIVER
+#include "ifx_mxnnlite2/nnlite_emulator.h"
+#else
 #include "cy_nn_kernel.h"
+#endif
 
 namespace tflite {
 namespace micro {
@@ -0,0 +1,504 @@
+/* Copyright 2025 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef IFX_TFLM_PRIVATE_IFX_MXNNLITE2_NNLITE_ASYNC_ACCELERATOR_H_
+#define IFX_TFLM_PRIVATE_IFX_MXNNLITE2_NNLITE_ASYNC_ACCELERATOR_H_
+
+#include <cmath>
+#include <cstdint>
+
+#include "ifx_mxnnlite2/nnlite_emulator.h"
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/padding.h"
+#include "tensorflow/lite/micro/micro_async_accelerator.h"
+#include "tensorflow/lite/micro/micro_context.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace micro {
+namespace nnlite {
+
+/*
+ * MicroAsyncAccelerator for host builds that executes the accelerated
+ * operators on the NNLite v2 Emulator, so overlapped execution can be
+ * exercised and its NPU cycles estimated off-target.
+ *
+ * Like the NPU, Submit() only queues the operator; it is executed when the
+ * interpreter waits for it, after any overlapped CPU operator ran. int8
+ * CONV_2D, DEPTHWISE_CONV_2D, FULLY_CONNECTED, MAX_POOL_2D, AVERAGE_POOL_2D
+ * and element-wise ADD, SUB and MUL without broadcasting are mapped to the
+ * emulator. Every other operator, operators with packed sub-8-bit or sparse
+ * filters, and every job the emulator rejects because of a register field
+ * limit run the kernel registered for it, like the on-target fallback to CPU
+ * kernels.
+ *
+ * Example:
+ *
+ *   tflite::micro::nnlite::Emulator emulator;
+ *   tflite::micro::nnlite::EmulatorAsyncAccelerator accelerator(&emulator);
+ *   accelerator.AccelerateDefaultNNLiteOps();
+ *   tflite::OverlapMemoryPlanner planner(&greedy, model, &accelerator);
+ *   ...
+ *   interpreter.InvokeOverlapped(&accelerator, &planner);
+ *   MicroPrintf("NPU cycles: %d", static_cast<int>(emulator.cycles()));
+ */
+class EmulatorAsyncAccelerator : public MicroAsyncAccelerator {
+ public:
+  // Maximum number of output channels of a job with per-channel scalers.
+  static constexpr int kMaxChannels = 1024;
+
+  // Does not take ownership of emulator, which must outlive this object.
+  explicit EmulatorAsyncAccelerator(Emulator* emulator) : emulator_(emulator) {
+    ResetStatistics();
+  }
+
+  TfLiteStatus Submit(TfLiteContext* context, TfLiteNode* node,
+                      const TFLMRegistration* registration,
+                      MicroAsyncCompletionCallback callback,
+                      void* user_data) override {
+    if (pending_.callback != nullptr) {
+      MicroPrintf("Accelerator busy");
+      return kTfLiteError;
+    }
+    pending_.context = context;
+    pending_.node = node;
+    pending_.registration = registration;
+    pending_.callback = callback;
+    pending_.user_data = user_data;
+    return kTfLiteOk;
+  }
+
+  void WaitForEvent() override {
+    if (pending_.callback == nullptr) {
+      return;
+    }
+    Job job = pending_;
+    pending_.callback = nullptr;
+    TfLiteStatus status;
+    if (RunOnEmulator(job)) {
+      ++emulated_jobs_;
+      status = kTfLiteOk;
+    } else {
+      ++fallback_jobs_;
+      status = job.registration->invoke(job.context, job.node);
+    }
+    job.callback(job.user_data, status);
+  }
+
+  void OnOverlappedOperator(int /*operator_index*/) override {
+    ++overlapped_operators_;
+  }
+
+  void ResetStatistics() {
+    pending_.callback = nullptr;
+    emulated_jobs_ = 0;
+    fallback_jobs_ = 0;
+    overlapped_operators_ = 0;
+  }
+
+  // Number of operators executed by the emulator.
+  int emulated_jobs() const { return emulated_jobs_; }
+  // Number of accelerated operators that fell back to their CPU kernel.
+  int fallback_jobs() const { return fallback_jobs_; }
+  // Number of CPU operators that ran while a job was pending.
+  int overlapped_operators() const { return overlapped_operators_; }
+
+ private:
+  struct Job {
+    TfLiteContext* context;
+    TfLiteNode* node;
+    const TFLMRegistration* registration;
+    MicroAsyncCompletionCallback callback;
+    void* user_data;
+  };
+
+  // Quantization and data of one node tensor.
+  struct Operand {
+    const TfLiteEvalTensor* eval;
+    float scale;
+    int32_t zero_point;
+    // Per-channel scales, or nullptr.
+    const TfLiteFloatArray* channel_scales;
+    // kTfLitePackedAffineQuantization, i.e. sub-8-bit or sparse packed
+    // weights, which the emulator can't read.
+    bool is_packed;
+  };
+
+  static bool GetOperand(MicroContext* micro_context, int tensor_index,
+                         Operand* operand) {
+    operand->eval = nullptr;
+    if (tensor_index < 0) {
+      return false;
+    }
+    TfLiteTensor* tensor =
+        micro_context->AllocateTempTfLiteTensor(tensor_index);
+    if (tensor == nullptr) {
+      return false;
+    }
+    operand->eval = micro_context->GetEvalTensor(tensor_index);
+    operand->scale = tensor->params.scale;
+    operand->zero_point = tensor->params.zero_point;
+    operand->channel_scales = nullptr;
+    operand->is_packed =
+        tensor->quantization.type == kTfLitePackedAffineQuantization;
+    if (tensor->quantization.type == kTfLiteAffineQuantization &&
+        tensor->quantization.params != nullptr) {
+      const auto* affine = static_cast<const TfLiteAffineQuantization*>(
+          tensor->quantization.params);
+      if (affine->scale != nullptr && affine->scale->size > 1) {
+        operand->channel_scales = affine->scale;
+      }
+    }
+    micro_context->DeallocateTempTfLiteTensor(tensor);
+    return operand->eval != nullptr;
+  }
+
+  static bool IsInt8(const Operand& operand) {
+    return operand.eval != nullptr && operand.eval->type == kTfLiteInt8 &&
+           operand.eval->data.data != nullptr;
+  }
+
+  // Packed filters run on the CPU kernel, which unpacks them.
+  static bool IsDenseInt8(const Operand& operand) {
+    return IsInt8(operand) && !operand.is_packed;
+  }
+
+  static bool GetShape(const TfLiteEvalTensor* tensor, Shape* shape) {
+    if (tensor->dims == nullptr || tensor->dims->size != 4) {
+      return false;
+    }
+    shape->batches = tensor->dims->data[0];
+    shape->height = tensor->dims->data[1];
+    shape->width = tensor->dims->data[2];
+    shape->channels = tensor->dims->data[3];
+    return true;
+  }
+
+  static int32_t ElementCount(const TfLiteEvalTensor* tensor) {
+    int32_t count = 1;
+    for (int i = 0; i < tensor->dims->size; ++i) {
+      count *= tensor->dims->data[i];
+    }
+    return count;
+  }
+
+  static const int8_t* Data(const Operand& operand) {
+    return static_cast<const int8_t*>(operand.eval->data.data);
+  }
+
+  static int32_t Quantize(float value, const Operand& output) {
+    return output.zero_point +
+           static_cast<int32_t>(std::round(value / output.scale));
+  }
+
+  // int8 range of a fused activation, like CalculateActivationRangeQuantized.
+  static void ActivationRange(TfLiteFusedActivation activation,
+                              const Operand& output, int32_t* min,
+                              int32_t* max) {
+    *min = -128;
+    *max = 127;
+    if (activation == kTfLiteActRelu || activation == kTfLiteActRelu6 ||
+        activation == kTfLiteActReluN1To1) {
+      const int32_t low = Quantize(
+          activation == kTfLiteActReluN1To1 ? -1.0f : 0.0f, output);
+      *min = low > *min ? low : *min;
+    }
+    if (activation == kTfLiteActRelu6 || activation == kTfLiteActReluN1To1) {
+      const int32_t high =
+          Quantize(activation == kTfLiteActRelu6 ? 6.0f : 1.0f, output);
+      *max = high < *max ? high : *max;
+    }
+  }
+
+  // Fills scalers_ with input scale * filter scale / output scale.
+  bool SetupRequantization(const Operand& input, const Operand& filter,
+                           const Operand& output, int channels,
+                           TfLiteFusedActivation activation,
+                           Requantization* requant) {
+    const bool per_channel = filter.channel_scales != nullptr;
+    if (channels > kMaxChannels ||
+        (per_channel && filter.channel_scales->size != channels)) {
+      return false;
+    }
+    const int count = per_channel ? channels : 1;
+    for (int c = 0; c < count; ++c) {
+      const float filter_scale =
+          per_channel ? filter.channel_scales->data[c] : filter.scale;
+      scalers_[c] = input.scale * filter_scale / output.scale;
+    }
+    requant->scalers = scalers_;
+    requant->per_channel = per_channel;
+    requant->output_zero_point = output.zero_point;
+    ActivationRange(activation, output, &requant->activation_min,
+                    &requant->activation_max);
+    return true;
+  }
+
+  // Returns false if the operator has to run on the CPU.
+  bool RunOnEmulator(const Job& job) {
+    MicroContext* micro_context = GetMicroContext(job.context);
+    const TfLiteNode* node = job.node;
+    if (node->inputs == nullptr || node->outputs == nullptr ||
+        node->inputs->size < 1 || node->outputs->size != 1) {
+      return false;
+    }
+    Operand input;
+    Operand output;
+    if (!GetOperand(micro_context, node->inputs->data[0], &input) ||
+        !GetOperand(micro_context, node->outputs->data[0], &output) ||
+        !IsInt8(input) || !IsInt8(output)) {
+      return false;
+    }
+    int8_t* output_data = static_cast<int8_t*>(output.eval->data.data);
+
+    switch (job.registration->builtin_code) {
+      case BuiltinOperator_CONV_2D:
+      case BuiltinOperator_DEPTHWISE_CONV_2D:
+        return RunConvolution(job, micro_context, input, output, output_data);
+      case BuiltinOperator_FULLY_CONNECTED:
+        return RunFullyConnected(job, micro_context, input, output,
+                                 output_data);
+      case BuiltinOperator_MAX_POOL_2D:
+      case BuiltinOperator_AVERAGE_POOL_2D:
+        return RunPool(job, input, output, output_data);
+      case BuiltinOperator_ADD:
+      case BuiltinOperator_SUB:
+      case BuiltinOperator_MUL:
+        return RunBinary(job, micro_context, input, output, output_data);
+      default:
+        return false;
+    }
+  }
+
+  bool RunConvolution(const Job& job, MicroContext* micro_context,
+                      const Operand& input, const Operand& output,
+                      int8_t* output_data) {
+    const TfLiteNode* node = job.node;
+    const bool is_depthwise =
+        job.registration->builtin_code == BuiltinOperator_DEPTHWISE_CONV_2D;
+    Operand filter;
+    Shape input_shape;
+    Shape filter_shape;
+    Shape output_shape;
+    if (node->inputs->size < 2 || node->builtin_data == nullptr ||
+        !GetOperand(micro_context, node->inputs->data[1], &filter) ||
+        !IsDenseInt8(filter) || !GetShape(input.eval, &input_shape) ||
+        !GetShape(filter.eval, &filter_shape) ||
+        !GetShape(output.eval, &output_shape)) {
+      return false;
+    }
+    const int32_t* bias = nullptr;
+    if (node->inputs->size > 2 && node->inputs->data[2] >= 0) {
+      const TfLiteEvalTensor* bias_tensor =
+          micro_context->GetEvalTensor(node->inputs->data[2]);
+      if (bias_tensor->type != kTfLiteInt32) {
+        return false;
+      }
+      bias = static_cast<const int32_t*>(bias_tensor->data.data);
+    }
+
+    ConvParams params = {};
+    TfLitePadding padding;
+    TfLiteFusedActivation activation;
+    if (is_depthwise) {
+      const auto* data =
+          static_cast<const TfLiteDepthwiseConvParams*>(node->builtin_data);
+      padding = data->padding;
+      activation = data->activation;
+      params.stride_height = data->stride_height;
+      params.stride_width = data->stride_width;
+      params.dilation_height = data->dilation_height_factor;
+      params.dilation_width = data->dilation_width_factor;
+      params.depth_multiplier =
+          output_shape.channels / (input_shape.channels > 0
+                                       ? input_shape.channels
+                                       : 1);
+    } else {
+      const auto* data =
+          static_cast<const TfLiteConvParams*>(node->builtin_data);
+      padding = data->padding;
+      activation = data->activation;
+      params.stride_height = data->stride_height;
+      params.stride_width = data->stride_width;
+      params.dilation_height = data->dilation_height_factor;
+      params.dilation_width = data->dilation_width_factor;
+      params.depth_multiplier = 1;
+    }
+    int out_height;
+    int out_width;
+    const TfLitePaddingValues padding_values = ComputePaddingHeightWidth(
+        params.stride_height, params.stride_width, params.dilation_height,
+        params.dilation_width, input_shape.height, input_shape.width,
+        filter_shape.height, filter_shape.width, padding, &out_height,
+        &out_width);
+    params.padding_height = padding_values.height;
+    params.padding_width = padding_values.width;
+    params.input_zero_point = input.zero_point;
+
+    Requantization requant;
+    if (!SetupRequantization(input, filter, output, output_shape.channels,
+                             activation, &requant)) {
+      return false;
+    }
+    const Status status =
+        is_depthwise
+            ? emulator_->DepthwiseConvolution(
+                  params, input_shape, Data(input), filter_shape,
+                  Data(filter), bias, requant, output_shape, output_data)
+            : emulator_->Convolution(params, input_shape, Data(input),
+                                     filter_shape, Data(filter), bias,
+                                     requant, output_shape, output_data);
+    return status == Status::kOk;
+  }
+
+  bool RunFullyConnected(const Job& job, MicroContext* micro_context,
+                         const Operand& input, const Operand& output,
+                         int8_t* output_data) {
+    const TfLiteNode* node = job.node;
+    Operand filter;
+    if (node->inputs->size < 2 || node->builtin_data == nullptr ||
+        !GetOperand(micro_context, node->inputs->data[1], &filter) ||
+        !IsDenseInt8(filter) || filter.eval->dims->size != 2) {
+      return false;
+    }
+    const int32_t output_depth = filter.eval->dims->data[0];
+    const int32_t input_depth = filter.eval->dims->data[1];
+    if (input_depth <= 0 || ElementCount(input.eval) % input_depth != 0) {
+      return false;
+    }
+    const int32_t* bias = nullptr;
+    if (node->inputs->size > 2 && node->inputs->data[2] >= 0) {
+      const TfLiteEvalTensor* bias_tensor =
+          micro_context->GetEvalTensor(node->inputs->data[2]);
+      if (bias_tensor->type != kTfLiteInt32) {
+        return false;
+      }
+      bias = static_cast<const int32_t*>(bias_tensor->data.data);
+    }
+    const auto* data =
+        static_cast<const TfLiteFullyConnectedParams*>(node->builtin_data);
+    Requantization requant;
+    if (!SetupRequantization(input, filter, output, output_depth,
+                             data->activation, &requant)) {
+      return false;
+    }
+    return emulator_->FullyConnected(
+               ElementCount(input.eval) / input_depth, input_depth,
+               output_depth, input.zero_point, Data(input), Data(filter),
+               bias, requant, output_data) == Status::kOk;
+  }
+
+  bool RunPool(const Job& job, const Operand& input, const Operand& output,
+               int8_t* output_data) {
+    const TfLiteNode* node = job.node;
+    Shape input_shape;
+    Shape output_shape;
+    if (node->builtin_data == nullptr || !GetShape(input.eval, &input_shape) ||
+        !GetShape(output.eval, &output_shape)) {
+      return false;
+    }
+    const auto* data = static_cast<const TfLitePoolParams*>(node->builtin_data);
+    PoolParams params;
+    params.filter_height = data->filter_height;
+    params.filter_width = data->filter_width;
+    params.stride_height = data->stride_height;
+    params.stride_width = data->stride_width;
+    int out_height;
+    int out_width;
+    const TfLitePaddingValues padding_values = ComputePaddingHeightWidth(
+        data->stride_height, data->stride_width, 1, 1, input_shape.height,
+        input_shape.width, data->filter_height, data->filter_width,
+        data->padding, &out_height, &out_width);
+    params.padding_height = padding_values.height;
+    params.padding_width = padding_values.width;
+    ActivationRange(data->activation, output, &params.activation_min,
+                    &params.activation_max);
+    const Status status =
+        job.registration->builtin_code == BuiltinOperator_MAX_POOL_2D
+            ? emulator_->Maxpool(params, input_shape, Data(input),
+                                 output_shape, output_data)
+            : emulator_->Avgpool(params, input_shape, Data(input),
+                                 output_shape, output_data);
+    return status == Status::kOk;
+  }
+
+  bool RunBinary(const Job& job, MicroContext* micro_context,
+                 const Operand& input1, const Operand& output,
+                 int8_t* output_data) {
+    const TfLiteNode* node = job.node;
+    Operand input2;
+    if (node->inputs->size != 2 || node->builtin_data == nullptr ||
+        !GetOperand(micro_context, node->inputs->data[1], &input2) ||
+        !IsInt8(input2)) {
+      return false;
+    }
+    const int32_t size = ElementCount(output.eval);
+    if (ElementCount(input1.eval) != size ||
+        ElementCount(input2.eval) != size) {
+      // Broadcasting runs on the CPU.
+      return false;
+    }
+    BinaryParams params;
+    TfLiteFusedActivation activation;
+    switch (job.registration->builtin_code) {
+      case BuiltinOperator_ADD:
+        params.op = BinaryOp::kAdd;
+        activation =
+            static_cast<const TfLiteAddParams*>(node->builtin_data)->activation;
+        break;
+      case BuiltinOperator_SUB:
+        params.op = BinaryOp::kSub;
+        activation =
+            static_cast<const TfLiteSubParams*>(node->builtin_data)->activation;
+        break;
+      default:
+        params.op = BinaryOp::kMul;
+        activation =
+            static_cast<const TfLiteMulParams*>(node->builtin_data)->activation;
+        break;
+    }
+    params.input1_zero_point = input1.zero_point;
+    params.input2_zero_point = input2.zero_point;
+    if (params.op == BinaryOp::kMul) {
+      params.scaler1 = input1.scale * input2.scale / output.scale;
+      params.scaler2 = 0.0f;
+    } else {
+      params.scaler1 = input1.scale / output.scale;
+      params.scaler2 = input2.scale / output.scale;
+    }
+    params.output_zero_point = output.zero_point;
+    ActivationRange(activation, output, &params.activation_min,
+                    &params.activation_max);
+    return emulator_->PointwiseBinary(params, Data(input1), Data(input2),
+                                      output_data, size) == Status::kOk;
+  }
+
+  Emulator* emulator_;  // not owned, can't be null
+  Job pending_;
+  float scalers_[kMaxChannels];
+  int emulated_jobs_;
+  int fallback_jobs_;
+  int overlapped_operators_;
+
+ public:
+  TF_LITE_REMOVE_VIRTUAL_DELETE
+};
+
+}  // namespace nnlite
+}  // namespace micro
+}  // namespace tflite
+
+#endif  // IFX_TFLM_PRIVATE_IFX_MXNNLITE2_NNLITE_ASYNC_ACCELERATOR_H_
@@ -0,0 +1,616 @@
+/* Copyright 2025 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef IFX_TFLM_PRIVATE_IFX_MXNNLITE2_NNLITE_EMULATOR_H_
+#define IFX_TFLM_PRIVATE_IFX_MXNNLITE2_NNLITE_EMULATOR_H_
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "ifx_mxnnlite2/accelerator_limits.h"
+
+namespace tflite {
+namespace micro {
+namespace nnlite {
+
+/*
+ * Software model of the NNLite v2 operations used through the Cy_NNLite_*
+ * driver API: convolution, depthwise convolution, fully connected, max and
+ * average pooling, pointwise unary and binary operations, byte copy and redo
+ * byte copy.
+ *
+ * The emulator is plain C++ without dependencies on the PDL, so the NNLite
+ * partitioning and chunking decisions can be reproduced and benchmarked in
+ * host builds and CI. Every job
+ *  - validates the register field limits of accelerator_limits.h and fails
+ *    with kLimitExceeded where the IP would show undefined behaviour, which
+ *    reproduces the on-target fallbacks to CPU kernels,
+ *  - computes its result with the arithmetic model below, and
+ *  - is charged an estimated number of NPU cycles.
+ *
+ * Arithmetic model (all tensors NHWC, int8 activations and weights):
+ *  - sums of products are accumulated in int32 from (input - input_zero_point)
+ *    and the weights (symmetric, filter layouts OHWI, 1HWO and OI), plus the
+ *    int32 bias,
+ *  - requantization multiplies the accumulator by the per-channel float32
+ *    scaler (see MxNNLiteExtOpData), rounds to nearest as configured, adds the
+ *    output zero point and clamps to the activation range,
+ *  - binary operations scale each zero point corrected operand by its float32
+ *    scaler, combine them (add, sub, mul) and requantize the same way.
+ * The model is deterministic and independent of the host's floating point
+ * environment, so results are reproducible across runs and machines.
+ */
+
+enum class Status {
+  kOk = 0,
+  kBadParam,
+  kLimitExceeded,
+};
+
+enum class Rounding {
+  kHalfToEven,
+  kHalfAwayFromZero,
+};
+
+// Cost model. The defaults are rough figures for the NNLite v2 on PSOC Edge
+// and meant for comparing partitioning options, not for absolute timing.
+struct EmulatorConfig {
+  // Register setup and start of a job issued with a full configuration.
+  uint32_t setup_cycles = 120;
+  // Start of a job that re-uses the previous configuration (redo).
+  uint32_t redo_setup_cycles = 12;
+  // Multiply-accumulates per cycle of the datapath.
+  uint32_t macs_per_cycle = 16;
+  // Bytes per cycle of the streamers for element-wise operations and copies.
+  uint32_t bytes_per_cycle = 4;
+  Rounding rounding = Rounding::kHalfToEven;
+};
+
+struct Shape {
+  int32_t batches;
+  int32_t height;
+  int32_t width;
+  int32_t channels;
+
+  int32_t ElementCount() const { return batches * height * width * channels; }
+};
+
+// Requantization of an int32 accumulator to int8.
+struct Requantization {
+  // One scaler per output channel, or a single one if per_channel is false.
+  const float* scalers;
+  bool per_channel;
+  int32_t output_zero_point;
+  int32_t activation_min;
+  int32_t activation_max;
+};
+
+struct ConvParams {
+  int32_t stride_height;
+  int32_t stride_width;
+  int32_t dilation_height;
+  int32_t dilation_width;
+  int32_t padding_height;  // Top padding, the bottom is implied.
+  int32_t padding_width;   // Left padding, the right is implied.
+  int32_t input_zero_point;
+  // Depthwise only.
+  int32_t depth_multiplier;
+};
+
+struct PoolParams {
+  int32_t filter_height;
+  int32_t filter_width;
+  int32_t stride_height;
+  int32_t stride_width;
+  int32_t padding_height;
+  int32_t padding_width;
+  int32_t activation_min;
+  int32_t activation_max;
+};
+
+enum class UnaryOp {
+  kRequantize,  // QUANTIZE and fused activation clipping.
+  kAbs,
+  kNeg,
+};
+
+struct UnaryParams {
+  UnaryOp op;
+  int32_t input_zero_point;
+  float scaler;  // input scale / output scale
+  int32_t output_zero_point;
+  int32_t activation_min;
+  int32_t activation_max;
+};
+
+enum class BinaryOp {
+  kAdd,
+  kSub,
+  kMul,
+};
+
+struct BinaryParams {
+  BinaryOp op;
+  int32_t input1_zero_point;
+  int32_t input2_zero_point;
+  // kAdd/kSub: input scale / output scale per operand. kMul: scaler1 holds
+  // input1 scale * input2 scale / output scale, scaler2 is unused.
+  float scaler1;
+  float scaler2;
+  int32_t output_zero_point;
+  int32_t activation_min;
+  int32_t activation_max;
+};
+
+class Emulator {
+ public:
+  explicit Emulator(const EmulatorConfig& config = EmulatorConfig())
+      : config_(config), copy_configured_(false) {
+    ResetStatistics();
+  }
+
+  Status Convolution(const ConvParams& params, const Shape& input_shape,
+                     const int8_t* input, const Shape& filter_shape,
+                     const int8_t* filter, const int32_t* bias,
+                     const Requantization& requant, const Shape& output_shape,
+                     int8_t* output) {
+    if (input == nullptr || filter == nullptr || output == nullptr ||
+        !IsValidConv(params, input_shape, output_shape) ||
+        filter_shape.channels != input_shape.channels ||
+        filter_shape.batches != output_shape.channels) {
+      return Fail(Status::kBadParam);
+    }
+    const uint64_t kernel_channel_times = static_cast<uint64_t>(
+        filter_shape.height * filter_shape.width * input_shape.channels);
+    if (!CheckStreamerLimits(input_shape, params.stride_width,
+                             kernel_channel_times, output_shape)) {
+      return Fail(Status::kLimitExceeded);
+    }
+    for (int b = 0; b < output_shape.batches; ++b) {
+      for (int oy = 0; oy < output_shape.height; ++oy) {
+        for (int ox = 0; ox < output_shape.width; ++ox) {
+          for (int oc = 0; oc < output_shape.channels; ++oc) {
+            int32_t acc = bias != nullptr ? bias[oc] : 0;
+            for (int ky = 0; ky < filter_shape.height; ++ky) {
+              const int iy = oy * params.stride_height - params.padding_height +
+                             ky * params.dilation_height;
+              if (iy < 0 || iy >= input_shape.height) continue;
+              for (int kx = 0; kx < filter_shape.width; ++kx) {
+                const int ix = ox * params.stride_width -
+                               params.padding_width +
+                               kx * params.dilation_width;
+                if (ix < 0 || ix >= input_shape.width) continue;
+                const int8_t* in =
+                    &input[Offset(input_shape, b, iy, ix, 0)];
+                const int8_t* w =
+                    &filter[Offset(filter_shape, oc, ky, kx, 0)];
+                for (int ic = 0; ic < input_shape.channels; ++ic) {
+                  acc += (in[ic] - params.input_zero_point) * w[ic];
+                }
+              }
+            }
+            output[Offset(output_shape, b, oy, ox, oc)] =
+                Requantize(acc, requant, oc);
+          }
+        }
+      }
+    }
+    return Charge(config_.setup_cycles,
+                  static_cast<uint64_t>(output_shape.ElementCount()) *
+                      kernel_channel_times,
+                  0);
+  }
+
+  Status DepthwiseConvolution(const ConvParams& params,
+                              const Shape& input_shape, const int8_t* input,
+                              const Shape& filter_shape, const int8_t* filter,
+                              const int32_t* bias,
+                              const Requantization& requant,
+                              const Shape& output_shape, int8_t* output) {
+    if (input == nullptr || filter == nullptr || output == nullptr ||
+        !IsValidConv(params, input_shape, output_shape) ||
+        params.depth_multiplier < 1 ||
+        output_shape.channels !=
+            input_shape.channels * params.depth_multiplier ||
+        filter_shape.channels != output_shape.channels) {
+      return Fail(Status::kBadParam);
+    }
+    const uint64_t kernel_channel_times = static_cast<uint64_t>(
+        filter_shape.height * filter_shape.width * output_shape.channels);
+    if (!CheckStreamerLimits(input_shape, params.stride_width,
+                             kernel_channel_times, output_shape)) {
+      return Fail(Status::kLimitExceeded);
+    }
+    for (int b = 0; b < output_shape.batches; ++b) {
+      for (int oy = 0; oy < output_shape.height; ++oy) {
+        for (int ox = 0; ox < output_shape.width; ++ox) {
+          for (int oc = 0; oc < output_shape.channels; ++oc) {
+            const int ic = oc / params.depth_multiplier;
+            int32_t acc = bias != nullptr ? bias[oc] : 0;
+            for (int ky = 0; ky < filter_shape.height; ++ky) {
+              const int iy = oy * params.stride_height - params.padding_height +
+                             ky * params.dilation_height;
+              if (iy < 0 || iy >= input_shape.height) continue;
+              for (int kx = 0; kx < filter_shape.width; ++kx) {
+                const int ix = ox * params.stride_width -
+                               params.padding_width +
+                               kx * params.dilation_width;
+                if (ix < 0 || ix >= input_shape.width) continue;
+                acc += (input[Offset(input_shape, b, iy, ix, ic)] -
+                        params.input_zero_point) *
+                       filter[Offset(filter_shape, 0, ky, kx, oc)];
+              }
+            }
+            output[Offset(output_shape, b, oy, ox, oc)] =
+                Requantize(acc, requant, oc);
+          }
+        }
+      }
+    }
+    return Charge(config_.setup_cycles,
+                  static_cast<uint64_t>(output_shape.ElementCount()) *
+                      filter_shape.height * filter_shape.width,
+                  0);
+  }
+
+  // input is [batches, input_depth], filter [output_depth, input_depth].
+  Status FullyConnected(int32_t batches, int32_t input_depth,
+                        int32_t output_depth, int32_t input_zero_point,
+                        const int8_t* input, const int8_t* filter,
+                        const int32_t* bias, const Requantization& requant,
+                        int8_t* output) {
+    if (input == nullptr || filter == nullptr || output == nullptr ||
+        batches < 1 || input_depth < 1 || output_depth < 1) {
+      return Fail(Status::kBadParam);
+    }
+    if (static_cast<uint32_t>(input_depth) >
+            IFX_ACTIVATIONSTREAMERKERNELCHANNELTIMESWIDTH ||
+        static_cast<uint32_t>(output_depth) > IFX_ACTIVATIONSTREAMERREPEATS) {
+      return Fail(Status::kLimitExceeded);
+    }
+    for (int b = 0; b < batches; ++b) {
+      const int8_t* in = &input[b * input_depth];
+      for (int oc = 0; oc < output_depth; ++oc) {
+        const int8_t* w = &filter[oc * input_depth];
+        int32_t acc = bias != nullptr ? bias[oc] : 0;
+        for (int i = 0; i < input_depth; ++i) {
+          acc += (in[i] - input_zero_point) * w[i];
+        }
+        output[b * output_depth + oc] = Requantize(acc, requant, oc);
+      }
+    }
+    return Charge(config_.setup_cycles,
+                  static_cast<uint64_t>(batches) * input_depth * output_depth,
+                  0);
+  }
+
+  Status Maxpool(const PoolParams& params, const Shape& input_shape,
+                 const int8_t* input, const Shape& output_shape,
+                 int8_t* output) {
+    return Pool(/*is_max=*/true, params, input_shape, input, output_shape,
+                output);
+  }
+
+  Status Avgpool(const PoolParams& params, const Shape& input_shape,
+                 const int8_t* input, const Shape& output_shape,
+                 int8_t* output) {
+    return Pool(/*is_max=*/false, params, input_shape, input, output_shape,
+                output);
+  }
+
+  Status PointwiseUnary(const UnaryParams& params, const int8_t* input,
+                        int8_t* output, int32_t size) {
+    if (input == nullptr || output == nullptr || size < 0) {
+      return Fail(Status::kBadParam);
+    }
+    for (int32_t i = 0; i < size; ++i) {
+      int32_t value = input[i] - params.input_zero_point;
+      if (params.op == UnaryOp::kAbs) {
+        value = value < 0 ? -value : value;
+      } else if (params.op == UnaryOp::kNeg) {
+        value = -value;
+      }
+      output[i] = Clamp(Round(static_cast<float>(value) * params.scaler) +
+                            params.output_zero_point,
+                        params.activation_min, params.activation_max);
+    }
+    return Charge(config_.setup_cycles, 0, 2 * static_cast<uint64_t>(size));
+  }
+
+  Status PointwiseBinary(const BinaryParams& params, const int8_t* input1,
+                         const int8_t* input2, int8_t* output, int32_t size) {
+    if (input1 == nullptr || input2 == nullptr || output == nullptr ||
+        size < 0) {
+      return Fail(Status::kBadParam);
+    }
+    for (int32_t i = 0; i < size; ++i) {
+      const float a = static_cast<float>(input1[i] - params.input1_zero_point);
+      const float b = static_cast<float>(input2[i] - params.input2_zero_point);
+      float result;
+      switch (params.op) {
+        case BinaryOp::kAdd:
+          result = a * params.scaler1 + b * params.scaler2;
+          break;
+        case BinaryOp::kSub:
+          result = a * params.scaler1 - b * params.scaler2;
+          break;
+        case BinaryOp::kMul:
+        default:
+          result = a * b * params.scaler1;
+          break;
+      }
+      output[i] = Clamp(Round(result) + params.output_zero_point,
+                        params.activation_min, params.activation_max);
+    }
+    return Charge(config_.setup_cycles, 0, 3 * static_cast<uint64_t>(size));
+  }
+
+  // Counterpart of Cy_NNLite_Byte_Copy(): configures the streamers and copies.
+  Status ByteCopy(const int8_t* src, int8_t* dst, size_t bytes) {
+    if (src == nullptr || dst == nullptr) {
+      return Fail(Status::kBadParam);
+    }
+    if (bytes > IFX_ACTIVATIONSTREAMERREPEATS) {
+      return Fail(Status::kLimitExceeded);
+    }
+    memmove(dst, src, bytes);
+    copy_configured_ = true;
+    return Charge(config_.setup_cycles, 0, 2 * static_cast<uint64_t>(bytes));
+  }
+
+  // Counterpart of Cy_NNLite_Redo_Byte_Copy(): re-triggers the previous
+  // configuration with new addresses. Fails if no copy was configured before.
+  Status RedoByteCopy(const int8_t* src, int8_t* dst, size_t bytes) {
+    if (!copy_configured_) {
+      return Fail(Status::kBadParam);
+    }
+    if (src == nullptr || dst == nullptr) {
+      return Fail(Status::kBadParam);
+    }
+    if (bytes > IFX_ACTIVATIONSTREAMERREPEATS) {
+      return Fail(Status::kLimitExceeded);
+    }
+    memmove(dst, src, bytes);
+    return Charge(config_.redo_setup_cycles, 0,
+                  2 * static_cast<uint64_t>(bytes));
+  }
+
+  void ResetStatistics() {
+    cycles_ = 0;
+    macs_ = 0;
+    jobs_ = 0;
+    failed_jobs_ = 0;
+    limit_failures_ = 0;
+  }
+
+  // Estimated NPU cycles of all successful jobs.
+  uint64_t cycles() const { return cycles_; }
+  uint64_t macs() const { return macs_; }
+  int jobs() const { return jobs_; }
+  int failed_jobs() const { return failed_jobs_; }
+  // Jobs rejected because a register field limit would be exceeded; these
+  // are the jobs that fall back to CPU kernels on target.
+  int limit_failures() const { return limit_failures_; }
+
+  const EmulatorConfig& config() const { return config_; }
+
+ private:
+  static size_t Offset(const Shape& shape, int b, int y, int x, int c) {
+    return ((static_cast<size_t>(b) * shape.height + y) * shape.width + x) *
+               shape.channels +
+           c;
+  }
+
+  static bool IsValidShape(const Shape& shape) {
+    return shape.batches > 0 && shape.height > 0 && shape.width > 0 &&
+           shape.channels > 0;
+  }
+
+  static bool IsValidConv(const ConvParams& params, const Shape& input_shape,
+                          const Shape& output_shape) {
+    return IsValidShape(input_shape) && IsValidShape(output_shape) &&
+           input_shape.batches == output_shape.batches &&
+           params.stride_height > 0 && params.stride_width > 0 &&
+           params.dilation_height > 0 && params.dilation_width > 0;
+  }
+
+  // Register field limits shared by the sliding window operations.
+  static bool CheckStreamerLimits(const Shape& input_shape,
+                                  int32_t stride_width,
+                                  uint64_t kernel_channel_times,
+                                  const Shape& output_shape) {
+    const uint64_t channel_times =
+        static_cast<uint64_t>(input_shape.width) * input_shape.channels;
+    const uint64_t stride_channel_times_column =
+        static_cast<uint64_t>(stride_width) * input_shape.channels;
+    const uint64_t repeats =
+        static_cast<uint64_t>(output_shape.height) * output_shape.width;
+    return channel_times <= IFX_ACTIVATIONSTREAMERCHANNELTIMESWIDTH &&
+           kernel_channel_times <=
+               IFX_ACTIVATIONSTREAMERKERNELCHANNELTIMESWIDTH &&
+           repeats <= IFX_ACTIVATIONSTREAMERREPEATS &&
+           stride_channel_times_column <= IFX_STRIDE_STRIDECHANNELTIMESCOLUMN;
+  }
+
+  Status Pool(bool is_max, const PoolParams& params, const Shape& input_shape,
+              const int8_t* input, const Shape& output_shape, int8_t* output) {
+    if (input == nullptr || output == nullptr || !IsValidShape(input_shape) ||
+        !IsValidShape(output_shape) ||
+        input_shape.batches != output_shape.batches ||
+        input_shape.channels != output_shape.channels ||
+        params.filter_height < 1 || params.filter_width < 1 ||
+        params.stride_height < 1 || params.stride_width < 1) {
+      return Fail(Status::kBadParam);
+    }
+    const uint64_t kernel_channel_times = static_cast<uint64_t>(
+        params.filter_height * params.filter_width * input_shape.channels);
+    if (!CheckStreamerLimits(input_shape, params.stride_width,
+                             kernel_channel_times, output_shape)) {
+      return Fail(Status::kLimitExceeded);
+    }
+    for (int b = 0; b < output_shape.batches; ++b) {
+      for (int oy = 0; oy < output_shape.height; ++oy) {
+        for (int ox = 0; ox < output_shape.width; ++ox) {
+          for (int c = 0; c < output_shape.channels; ++c) {
+            int32_t max = INT32_MIN;
+            int32_t sum = 0;
+            int32_t count = 0;
+            for (int ky = 0; ky < params.filter_height; ++ky) {
+              const int iy =
+                  oy * params.stride_height - params.padding_height + ky;
+              if (iy < 0 || iy >= input_shape.height) continue;
+              for (int kx = 0; kx < params.filter_width; ++kx) {
+                const int ix =
+                    ox * params.stride_width - params.padding_width + kx;
+                if (ix < 0 || ix >= input_shape.width) continue;
+                const int32_t value = input[Offset(input_shape, b, iy, ix, c)];
+                max = value > max ? value : max;
+                sum += value;
+                ++count;
+              }
+            }
+            int32_t result;
+            if (count == 0) {
+              result = 0;
+            } else if (is_max) {
+              result = max;
+            } else {
+              // Average pooling rounds half away from zero like TFLite.
+              result = sum > 0 ? (sum + count / 2) / count
+                               : (sum - count / 2) / count;
+            }
+            output[Offset(output_shape, b, oy, ox, c)] =
+                Clamp(result, params.activation_min, params.activation_max);
+          }
+        }
+      }
+    }
+    return Charge(config_.setup_cycles,
+                  static_cast<uint64_t>(output_shape.ElementCount()) *
+                      params.filter_height * params.filter_width,
+                  0);
+  }
+
+  // Saturates to the int32 range; NaN rounds to zero.
+  int32_t Round(float value) const {
+    if (value != value) {
+      return 0;
+    }
+    if (value >= 2147483648.0f) {
+      return INT32_MAX;
+    }
+    if (value <= -2147483648.0f) {
+      return INT32_MIN;
+    }
+    if (config_.rounding == Rounding::kHalfAwayFromZero) {
+      return static_cast<int32_t>(value < 0.0f ? std::ceil(value - 0.5f)
+                                               : std::floor(value + 0.5f));
+    }
+    const float floor_value = std::floor(value);
+    const float fraction = value - floor_value;
+    int32_t result = static_cast<int32_t>(floor_value);
+    if (fraction > 0.5f || (fraction == 0.5f && (result & 1) != 0)) {
+      ++result;
+    }
+    return result;
+  }
+
+  static int8_t Clamp(int32_t value, int32_t min, int32_t max) {
+    value = value < min ? min : value;
+    value = value > max ? max : value;
+    value = value < -128 ? -128 : value;
+    value = value > 127 ? 127 : value;
+    return static_cast<int8_t>(value);
+  }
+
+  int8_t Requantize(int32_t acc, const Requantization& requant,
+                    int channel) const {
+    const float scaler = requant.scalers[requant.per_channel ? channel : 0];
+    return Clamp(Round(static_cast<float>(acc) * scaler) +
+                     requant.output_zero_point,
+                 requant.activation_min, requant.activation_max);
+  }
+
+  // Compute and streaming overlap, so a job costs its setup plus whichever
+  // of the two takes longer.
+  Status Charge(uint32_t setup_cycles, uint64_t macs, uint64_t bytes) {
+    const uint64_t compute_cycles =
+        (macs + config_.macs_per_cycle - 1) / config_.macs_per_cycle;
+    const uint64_t stream_cycles =
+        (bytes + config_.bytes_per_cycle - 1) / config_.bytes_per_cycle;
+    cycles_ += setup_cycles +
+               (compute_cycles > stream_cycles ? compute_cycles : stream_cycles);
+    macs_ += macs;
+    ++jobs_;
+    return Status::kOk;
+  }
+
+  Status Fail(Status status) {
+    ++failed_jobs_;
+    if (status == Status::kLimitExceeded) {
+      ++limit_failures_;
+    }
+    return status;
+  }
+
+  EmulatorConfig config_;
+  bool copy_configured_;
+  uint64_t cycles_;
+  uint64_t macs_;
+  int jobs_;
+  int failed_jobs_;
+  int limit_failures_;
+};
+
+// Emulator behind the Cy_NNLite_* entry points below. Set it before running
+// kernels that call the driver; a default configured emulator is used
+// otherwise.
+inline Emulator*& DriverEmulatorSlot() {
+  static Emulator* emulator = nullptr;
+  return emulator;
+}
+
+inline Emulator* DriverEmulator() {
+  static Emulator default_emulator;
+  Emulator* emulator = DriverEmulatorSlot();
+  return emulator != nullptr ? emulator : &default_emulator;
+}
+
+inline void SetDriverEmulator(Emulator* emulator) {
+  DriverEmulatorSlot() = emulator;
+}
+
+}  // namespace nnlite
+}  // namespace micro
+}  // namespace tflite
+
+// Host builds define IFX_NNLITE_EMULATOR_DRIVER to link the NNLite kernels
+// against the emulator instead of the PDL driver. The entry points take the
+// arguments accel_memcpy.h passes and are defined in nnlite_emulator_driver.cc,
+// which halts if the emulator rejects a copy. The other Cy_NNLite_* entry
+// points take the parameter structs of the PDL's cy_nn_kernel.h and are not
+// provided here.
+#ifdef IFX_NNLITE_EMULATOR_DRIVER
+extern "C" {
+
+void Cy_NNLite_Byte_Copy(const int8_t* src, int8_t* dst, size_t bytes);
+void Cy_NNLite_Redo_Byte_Copy(const int8_t* src, int8_t* dst, size_t bytes);
+
+}  // extern "C"
+#endif  // IFX_NNLITE_EMULATOR_DRIVER
+
+#endif  // IFX_TFLM_PRIVATE_IFX_MXNNLITE2_NNLITE_EMULATOR_H_
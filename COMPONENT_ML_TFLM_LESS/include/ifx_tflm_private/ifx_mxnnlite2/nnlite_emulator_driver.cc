@@ -0,0 +1,66 @@
+/* Copyright 2025 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Definitions of the Cy_NNLite_* entry points declared in nnlite_emulator.h.
+// Only host builds defining IFX_NNLITE_EMULATOR_DRIVER compile anything here,
+// target builds link the PDL driver.
+
+#ifdef IFX_NNLITE_EMULATOR_DRIVER
+
+#include <cstddef>
+#include <cstdint>
+
+#include "ifx_mxnnlite2/nnlite_emulator.h"
+#include "tensorflow/lite/kernels/op_macros.h"
+#include "tensorflow/lite/micro/micro_log.h"
+
+namespace {
+
+using tflite::micro::nnlite::Status;
+
+// The driver entry points return nothing, so a copy the emulator rejects
+// would silently leave `dst` unchanged. Halt instead.
+void CheckCopy(const char* entry_point, Status status, size_t bytes) {
+  if (status == Status::kOk) {
+    return;
+  }
+  MicroPrintf("%s of %d bytes failed: %s", entry_point,
+              static_cast<int>(bytes),
+              status == Status::kLimitExceeded
+                  ? "more than IFX_ACTIVATIONSTREAMERREPEATS bytes"
+                  : "bad parameters");
+  TFLITE_ABORT;
+}
+
+}  // namespace
+
+extern "C" {
+
+void Cy_NNLite_Byte_Copy(const int8_t* src, int8_t* dst, size_t bytes) {
+  CheckCopy("Cy_NNLite_Byte_Copy",
+            tflite::micro::nnlite::DriverEmulator()->ByteCopy(src, dst, bytes),
+            bytes);
+}
+
+void Cy_NNLite_Redo_Byte_Copy(const int8_t* src, int8_t* dst, size_t bytes) {
+  CheckCopy(
+      "Cy_NNLite_Redo_Byte_Copy",
+      tflite::micro::nnlite::DriverEmulator()->RedoByteCopy(src, dst, bytes),
+      bytes);
+}
+
+}  // extern "C"
+
+#endif  // IFX_NNLITE_EMULATOR_DRIVER
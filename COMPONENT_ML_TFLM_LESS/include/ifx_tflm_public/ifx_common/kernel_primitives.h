@@ -25,6 +25,7 @@ Preinterpretation support:
 #ifndef IFX_TFLM_PUBLIC_IFX_COMMON_KERNEL_PRIMITIVES_H_
 #define IFX_TFLM_PUBLIC_IFX_COMMON_KERNEL_PRIMITIVES_H_
 
+#include <cstring>
 #include <type_traits>
 #include "tensorflow/lite/kernels/padding.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
@@ -147,6 +148,67 @@ struct WeightUnpacker
 };
 
 
+/**
+ * \brief       Decoding all items of a packed container word at once
+ *
+ * \details     Sign extends the items_per_container items of a container word
+ *              (lsb first) to int8.  The loop has a compile-time trip count and
+ *              independent iterations so it is fully unrolled without the
+ *              per-item refill branch of WeightUnpacker::unpack().
+ *
+ * \tparam       CONTAINER_T           Type of container (C++ integer type).
+ * \tparam       bits_per_item         Bits per packed weight
+ */
+
+template<typename CONTAINER_T, unsigned int bits_per_item>
+struct PackedContainerDecoder {
+  static constexpr unsigned int items_per_container =
+    (sizeof(CONTAINER_T) * 8) / bits_per_item;
+
+  static inline void decode(uint32_t container, int8_t *unpacked) {
+    for (unsigned int k = 0; k < items_per_container; ++k) {
+      unpacked[k] = static_cast<int8_t>(
+        static_cast<int32_t>(container << (32u - bits_per_item * (k + 1u))) >>
+        (32 - bits_per_item));
+    }
+  }
+};
+
+/**
+ * \brief       SWAR decoding of 8 x 4-bit items per 32-bit container word
+ *
+ * \details     Even and odd nibbles are split into bytes and sign extended in
+ *              all four byte lanes at once: biasing each lane to 0x80+v^8 lets
+ *              the subtraction of 8 run without borrows between lanes.
+ */
+
+template<typename CONTAINER_T>
+struct PackedContainerDecoder32x4 {
+  static constexpr unsigned int items_per_container = 8u;
+
+  static inline void decode(uint32_t container, int8_t *unpacked) {
+    const uint32_t lanes = 0x0F0F0F0Fu;
+    const uint32_t lo = signExtendLanes(container & lanes);
+    const uint32_t hi = signExtendLanes((container >> 4) & lanes);
+    for (unsigned int k = 0; k < 4u; ++k) {
+      unpacked[2u * k] = static_cast<int8_t>(lo >> (8u * k));
+      unpacked[2u * k + 1u] = static_cast<int8_t>(hi >> (8u * k));
+    }
+  }
+
+ private:
+  static inline uint32_t signExtendLanes(uint32_t nibbles) {
+    return (((nibbles ^ 0x08080808u) | 0x80808080u) - 0x08080808u) ^ 0x80808080u;
+  }
+};
+
+template<>
+struct PackedContainerDecoder<uint32_t, 4u> : PackedContainerDecoder32x4<uint32_t> {};
+
+template<>
+struct PackedContainerDecoder<int32_t, 4u> : PackedContainerDecoder32x4<int32_t> {};
+
+
 enum SparsitySupport {
   NEVER_SPARSE,
   ALWAYS_SPARSE,
@@ -295,6 +357,14 @@ class PackedWeightUnpacker
 
     void skipToNextContainer();
 
+  private:
+
+    template<typename CONTAINER_T, unsigned int BITS_PER_ITEM>
+    void unpackDenseWeights(int8_t *unpacked_weights, unsigned int num_weights_unpack);
+
+    template<typename CONTAINER_T, unsigned int BITS_PER_ITEM>
+    void unpackSparseWeights(int8_t *unpacked_weights, unsigned int num_weights_unpack);
+
 };
 
 
@@ -306,17 +376,90 @@ inline void PackedWeightUnpacker::unpackWeights(VALUE_T *unpacked_weights, unsig
 
   static_assert(sizeof(VALUE_T) <= sizeof(uint32_t), "Small enough VALUE_T"); // We use uint32 to cache value container...
   static_assert(std::is_same<VALUE_T,int8_t>::value, "VALUE_T int8-t"); // Output ptr is used direct...
-  for( unsigned int i = 0; i < num_weights_unpack; ++i) {
-
-    // Do we have a skipped zero?
-    // This expression optimizes to compile-time constant for NEVER_SPARSE
-    // and inlines otherwise...
-    if( skippedZero() ) {
-      unpacked_weights[i]  = static_cast<VALUE_T>(zerocode);
-      continue;
-    }
+  if (next_byte_sparsity_map == nullptr) {
+    unpackDenseWeights<CONTAINER_T,BITS_PER_ITEM>(unpacked_weights, num_weights_unpack);
+  } else {
+    unpackSparseWeights<CONTAINER_T,BITS_PER_ITEM>(unpacked_weights, num_weights_unpack);
+  }
+}
+
+
+/**
+ * \brief       Bulk unpacking of dense packed weights
+ *
+ * \details     Items left in the current container word are unpacked one by
+ *              one, then whole container words are decoded at once and the
+ *              remainder is again unpacked item by item, which leaves the
+ *              unpacking state exactly as item-wise unpacking would.
+ */
+
+template<typename CONTAINER_T, unsigned int BITS_PER_ITEM>
+inline void PackedWeightUnpacker::unpackDenseWeights(int8_t *unpacked_weights, unsigned int num_weights_unpack) {
+
+  typedef PackedContainerDecoder<CONTAINER_T,BITS_PER_ITEM> Decoder;
+  constexpr unsigned int items_per_container = Decoder::items_per_container;
+
+  if (items_per_container <= 1u) {  // Static const - optimized away at compile-time
+    // Not packed: weights are stored as-is
+    std::memcpy(unpacked_weights, next_container_word, num_weights_unpack);
+    next_container_word += num_weights_unpack;
+    return;
+  }
+
+  unsigned int i = 0;
+  for (; i < num_weights_unpack && bits_in_container >= BITS_PER_ITEM; ++i) {
+    unpacked_weights[i] = static_cast<int8_t>(unpack<CONTAINER_T,BITS_PER_ITEM>());
+  }
+  for (; i + items_per_container <= num_weights_unpack; i += items_per_container) {
+    const uint32_t container =
+      static_cast<uint32_t>(*reinterpret_cast<const CONTAINER_T *>(next_container_word));
+    next_container_word += sizeof(CONTAINER_T);
+    Decoder::decode(container, &unpacked_weights[i]);
+  }
+  for (; i < num_weights_unpack; ++i) {
+    unpacked_weights[i] = static_cast<int8_t>(unpack<CONTAINER_T,BITS_PER_ITEM>());
+  }
+}
+
+
+/**
+ * \brief       Unpacking of sparse packed weights a sparsity map byte at a time
+ *
+ * \details     Once positioned at a sparsity map byte boundary, each byte is
+ *              consumed as a whole: all-zero bytes produce 8 zeros without
+ *              touching the packed data, all-set bytes 8 bulk unpacked weights.
+ *              Only mixed bytes and partial bytes at the start or end of the
+ *              slice are handled bit by bit.
+ */
+
+template<typename CONTAINER_T, unsigned int BITS_PER_ITEM>
+inline void PackedWeightUnpacker::unpackSparseWeights(int8_t *unpacked_weights, unsigned int num_weights_unpack) {
 
-    unpacked_weights[i]  = unpack<CONTAINER_T,BITS_PER_ITEM>();
+  unsigned int i = 0;
+  for (; i < num_weights_unpack && sparsity_curbit_mask != 0; ++i) {
+    unpacked_weights[i] = skippedZero()
+      ? static_cast<int8_t>(zerocode)
+      : static_cast<int8_t>(unpack<CONTAINER_T,BITS_PER_ITEM>());
+  }
+  for (; i + 8u <= num_weights_unpack; i += 8u) {
+    const uint8_t present = *next_byte_sparsity_map;
+    ++next_byte_sparsity_map;
+    if (present == 0u) {
+      std::memset(&unpacked_weights[i], zerocode, 8u);
+    } else if (present == 0xFFu) {
+      unpackDenseWeights<CONTAINER_T,BITS_PER_ITEM>(&unpacked_weights[i], 8u);
+    } else {
+      for (unsigned int b = 0; b < 8u; ++b) {
+        unpacked_weights[i + b] = (present & (1u << b)) == 0
+          ? static_cast<int8_t>(zerocode)
+          : static_cast<int8_t>(unpack<CONTAINER_T,BITS_PER_ITEM>());
+      }
+    }
+  }
+  for (; i < num_weights_unpack; ++i) {
+    unpacked_weights[i] = skippedZero()
+      ? static_cast<int8_t>(zerocode)
+      : static_cast<int8_t>(unpack<CONTAINER_T,BITS_PER_ITEM>());
   }
 }
 
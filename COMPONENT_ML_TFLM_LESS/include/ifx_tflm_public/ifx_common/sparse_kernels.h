@@ -0,0 +1,373 @@
+/* Copyright 2025 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+/*
+Zero-skipping kernels for RMF sparse packed weights.
+
+Instead of unpacking sparse weights to a dense scratch buffer and multiplying
+by the zeros, these kernels walk the sparsity bitmap of each filter and only
+issue MACs for the nonzero weights.  No unpacked weights buffer is needed; the
+only extra state is the index of the first packed weight of each filter,
+computed once at Prepare time by InitSparsePackedWeights().
+==============================================================================*/
+
+#ifndef IFX_TFLM_PUBLIC_IFX_COMMON_SPARSE_KERNELS_H_
+#define IFX_TFLM_PUBLIC_IFX_COMMON_SPARSE_KERNELS_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/compatibility.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+#include "kernel_primitives.h"
+#include "packing_types.h"
+#include "packing_utils.h"
+
+namespace tflite {
+namespace ops {
+namespace micro {
+
+/**
+ * \brief       Sparse packed weight tensor prepared for zero-skipping kernels
+ *
+ * \details     Layout as read by the PackedWeightUnpacker constructor:
+ *              [run lengths], B, [padding to align container words], W
+ *              where B is one sparsity bitmap over all weights (lsb first,
+ *              one bit per weight, filter i starting at bit i * filter_size)
+ *              and W the nonzero weights of all filters packed back to back,
+ *              so a filter's weights can start in the middle of a container.
+ */
+struct SparsePackedWeights {
+  const uint8_t *sparsity_map;
+  const int8_t *packed_weights;
+  // Index of the first packed weight of each filter, i.e. the number of
+  // nonzero weights of the filters before it.
+  const uint32_t *filter_first_items;
+  unsigned int num_filters;
+  unsigned int filter_size;      // Weights per filter, zeros included.
+};
+
+inline unsigned int PopCount8(uint8_t bits) {
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<unsigned int>(__builtin_popcount(bits));
+#else
+  unsigned int count = 0;
+  for (; bits != 0; bits &= static_cast<uint8_t>(bits - 1u)) {
+    ++count;
+  }
+  return count;
+#endif
+}
+
+inline unsigned int LowestSetBit(unsigned int bits) {
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<unsigned int>(__builtin_ctz(bits));
+#else
+  unsigned int b = 0;
+  while ((bits & 1u) == 0) {
+    bits >>= 1u;
+    ++b;
+  }
+  return b;
+#endif
+}
+
+/**
+ * \brief       `count` (at most 8) sparsity map bits starting at bit `first_bit`
+ *
+ * \details     Filters need not start on a map byte, so the bits may span two
+ *              bytes.  Bits past `count` are masked so the next filter's bits
+ *              never issue a MAC.
+ */
+inline unsigned int SparsityBits(const uint8_t *map, size_t first_bit,
+                                 unsigned int count) {
+  const uint8_t *byte = map + first_bit / 8u;
+  const unsigned int shift = first_bit % 8u;
+  unsigned int bits = static_cast<unsigned int>(byte[0]) >> shift;
+  if (shift + count > 8u) {
+    bits |= static_cast<unsigned int>(byte[1]) << (8u - shift);
+  }
+  return bits & ((1u << count) - 1u);
+}
+
+/**
+ * \brief       Position `weights` at packed weight number `item`
+ *
+ * \details     Items are packed lsb first, so a partially consumed container
+ *              is loaded and shifted as unpack() would have left it.
+ */
+template<typename CONTAINER_T, unsigned int BITS_PER_ITEM>
+inline void SeekPackedWeight(const int8_t *packed_weights, uint32_t item,
+                             WeightUnpacker *weights) {
+  constexpr unsigned int container_bits = sizeof(CONTAINER_T) * 8u;
+  constexpr unsigned int items_per_container = container_bits / BITS_PER_ITEM;
+  const uint32_t skipped = item % items_per_container;
+  weights->next_container_word =
+      packed_weights + (item / items_per_container) * sizeof(CONTAINER_T);
+  weights->weights_cur_container = 0;
+  weights->bits_in_container = 0;
+  if (items_per_container > 1u && skipped != 0) {
+    weights->weights_cur_container = static_cast<uint32_t>(
+        *reinterpret_cast<const CONTAINER_T *>(weights->next_container_word));
+    weights->next_container_word += sizeof(CONTAINER_T);
+    weights->weights_cur_container >>= skipped * BITS_PER_ITEM;
+    weights->bits_in_container = container_bits - skipped * BITS_PER_ITEM;
+  }
+}
+
+/**
+ * \brief       Locate the per-filter data of a sparse packed weight tensor
+ *
+ * \details     Intended to be called once at Prepare time.  The bitmap is
+ *              scanned once to find where each filter's packed weights start;
+ *              the item indices are stored in `filter_first_items`
+ *              (num_filters entries, typically allocated persistently).
+ *
+ * \param[out]  nonzero_weights   Optional: number of nonzero weights, i.e. MACs
+ *                                per output pixel summed over all filters.
+ */
+inline TfLiteStatus InitSparsePackedWeights(
+    const int8_t *packed_weights, size_t num_weights, size_t num_filters,
+    const TfLiteCustomSub8BitPackingDetails &packing_details,
+    uint32_t *filter_first_items, SparsePackedWeights *sparse,
+    uint32_t *nonzero_weights = nullptr) {
+  const unsigned int bits_per_item = packing_details.bits_per_item;
+  const unsigned int container_bits = packing_details.container_bits;
+  if (num_filters == 0 || num_weights % num_filters != 0 ||
+      bits_per_item == 0 || container_bits < bits_per_item ||
+      container_bits % 8u != 0 ||
+      (packing_details.compression_type != NO_RUN_LENGTHS &&
+       packing_details.compression_type != WORD_RUN_LENGTHS)) {
+    return kTfLiteError;
+  }
+  const unsigned int filter_size = num_weights / num_filters;
+  const size_t run_lengths_size =
+      packing_details.compression_type == WORD_RUN_LENGTHS ? num_filters * 2u : 0u;
+  const size_t map_offset = run_lengths_size;
+  const size_t packed_offset =
+      wordAlign(map_offset + sparsityMapSize(num_weights), container_bits);
+
+  const uint8_t *map = reinterpret_cast<const uint8_t *>(packed_weights + map_offset);
+  uint32_t total = 0;
+  for (size_t f = 0; f < num_filters; ++f) {
+    filter_first_items[f] = total;
+    const size_t first_bit = f * filter_size;
+    for (unsigned int i = 0; i < filter_size; i += 8u) {
+      const unsigned int count = std::min(8u, filter_size - i);
+      total += PopCount8(static_cast<uint8_t>(SparsityBits(map, first_bit + i, count)));
+    }
+  }
+
+  sparse->sparsity_map = map;
+  sparse->packed_weights = packed_weights + packed_offset;
+  sparse->filter_first_items = filter_first_items;
+  sparse->num_filters = num_filters;
+  sparse->filter_size = filter_size;
+  if (nonzero_weights != nullptr) {
+    *nonzero_weights = total;
+  }
+  return kTfLiteOk;
+}
+
+/**
+ * \brief       Zero-skipping dot product of one sparse filter with a vector
+ *
+ * \details     Eight zero bitmap bits cost one load and compare; otherwise
+ *              only the set bits are visited.
+ *
+ * \tparam       CONTAINER_T           Type of container (C++ integer type).
+ * \tparam       BITS_PER_ITEM         Bits per packed weight
+ */
+template<typename CONTAINER_T, unsigned int BITS_PER_ITEM>
+inline int32_t SparseDotProduct(const SparsePackedWeights &sparse, unsigned int filter,
+                                const int8_t *input, int32_t input_offset) {
+  const size_t first_bit = static_cast<size_t>(filter) * sparse.filter_size;
+  WeightUnpacker weights;
+  SeekPackedWeight<CONTAINER_T, BITS_PER_ITEM>(
+      sparse.packed_weights, sparse.filter_first_items[filter], &weights);
+
+  int32_t acc = 0;
+  for (unsigned int i = 0; i < sparse.filter_size; i += 8u) {
+    unsigned int bits = SparsityBits(sparse.sparsity_map, first_bit + i,
+                                     std::min(8u, sparse.filter_size - i));
+    const int8_t *in = input + i;
+    while (bits != 0) {
+      const unsigned int b = LowestSetBit(bits);
+      bits &= bits - 1u;
+      acc += (in[b] + input_offset) * weights.unpack<CONTAINER_T, BITS_PER_ITEM>();
+    }
+  }
+  return acc;
+}
+
+/**
+ * \brief       Zero-skipping quantized fully connected layer
+ *
+ * \details     Same arithmetic as reference_integer_ops::FullyConnected() with
+ *              symmetric weights.  OUTPUT_T int16_t gives the int8 x int8 ->
+ *              int16 gate matmul of the integer LSTM.
+ */
+template<typename CONTAINER_T, unsigned int BITS_PER_ITEM, typename OUTPUT_T>
+inline void SparseFullyConnected(const FullyConnectedParams &params,
+                                 const RuntimeShape &input_shape, const int8_t *input_data,
+                                 const SparsePackedWeights &sparse,
+                                 const int32_t *bias_data,
+                                 const RuntimeShape &output_shape, OUTPUT_T *output_data) {
+  const int32_t input_offset = params.input_offset;
+  const int32_t output_offset = params.output_offset;
+  const int32_t output_activation_min = params.quantized_activation_min;
+  const int32_t output_activation_max = params.quantized_activation_max;
+  TFLITE_DCHECK_LE(output_activation_min, output_activation_max);
+  TFLITE_DCHECK_EQ(params.weights_offset, 0);
+
+  const int output_dim_count = output_shape.DimensionsCount();
+  const int batches = FlatSizeSkipDim(output_shape, output_dim_count - 1);
+  const int output_depth = output_shape.Dims(output_dim_count - 1);
+  const int accum_depth = sparse.filter_size;
+  TFLITE_DCHECK_EQ(output_depth, static_cast<int>(sparse.num_filters));
+  TFLITE_DCHECK_EQ(input_shape.FlatSize(), batches * accum_depth);
+  (void)input_shape;
+
+  for (int b = 0; b < batches; ++b) {
+    const int8_t *input = input_data + b * accum_depth;
+    for (int out_c = 0; out_c < output_depth; ++out_c) {
+      int32_t acc = SparseDotProduct<CONTAINER_T, BITS_PER_ITEM>(
+          sparse, out_c, input, input_offset);
+      if (bias_data) {
+        acc += bias_data[out_c];
+      }
+      acc = MultiplyByQuantizedMultiplier(acc, params.output_multiplier,
+                                          params.output_shift);
+      acc += output_offset;
+      acc = std::max(acc, output_activation_min);
+      acc = std::min(acc, output_activation_max);
+      output_data[out_c + output_depth * b] = static_cast<OUTPUT_T>(acc);
+    }
+  }
+}
+
+/**
+ * \brief       Zero-skipping per-channel quantized convolution
+ *
+ * \details     Same arithmetic as reference_integer_ops::ConvPerChannel().
+ *              Filters are OHWI, so walking a filter's bitmap visits (ky, kx,
+ *              ic) in order and the position is advanced incrementally by the
+ *              distance between nonzero weights.
+ */
+template<typename CONTAINER_T, unsigned int BITS_PER_ITEM>
+inline void SparseConvPerChannel(const ConvParams &params, const int32_t *output_multiplier,
+                                 const int32_t *output_shift,
+                                 const RuntimeShape &input_shape, const int8_t *input_data,
+                                 const RuntimeShape &filter_shape,
+                                 const SparsePackedWeights &sparse,
+                                 const int32_t *bias_data,
+                                 const RuntimeShape &output_shape, int8_t *output_data) {
+  const int32_t input_offset = params.input_offset;
+  const int stride_width = params.stride_width;
+  const int stride_height = params.stride_height;
+  const int dilation_width_factor = params.dilation_width_factor;
+  const int dilation_height_factor = params.dilation_height_factor;
+  const int pad_width = params.padding_values.width;
+  const int pad_height = params.padding_values.height;
+  const int32_t output_offset = params.output_offset;
+  const int32_t output_activation_min = params.quantized_activation_min;
+  const int32_t output_activation_max = params.quantized_activation_max;
+  TFLITE_DCHECK_LE(output_activation_min, output_activation_max);
+  TFLITE_DCHECK_EQ(input_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(filter_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 4);
+
+  const int batches = MatchingDim(input_shape, 0, output_shape, 0);
+  const int input_depth = input_shape.Dims(3);
+  const int output_depth = MatchingDim(filter_shape, 0, output_shape, 3);
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int filter_width = filter_shape.Dims(2);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+  TFLITE_DCHECK_EQ(filter_shape.Dims(3), input_depth);
+  TFLITE_DCHECK_EQ(output_depth, static_cast<int>(sparse.num_filters));
+  TFLITE_DCHECK_EQ(filter_shape.FlatSize() / output_depth,
+                   static_cast<int>(sparse.filter_size));
+
+  for (int batch = 0; batch < batches; ++batch) {
+    for (int out_y = 0; out_y < output_height; ++out_y) {
+      const int in_y_origin = (out_y * stride_height) - pad_height;
+      for (int out_x = 0; out_x < output_width; ++out_x) {
+        const int in_x_origin = (out_x * stride_width) - pad_width;
+        for (int out_channel = 0; out_channel < output_depth; ++out_channel) {
+          const size_t first_bit =
+              static_cast<size_t>(out_channel) * sparse.filter_size;
+          WeightUnpacker weights;
+          SeekPackedWeight<CONTAINER_T, BITS_PER_ITEM>(
+              sparse.packed_weights, sparse.filter_first_items[out_channel],
+              &weights);
+
+          // Filter position of the weight at flat index `position`.
+          unsigned int position = 0;
+          int filter_y = 0;
+          int filter_x = 0;
+          int in_channel = 0;
+          int32_t acc = 0;
+          for (unsigned int i = 0; i < sparse.filter_size; i += 8u) {
+            unsigned int bits = SparsityBits(sparse.sparsity_map, first_bit + i,
+                                             std::min(8u, sparse.filter_size - i));
+            while (bits != 0) {
+              const unsigned int index = i + LowestSetBit(bits);
+              bits &= bits - 1u;
+              in_channel += static_cast<int>(index - position);
+              position = index;
+              while (in_channel >= input_depth) {
+                in_channel -= input_depth;
+                if (++filter_x == filter_width) {
+                  filter_x = 0;
+                  ++filter_y;
+                }
+              }
+              // Weights of padded positions must still be consumed.
+              const int32_t filter_val = weights.unpack<CONTAINER_T, BITS_PER_ITEM>();
+              const int in_y = in_y_origin + dilation_height_factor * filter_y;
+              const int in_x = in_x_origin + dilation_width_factor * filter_x;
+              if ((in_x >= 0) && (in_x < input_width) && (in_y >= 0) &&
+                  (in_y < input_height)) {
+                const int32_t input_val =
+                    input_data[Offset(input_shape, batch, in_y, in_x, in_channel)];
+                acc += filter_val * (input_val + input_offset);
+              }
+            }
+          }
+          if (bias_data) {
+            acc += bias_data[out_channel];
+          }
+          acc = MultiplyByQuantizedMultiplier(acc, output_multiplier[out_channel],
+                                              output_shift[out_channel]);
+          acc += output_offset;
+          acc = std::max(acc, output_activation_min);
+          acc = std::min(acc, output_activation_max);
+          output_data[Offset(output_shape, batch, out_y, out_x, out_channel)] =
+              static_cast<int8_t>(acc);
+        }
+      }
+    }
+  }
+}
+
+}  // namespace micro
+}  // namespace ops
+}  // namespace tflite
+
+#endif /* IFX_TFLM_PUBLIC_IFX_COMMON_SPARSE_KERNELS_H_ */
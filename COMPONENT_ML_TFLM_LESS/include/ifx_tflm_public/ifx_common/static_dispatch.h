@@ -0,0 +1,114 @@
+/* Copyright 2025 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+/*
+Hand-written helpers for code-generated (interpreter-less) models. No code
+generator in this tree emits them; they are building blocks for one.
+* TF_LITE_MICRO_USE_OFFLINE_OP_USER_DATA builds look up the pre-computed
+*     OpData via resetOfflineOpUserData/nextOfflineOpUserData and call the
+*     kernel variant through OpData::eval_function.
+* Generated code can instead call the eval variant recorded at Prepare time
+*     directly by name, and use:
+*       - TFLMC_ARENA_EVAL_TENSOR: tensor data pointers as address constants
+*         at their planned arena offsets (no TfLiteNode/tensor lookups),
+*       - StaticInvokeSequence: the sequence of generated ops, unrolled at
+*         compile time and stopping at the first failing op.
+*     OpData and params are emitted as const objects with static storage, so
+*     they need no arena space and no table walk.
+*
+* Example of generated code:
+*
+*   alignas(16) static int32_t arena[kArenaBytes / sizeof(int32_t)];
+*   static const TfLiteConvParams conv0_params = {...};
+*   static const tflite::ops::micro::conv::OpData conv0_data = {...};
+*   static TfLiteNode node0 = {...};
+*   static TfLiteEvalTensor t0 =
+*       TFLMC_ARENA_EVAL_TENSOR(arena, 0, t0_dims, kTfLiteInt8);
+*   ...
+*   struct Op0 {
+*     static TfLiteStatus Invoke(TfLiteContext* context) {
+*       return tflite::ops::micro::conv::EvalQuantizedPerChannel(
+*           context, &node0, conv0_params, conv0_data, &t0, &w0, &b0, &t1);
+*     }
+*   };
+*   ...
+*   TfLiteStatus ModelInvoke(TfLiteContext* context) {
+*     return tflite::micro::StaticInvokeSequence<Op0, Op1, Op2>::Invoke(context);
+*   }
+==============================================================================*/
+
+#ifndef IFX_TFLM_PUBLIC_IFX_COMMON_STATIC_DISPATCH_H_
+#define IFX_TFLM_PUBLIC_IFX_COMMON_STATIC_DISPATCH_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+
+namespace tflite {
+namespace micro {
+
+/**
+ * @brief Address of arena offset `byte_offset` as an address constant
+ *
+ * The arena is declared as an int32_t array so that tensor addresses are plain
+ * pointer arithmetic on a static object and the tensors are constant
+ * initialized.  Planned offsets are at least 4-byte aligned.
+ */
+template <size_t kByteOffset>
+constexpr int32_t* ArenaAddress(int32_t* arena) {
+  static_assert(kByteOffset % sizeof(int32_t) == 0,
+                "Arena offsets must be word aligned");
+  return arena + kByteOffset / sizeof(int32_t);
+}
+
+#define TFLMC_ARENA_EVAL_TENSOR(arena, byte_offset, dims, type) \
+  { { ::tflite::micro::ArenaAddress<(byte_offset)>(arena) }, (dims), (type) }
+
+/**
+ * @brief Straight-line invocation of generated ops
+ *
+ * @tparam Ops  Structs with a `static TfLiteStatus Invoke(TfLiteContext*)`,
+ *              in execution order.
+ *
+ * Expands to one direct call per op; an op returning anything but kTfLiteOk
+ * ends the sequence and its status is returned.
+ */
+template <typename... Ops>
+struct StaticInvokeSequence;
+
+template <>
+struct StaticInvokeSequence<> {
+  static inline TfLiteStatus Invoke(TfLiteContext* context) {
+    (void)context;
+    return kTfLiteOk;
+  }
+};
+
+template <typename Op, typename... Ops>
+struct StaticInvokeSequence<Op, Ops...> {
+  static inline TfLiteStatus Invoke(TfLiteContext* context) {
+    const TfLiteStatus status = Op::Invoke(context);
+    if (status != kTfLiteOk) {
+      return status;
+    }
+    return StaticInvokeSequence<Ops...>::Invoke(context);
+  }
+};
+
+}  // namespace micro
+}  // namespace tflite
+
+#endif  // IFX_TFLM_PUBLIC_IFX_COMMON_STATIC_DISPATCH_H_
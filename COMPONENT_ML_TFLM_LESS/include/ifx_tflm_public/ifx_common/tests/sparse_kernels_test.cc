@@ -0,0 +1,261 @@
+/* Copyright 2025 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+/*
+Compares the zero-skipping kernels of sparse_kernels.h against the dense
+reference kernels.  Shapes are chosen so that filters do not start on a
+sparsity map byte and, for sub-8-bit packing, not on a container word.
+Returns non-zero on a mismatch.
+==============================================================================*/
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <vector>
+
+#include "ifx_tflm_public/ifx_common/sparse_kernels.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/conv.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/fully_connected.h"
+
+namespace {
+
+using tflite::ops::micro::InitSparsePackedWeights;
+using tflite::ops::micro::SparsePackedWeights;
+
+uint32_t seed = 1;
+
+tflite::RuntimeShape Shape(std::initializer_list<int32_t> dims) {
+  return tflite::RuntimeShape(static_cast<int>(dims.size()), dims.begin());
+}
+
+int32_t NextRandom() {
+  seed = seed * 1664525u + 1013904223u;
+  return static_cast<int32_t>(seed >> 8);
+}
+
+// Dense int8 weights in [-2^(bits-1), 2^(bits-1)), about 70% zeros.
+std::vector<int8_t> SparseWeights(size_t count, unsigned int bits_per_item) {
+  const int32_t range = 1 << bits_per_item;
+  std::vector<int8_t> weights(count);
+  for (size_t i = 0; i < count; ++i) {
+    weights[i] = NextRandom() % 10 < 7
+                     ? 0
+                     : static_cast<int8_t>(NextRandom() % range - range / 2);
+  }
+  return weights;
+}
+
+// Packs `weights` in the layout described at SparsePackedWeights: run
+// lengths, one bitmap over all weights, nonzero weights back to back.
+std::vector<int8_t> PackSparse(
+    const std::vector<int8_t> &weights, size_t num_filters,
+    const TfLiteCustomSub8BitPackingDetails &details) {
+  const size_t filter_size = weights.size() / num_filters;
+  const size_t run_lengths_size =
+      details.compression_type == WORD_RUN_LENGTHS ? num_filters * 2u : 0u;
+  const size_t packed_offset = tflite::ops::micro::wordAlign(
+      run_lengths_size +
+          tflite::ops::micro::sparsityMapSize(weights.size()),
+      details.container_bits);
+  std::vector<int8_t> packed(packed_offset +
+                             weights.size() * sizeof(uint32_t) + 4u);
+  uint8_t *bytes = reinterpret_cast<uint8_t *>(packed.data());
+
+  size_t item = 0;
+  for (size_t f = 0; f < num_filters; ++f) {
+    uint16_t nonzero = 0;
+    for (size_t i = 0; i < filter_size; ++i) {
+      const size_t index = f * filter_size + i;
+      if (weights[index] == 0) {
+        continue;
+      }
+      ++nonzero;
+      bytes[run_lengths_size + index / 8u] |=
+          static_cast<uint8_t>(1u << (index % 8u));
+      const size_t bit = item * details.bits_per_item;
+      const uint32_t value = static_cast<uint8_t>(weights[index]) &
+                             ((1u << details.bits_per_item) - 1u);
+      for (unsigned int b = 0; b < details.bits_per_item; ++b) {
+        if ((value >> b) & 1u) {
+          bytes[packed_offset + (bit + b) / 8u] |=
+              static_cast<uint8_t>(1u << ((bit + b) % 8u));
+        }
+      }
+      ++item;
+    }
+    if (run_lengths_size != 0) {
+      std::memcpy(&bytes[f * 2u], &nonzero, sizeof(nonzero));
+    }
+  }
+  return packed;
+}
+
+TfLiteCustomSub8BitPackingDetails Details(unsigned int bits_per_item,
+                                          unsigned int container_bits,
+                                          unsigned int compression_type) {
+  TfLiteCustomSub8BitPackingDetails details = {};
+  details.bits_per_item = static_cast<uint8_t>(bits_per_item);
+  details.container_bits = static_cast<uint8_t>(container_bits);
+  details.compression_type = static_cast<uint8_t>(compression_type);
+  return details;
+}
+
+template <typename CONTAINER_T, unsigned int BITS_PER_ITEM>
+bool TestFullyConnected(int batches, int accum_depth, int output_depth,
+                        unsigned int compression_type) {
+  const TfLiteCustomSub8BitPackingDetails details =
+      Details(BITS_PER_ITEM, sizeof(CONTAINER_T) * 8u, compression_type);
+  const std::vector<int8_t> weights =
+      SparseWeights(accum_depth * output_depth, BITS_PER_ITEM);
+  const std::vector<int8_t> packed = PackSparse(weights, output_depth, details);
+  std::vector<int8_t> input(batches * accum_depth);
+  for (int8_t &value : input) {
+    value = static_cast<int8_t>(NextRandom());
+  }
+  std::vector<int32_t> bias(output_depth);
+  for (int32_t &value : bias) {
+    value = NextRandom() % 1000;
+  }
+
+  tflite::FullyConnectedParams params = {};
+  params.input_offset = 3;
+  params.weights_offset = 0;
+  params.output_offset = -5;
+  params.output_multiplier = 1 << 30;
+  params.output_shift = -4;
+  params.quantized_activation_min = -128;
+  params.quantized_activation_max = 127;
+  const tflite::RuntimeShape input_shape = Shape({batches, accum_depth});
+  const tflite::RuntimeShape filter_shape =
+      Shape({output_depth, accum_depth});
+  const tflite::RuntimeShape bias_shape = Shape({output_depth});
+  const tflite::RuntimeShape output_shape = Shape({batches, output_depth});
+
+  std::vector<int8_t> expected(batches * output_depth);
+  tflite::reference_integer_ops::FullyConnected(
+      params, input_shape, input.data(), filter_shape, weights.data(),
+      bias_shape, bias.data(), output_shape, expected.data());
+
+  std::vector<uint32_t> first_items(output_depth);
+  SparsePackedWeights sparse;
+  if (InitSparsePackedWeights(packed.data(), weights.size(), output_depth,
+                              details, first_items.data(),
+                              &sparse) != kTfLiteOk) {
+    std::printf("FullyConnected: InitSparsePackedWeights failed\n");
+    return false;
+  }
+  std::vector<int8_t> actual(batches * output_depth);
+  tflite::ops::micro::SparseFullyConnected<CONTAINER_T, BITS_PER_ITEM>(
+      params, input_shape, input.data(), sparse, bias.data(), output_shape,
+      actual.data());
+  if (actual != expected) {
+    std::printf("FullyConnected %d bit in %d bit containers, depth %d: "
+                "mismatch\n", static_cast<int>(BITS_PER_ITEM),
+                static_cast<int>(sizeof(CONTAINER_T) * 8u), accum_depth);
+    return false;
+  }
+  return true;
+}
+
+template <typename CONTAINER_T, unsigned int BITS_PER_ITEM>
+bool TestConv(int input_size, int input_depth, int filter_size,
+              int output_depth, unsigned int compression_type) {
+  const TfLiteCustomSub8BitPackingDetails details =
+      Details(BITS_PER_ITEM, sizeof(CONTAINER_T) * 8u, compression_type);
+  const int filter_weights = filter_size * filter_size * input_depth;
+  const std::vector<int8_t> weights =
+      SparseWeights(filter_weights * output_depth, BITS_PER_ITEM);
+  const std::vector<int8_t> packed = PackSparse(weights, output_depth, details);
+  std::vector<int8_t> input(input_size * input_size * input_depth);
+  for (int8_t &value : input) {
+    value = static_cast<int8_t>(NextRandom());
+  }
+  std::vector<int32_t> bias(output_depth);
+  std::vector<int32_t> multipliers(output_depth);
+  std::vector<int32_t> shifts(output_depth);
+  for (int c = 0; c < output_depth; ++c) {
+    bias[c] = NextRandom() % 1000;
+    multipliers[c] = (1 << 30) + NextRandom() % (1 << 29);
+    shifts[c] = -3 - c % 3;
+  }
+
+  tflite::ConvParams params = {};
+  params.input_offset = 7;
+  params.output_offset = 2;
+  params.stride_width = 1;
+  params.stride_height = 1;
+  params.dilation_width_factor = 1;
+  params.dilation_height_factor = 1;
+  params.padding_values.width = filter_size / 2;
+  params.padding_values.height = filter_size / 2;
+  params.quantized_activation_min = -128;
+  params.quantized_activation_max = 127;
+  const tflite::RuntimeShape input_shape =
+      Shape({1, input_size, input_size, input_depth});
+  const tflite::RuntimeShape filter_shape =
+      Shape({output_depth, filter_size, filter_size, input_depth});
+  const tflite::RuntimeShape bias_shape = Shape({output_depth});
+  const tflite::RuntimeShape output_shape =
+      Shape({1, input_size, input_size, output_depth});
+
+  std::vector<int8_t> expected(input_size * input_size * output_depth);
+  tflite::reference_integer_ops::ConvPerChannel(
+      params, multipliers.data(), shifts.data(), input_shape, input.data(),
+      filter_shape, weights.data(), bias_shape, bias.data(), output_shape,
+      expected.data());
+
+  std::vector<uint32_t> first_items(output_depth);
+  SparsePackedWeights sparse;
+  if (InitSparsePackedWeights(packed.data(), weights.size(), output_depth,
+                              details, first_items.data(),
+                              &sparse) != kTfLiteOk) {
+    std::printf("Conv: InitSparsePackedWeights failed\n");
+    return false;
+  }
+  std::vector<int8_t> actual(expected.size());
+  tflite::ops::micro::SparseConvPerChannel<CONTAINER_T, BITS_PER_ITEM>(
+      params, multipliers.data(), shifts.data(), input_shape, input.data(),
+      filter_shape, sparse, bias.data(), output_shape, actual.data());
+  if (actual != expected) {
+    std::printf("Conv %d bit in %d bit containers, %dx%dx%d filters: "
+                "mismatch\n", static_cast<int>(BITS_PER_ITEM),
+                static_cast<int>(sizeof(CONTAINER_T) * 8u), filter_size,
+                filter_size, input_depth);
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+int main() {
+  bool ok = true;
+  for (unsigned int compression : {NO_RUN_LENGTHS, WORD_RUN_LENGTHS}) {
+    // 8 bit weights, filter sizes that are not a multiple of 8.
+    ok &= TestFullyConnected<int8_t, 8u>(2, 27, 7, compression);
+    ok &= TestConv<int8_t, 8u>(6, 3, 3, 5, compression);
+    // Sub-8-bit weights, filters start mid-container.
+    ok &= TestFullyConnected<uint8_t, 4u>(3, 13, 9, compression);
+    ok &= TestFullyConnected<uint32_t, 4u>(1, 21, 11, compression);
+    ok &= TestFullyConnected<uint16_t, 2u>(2, 19, 6, compression);
+    ok &= TestConv<uint8_t, 4u>(5, 3, 3, 7, compression);
+    ok &= TestConv<uint32_t, 4u>(5, 5, 3, 6, compression);
+    // Byte aligned filters still work.
+    ok &= TestFullyConnected<uint8_t, 4u>(2, 32, 4, compression);
+  }
+  std::printf(ok ? "PASS\n" : "FAIL\n");
+  return ok ? 0 : 1;
+}
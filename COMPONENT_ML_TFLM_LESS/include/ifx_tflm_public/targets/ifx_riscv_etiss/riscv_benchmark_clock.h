@@ -0,0 +1,43 @@
+/* Copyright 2025 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef IFX_TFLM_PUBLIC_TARGETS_IFX_RISCV_ETISS_RISCV_BENCHMARK_CLOCK_H_
+#define IFX_TFLM_PUBLIC_TARGETS_IFX_RISCV_ETISS_RISCV_BENCHMARK_CLOCK_H_
+
+#include <stdint.h>
+
+#include "ifx_tflm_public/targets/ifx_riscv_etiss/riscv_timing_csr.h"
+
+// Core clock used to convert cycles to nanoseconds. The default of 1 GHz
+// makes the benchmark reports read directly as cycles, which is what the
+// ETISS simulator counts.
+#ifndef IFX_RISCV_ETISS_CYCLES_PER_SECOND
+#define IFX_RISCV_ETISS_CYCLES_PER_SECOND 1000000000u
+#endif
+
+namespace tflite {
+
+// MicroBenchmarkClock on the 64 bit cycle CSR, e.g.
+//
+//   tflite::MicroModelBenchmarkConfig config = {};
+//   config.clock = tflite::RiscvEtissBenchmarkClock;
+inline uint64_t RiscvEtissBenchmarkClock() {
+  const uint64_t cycles = rdcycle64();
+  const uint64_t rate = IFX_RISCV_ETISS_CYCLES_PER_SECOND;
+  return cycles / rate * 1000000000u + cycles % rate * 1000000000u / rate;
+}
+
+}  // namespace tflite
+
+#endif  // IFX_TFLM_PUBLIC_TARGETS_IFX_RISCV_ETISS_RISCV_BENCHMARK_CLOCK_H_
@@ -0,0 +1,389 @@
+/* Copyright 2025 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef SIGNAL_MICRO_KERNELS_BATCHED_KERNELS_H_
+#define SIGNAL_MICRO_KERNELS_BATCHED_KERNELS_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#include "signal/src/complex.h"
+#include "signal/src/energy.h"
+#include "signal/src/filter_bank.h"
+#include "signal/src/filter_bank_log.h"
+#include "signal/src/filter_bank_square_root.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/flatbuffer_utils.h"
+#include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/micro_common.h"
+#include "tensorflow/lite/micro/micro_context.h"
+
+// ENERGY, FILTER_BANK, FILTER_BANK_SQUARE_ROOT and FILTER_BANK_LOG kernels
+// that accept a leading batch dimension: every dimension but the last one
+// counts frames. They take the same options and inputs as the single frame
+// kernels, so they can replace them in the op resolver:
+//
+//   resolver.AddCustom("SignalFilterBank",
+//                      tflite::tflm_signal::Register_FILTER_BANK_BATCHED());
+//
+// RFFT already transforms all frames of its input.
+
+namespace tflite {
+namespace tflm_signal {
+namespace batched_kernels {
+
+constexpr int kInputTensor = 0;
+constexpr int kOutputTensor = 0;
+
+// Inputs of FILTER_BANK besides the spectrum.
+constexpr int kWeightTensor = 1;
+constexpr int kUnweightTensor = 2;
+constexpr int kChFreqStartsTensor = 3;
+constexpr int kChWeightStartsTensor = 4;
+constexpr int kChannelWidthsTensor = 5;
+
+// Input of FILTER_BANK_SQUARE_ROOT besides the channels.
+constexpr int kScaleBitsTensor = 1;
+
+// Indices into the flexbuffer options, sorted by name.
+constexpr int kEnergyEndIndexIndex = 0;
+constexpr int kEnergyStartIndexIndex = 1;
+constexpr int kFilterBankNumChannelsIndex = 0;
+constexpr int kLogInputCorrectionBitsIndex = 0;
+constexpr int kLogOutputScaleIndex = 1;
+
+struct EnergyParams {
+  int32_t end_index;
+  int32_t start_index;
+};
+
+struct FilterBankParams {
+  FilterbankConfig config;
+  // kFilterbankFramesPerBlock frames of num_channels + 1 accumulators.
+  uint64_t* work_area;
+};
+
+struct FilterBankLogParams {
+  int32_t input_correction_bits;
+  int32_t output_scale;
+};
+
+inline int FrameSize(const TfLiteIntArray* dims) {
+  return dims->data[dims->size - 1];
+}
+
+inline int NumFrames(const TfLiteIntArray* dims) {
+  int frames = 1;
+  for (int i = 0; i + 1 < dims->size; ++i) {
+    frames *= dims->data[i];
+  }
+  return frames;
+}
+
+// Checks that `input` and `output` have the same frames and that each
+// output frame has `output_frame_size` elements.
+inline TfLiteStatus CheckFrames(TfLiteContext* context,
+                                const TfLiteTensor* input,
+                                const TfLiteTensor* output,
+                                int output_frame_size) {
+  TF_LITE_ENSURE(context, NumDimensions(input) >= 1);
+  TF_LITE_ENSURE_EQ(context, NumDimensions(input), NumDimensions(output));
+  for (int i = 0; i + 1 < NumDimensions(input); ++i) {
+    TF_LITE_ENSURE_EQ(context, input->dims->data[i], output->dims->data[i]);
+  }
+  TF_LITE_ENSURE_EQ(context, FrameSize(output->dims), output_frame_size);
+  return kTfLiteOk;
+}
+
+inline void* EnergyInit(TfLiteContext* context, const char* buffer,
+                        size_t length) {
+  auto* params = static_cast<EnergyParams*>(
+      context->AllocatePersistentBuffer(context, sizeof(EnergyParams)));
+  if (params == nullptr) {
+    return nullptr;
+  }
+  tflite::FlexbufferWrapper fbw(reinterpret_cast<const uint8_t*>(buffer),
+                                length);
+  params->end_index = fbw.ElementAsInt32(kEnergyEndIndexIndex);
+  params->start_index = fbw.ElementAsInt32(kEnergyStartIndexIndex);
+  return params;
+}
+
+inline TfLiteStatus EnergyPrepare(TfLiteContext* context, TfLiteNode* node) {
+  TF_LITE_ENSURE_EQ(context, NumInputs(node), 1);
+  TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
+  const auto* params = static_cast<const EnergyParams*>(node->user_data);
+  MicroContext* micro_context = GetMicroContext(context);
+  TfLiteTensor* input =
+      micro_context->AllocateTempInputTensor(node, kInputTensor);
+  TF_LITE_ENSURE(context, input != nullptr);
+  TfLiteTensor* output =
+      micro_context->AllocateTempOutputTensor(node, kOutputTensor);
+  TF_LITE_ENSURE(context, output != nullptr);
+
+  TF_LITE_ENSURE_TYPES_EQ(context, input->type, kTfLiteInt16);
+  TF_LITE_ENSURE_TYPES_EQ(context, output->type, kTfLiteUInt32);
+  TF_LITE_ENSURE_STATUS(
+      CheckFrames(context, input, output, FrameSize(input->dims) / 2));
+  TF_LITE_ENSURE(context, params->start_index >= 0 &&
+                              params->end_index <= FrameSize(output->dims));
+
+  micro_context->DeallocateTempTfLiteTensor(input);
+  micro_context->DeallocateTempTfLiteTensor(output);
+  return kTfLiteOk;
+}
+
+inline TfLiteStatus EnergyEval(TfLiteContext* context, TfLiteNode* node) {
+  const auto* params = static_cast<const EnergyParams*>(node->user_data);
+  const TfLiteEvalTensor* input =
+      tflite::micro::GetEvalInput(context, node, kInputTensor);
+  TfLiteEvalTensor* output =
+      tflite::micro::GetEvalOutput(context, node, kOutputTensor);
+
+  SpectrumToEnergyBatch(reinterpret_cast<const Complex<int16_t>*>(
+                            tflite::micro::GetTensorData<int16_t>(input)),
+                        FrameSize(input->dims) / 2, params->start_index,
+                        params->end_index, NumFrames(input->dims),
+                        tflite::micro::GetTensorData<uint32_t>(output),
+                        FrameSize(output->dims));
+  return kTfLiteOk;
+}
+
+inline void* FilterBankInit(TfLiteContext* context, const char* buffer,
+                            size_t length) {
+  auto* params = static_cast<FilterBankParams*>(
+      context->AllocatePersistentBuffer(context, sizeof(FilterBankParams)));
+  if (params == nullptr) {
+    return nullptr;
+  }
+  tflite::FlexbufferWrapper fbw(reinterpret_cast<const uint8_t*>(buffer),
+                                length);
+  memset(&params->config, 0, sizeof(params->config));
+  params->config.num_channels = fbw.ElementAsInt32(kFilterBankNumChannelsIndex);
+  params->work_area = static_cast<uint64_t*>(context->AllocatePersistentBuffer(
+      context, kFilterbankFramesPerBlock * (params->config.num_channels + 1) *
+                   sizeof(uint64_t)));
+  if (params->work_area == nullptr) {
+    return nullptr;
+  }
+  return params;
+}
+
+inline TfLiteStatus FilterBankPrepare(TfLiteContext* context,
+                                      TfLiteNode* node) {
+  TF_LITE_ENSURE_EQ(context, NumInputs(node), 6);
+  TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
+  const auto* params = static_cast<const FilterBankParams*>(node->user_data);
+  MicroContext* micro_context = GetMicroContext(context);
+
+  for (int i = kWeightTensor; i <= kChannelWidthsTensor; ++i) {
+    TfLiteTensor* table = micro_context->AllocateTempInputTensor(node, i);
+    TF_LITE_ENSURE(context, table != nullptr);
+    TF_LITE_ENSURE_EQ(context, NumDimensions(table), 1);
+    TF_LITE_ENSURE_TYPES_EQ(context, table->type, kTfLiteInt16);
+    micro_context->DeallocateTempTfLiteTensor(table);
+  }
+  TfLiteTensor* input =
+      micro_context->AllocateTempInputTensor(node, kInputTensor);
+  TF_LITE_ENSURE(context, input != nullptr);
+  TfLiteTensor* output =
+      micro_context->AllocateTempOutputTensor(node, kOutputTensor);
+  TF_LITE_ENSURE(context, output != nullptr);
+
+  TF_LITE_ENSURE_TYPES_EQ(context, input->type, kTfLiteUInt32);
+  TF_LITE_ENSURE_TYPES_EQ(context, output->type, kTfLiteUInt64);
+  TF_LITE_ENSURE_STATUS(
+      CheckFrames(context, input, output, params->config.num_channels));
+
+  micro_context->DeallocateTempTfLiteTensor(input);
+  micro_context->DeallocateTempTfLiteTensor(output);
+  return kTfLiteOk;
+}
+
+inline TfLiteStatus FilterBankEval(TfLiteContext* context, TfLiteNode* node) {
+  auto* params = static_cast<FilterBankParams*>(node->user_data);
+  const TfLiteEvalTensor* input =
+      tflite::micro::GetEvalInput(context, node, kInputTensor);
+  TfLiteEvalTensor* output =
+      tflite::micro::GetEvalOutput(context, node, kOutputTensor);
+
+  FilterbankConfig& config = params->config;
+  config.weights = tflite::micro::GetTensorData<int16_t>(
+      tflite::micro::GetEvalInput(context, node, kWeightTensor));
+  config.unweights = tflite::micro::GetTensorData<int16_t>(
+      tflite::micro::GetEvalInput(context, node, kUnweightTensor));
+  config.channel_frequency_starts = tflite::micro::GetTensorData<int16_t>(
+      tflite::micro::GetEvalInput(context, node, kChFreqStartsTensor));
+  config.channel_weight_starts = tflite::micro::GetTensorData<int16_t>(
+      tflite::micro::GetEvalInput(context, node, kChWeightStartsTensor));
+  config.channel_widths = tflite::micro::GetTensorData<int16_t>(
+      tflite::micro::GetEvalInput(context, node, kChannelWidthsTensor));
+
+  const uint32_t* input_data = tflite::micro::GetTensorData<uint32_t>(input);
+  uint64_t* output_data = tflite::micro::GetTensorData<uint64_t>(output);
+  const int input_size = FrameSize(input->dims);
+  const int num_channels = config.num_channels;
+  const int num_frames = NumFrames(input->dims);
+  for (int first = 0; first < num_frames;
+       first += kFilterbankFramesPerBlock) {
+    const int frames = num_frames - first < kFilterbankFramesPerBlock
+                           ? num_frames - first
+                           : kFilterbankFramesPerBlock;
+    FilterbankAccumulateChannelsBatch(&config, input_data + first * input_size,
+                                      input_size, frames, params->work_area,
+                                      num_channels + 1);
+    // The first accumulator of each frame is scratch.
+    for (int f = 0; f < frames; ++f) {
+      memcpy(output_data + (first + f) * num_channels,
+             params->work_area + f * (num_channels + 1) + 1,
+             num_channels * sizeof(uint64_t));
+    }
+  }
+  return kTfLiteOk;
+}
+
+inline TfLiteStatus FilterBankSquareRootPrepare(TfLiteContext* context,
+                                                TfLiteNode* node) {
+  TF_LITE_ENSURE_EQ(context, NumInputs(node), 2);
+  TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
+  MicroContext* micro_context = GetMicroContext(context);
+  TfLiteTensor* input =
+      micro_context->AllocateTempInputTensor(node, kInputTensor);
+  TF_LITE_ENSURE(context, input != nullptr);
+  TfLiteTensor* scale_bits =
+      micro_context->AllocateTempInputTensor(node, kScaleBitsTensor);
+  TF_LITE_ENSURE(context, scale_bits != nullptr);
+  TfLiteTensor* output =
+      micro_context->AllocateTempOutputTensor(node, kOutputTensor);
+  TF_LITE_ENSURE(context, output != nullptr);
+
+  TF_LITE_ENSURE_TYPES_EQ(context, input->type, kTfLiteUInt64);
+  TF_LITE_ENSURE_TYPES_EQ(context, scale_bits->type, kTfLiteInt32);
+  TF_LITE_ENSURE_EQ(context, NumElements(scale_bits), 1);
+  TF_LITE_ENSURE_TYPES_EQ(context, output->type, kTfLiteUInt32);
+  TF_LITE_ENSURE_STATUS(
+      CheckFrames(context, input, output, FrameSize(input->dims)));
+
+  micro_context->DeallocateTempTfLiteTensor(input);
+  micro_context->DeallocateTempTfLiteTensor(scale_bits);
+  micro_context->DeallocateTempTfLiteTensor(output);
+  return kTfLiteOk;
+}
+
+// The square root is taken per element, so all frames go in one call.
+inline TfLiteStatus FilterBankSquareRootEval(TfLiteContext* context,
+                                             TfLiteNode* node) {
+  const TfLiteEvalTensor* input =
+      tflite::micro::GetEvalInput(context, node, kInputTensor);
+  const TfLiteEvalTensor* scale_bits =
+      tflite::micro::GetEvalInput(context, node, kScaleBitsTensor);
+  TfLiteEvalTensor* output =
+      tflite::micro::GetEvalOutput(context, node, kOutputTensor);
+
+  FilterbankSqrt(tflite::micro::GetTensorData<uint64_t>(input),
+                 NumFrames(input->dims) * FrameSize(input->dims),
+                 *tflite::micro::GetTensorData<int32_t>(scale_bits),
+                 tflite::micro::GetTensorData<uint32_t>(output));
+  return kTfLiteOk;
+}
+
+inline void* FilterBankLogInit(TfLiteContext* context, const char* buffer,
+                               size_t length) {
+  auto* params = static_cast<FilterBankLogParams*>(
+      context->AllocatePersistentBuffer(context, sizeof(FilterBankLogParams)));
+  if (params == nullptr) {
+    return nullptr;
+  }
+  tflite::FlexbufferWrapper fbw(reinterpret_cast<const uint8_t*>(buffer),
+                                length);
+  params->input_correction_bits =
+      fbw.ElementAsInt32(kLogInputCorrectionBitsIndex);
+  params->output_scale = fbw.ElementAsInt32(kLogOutputScaleIndex);
+  return params;
+}
+
+inline TfLiteStatus FilterBankLogPrepare(TfLiteContext* context,
+                                         TfLiteNode* node) {
+  TF_LITE_ENSURE_EQ(context, NumInputs(node), 1);
+  TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
+  MicroContext* micro_context = GetMicroContext(context);
+  TfLiteTensor* input =
+      micro_context->AllocateTempInputTensor(node, kInputTensor);
+  TF_LITE_ENSURE(context, input != nullptr);
+  TfLiteTensor* output =
+      micro_context->AllocateTempOutputTensor(node, kOutputTensor);
+  TF_LITE_ENSURE(context, output != nullptr);
+
+  TF_LITE_ENSURE_TYPES_EQ(context, input->type, kTfLiteUInt32);
+  TF_LITE_ENSURE_TYPES_EQ(context, output->type, kTfLiteInt16);
+  TF_LITE_ENSURE_STATUS(
+      CheckFrames(context, input, output, FrameSize(input->dims)));
+
+  micro_context->DeallocateTempTfLiteTensor(input);
+  micro_context->DeallocateTempTfLiteTensor(output);
+  return kTfLiteOk;
+}
+
+// The log is taken per element, so all frames go in one call.
+inline TfLiteStatus FilterBankLogEval(TfLiteContext* context,
+                                      TfLiteNode* node) {
+  const auto* params = static_cast<const FilterBankLogParams*>(node->user_data);
+  const TfLiteEvalTensor* input =
+      tflite::micro::GetEvalInput(context, node, kInputTensor);
+  TfLiteEvalTensor* output =
+      tflite::micro::GetEvalOutput(context, node, kOutputTensor);
+
+  FilterbankLog(tflite::micro::GetTensorData<uint32_t>(input),
+                NumFrames(input->dims) * FrameSize(input->dims),
+                params->output_scale, params->input_correction_bits,
+                tflite::micro::GetTensorData<int16_t>(output));
+  return kTfLiteOk;
+}
+
+}  // namespace batched_kernels
+
+inline TFLMRegistration* Register_ENERGY_BATCHED() {
+  static TFLMRegistration r = tflite::micro::RegisterOp(
+      batched_kernels::EnergyInit, batched_kernels::EnergyPrepare,
+      batched_kernels::EnergyEval);
+  return &r;
+}
+
+inline TFLMRegistration* Register_FILTER_BANK_BATCHED() {
+  static TFLMRegistration r = tflite::micro::RegisterOp(
+      batched_kernels::FilterBankInit, batched_kernels::FilterBankPrepare,
+      batched_kernels::FilterBankEval);
+  return &r;
+}
+
+inline TFLMRegistration* Register_FILTER_BANK_SQUARE_ROOT_BATCHED() {
+  static TFLMRegistration r =
+      tflite::micro::RegisterOp(nullptr,
+                                batched_kernels::FilterBankSquareRootPrepare,
+                                batched_kernels::FilterBankSquareRootEval);
+  return &r;
+}
+
+inline TFLMRegistration* Register_FILTER_BANK_LOG_BATCHED() {
+  static TFLMRegistration r = tflite::micro::RegisterOp(
+      batched_kernels::FilterBankLogInit, batched_kernels::FilterBankLogPrepare,
+      batched_kernels::FilterBankLogEval);
+  return &r;
+}
+
+}  // namespace tflm_signal
+}  // namespace tflite
+
+#endif  // SIGNAL_MICRO_KERNELS_BATCHED_KERNELS_H_
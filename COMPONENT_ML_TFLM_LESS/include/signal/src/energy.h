@@ -32,6 +32,18 @@ namespace tflm_signal {
 void SpectrumToEnergy(const Complex<int16_t>* input, int start_index,
                       int end_index, uint32_t* output);
 
+// SpectrumToEnergy() for `num_frames` frames, read from
+// `input + f * input_stride` and written to `output + f * output_stride`.
+inline void SpectrumToEnergyBatch(const Complex<int16_t>* input,
+                                  int input_stride, int start_index,
+                                  int end_index, int num_frames,
+                                  uint32_t* output, int output_stride) {
+  for (int f = 0; f < num_frames; f++) {
+    SpectrumToEnergy(input + f * input_stride, start_index, end_index,
+                     output + f * output_stride);
+  }
+}
+
 }  // namespace tflm_signal
 }  // namespace tflite
 
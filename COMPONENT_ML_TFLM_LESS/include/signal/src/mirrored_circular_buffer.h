@@ -0,0 +1,179 @@
+/* Copyright 2025 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef SIGNAL_SRC_MIRRORED_CIRCULAR_BUFFER_H_
+#define SIGNAL_SRC_MIRRORED_CIRCULAR_BUFFER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace tflite {
+namespace tflm_signal {
+
+// Circular buffer of int16 samples whose storage is mirrored: element `i` is
+// kept at `buffer[i]` and at `buffer[i + capacity]`. Any window of up to
+// `capacity` elements starting at the read position is therefore one
+// contiguous span, and reading it needs no copy and no wrap around check.
+// Writes copy the data twice, in at most four memcpy calls, and reads are
+// free, which suits overlapping windows such as frames: every sample is
+// written once and then read by several windows.
+//
+// Unlike CircularBuffer, all operations work on blocks of elements.
+struct MirroredCircularBuffer {
+  // Max number of elements, value passed-in to MirroredCircularBufferInit.
+  size_t capacity;
+  // Next position to read, in [0, capacity).
+  size_t read;
+  // Next position to write, in [0, capacity).
+  size_t write;
+  // Number of elements ready to read.
+  size_t available;
+  // 2 * capacity elements.
+  int16_t* buffer;
+};
+
+namespace mirrored_circular_buffer_internal {
+
+// Copies `n` elements of `values`, or zeros if it is null, to both copies of
+// the buffer at the write position, which must not wrap around.
+inline void WriteContiguous(MirroredCircularBuffer* cb, const int16_t* values,
+                            size_t n) {
+  int16_t* first = cb->buffer + cb->write;
+  int16_t* second = first + cb->capacity;
+  if (values != nullptr) {
+    memcpy(first, values, n * sizeof(int16_t));
+    memcpy(second, values, n * sizeof(int16_t));
+  } else {
+    memset(first, 0, n * sizeof(int16_t));
+    memset(second, 0, n * sizeof(int16_t));
+  }
+  cb->write += n;
+  if (cb->write == cb->capacity) {
+    cb->write = 0;
+  }
+  cb->available += n;
+}
+
+inline void Write(MirroredCircularBuffer* cb, const int16_t* values,
+                  size_t n) {
+  const size_t to_end = cb->capacity - cb->write;
+  if (n > to_end) {
+    WriteContiguous(cb, values, to_end);
+    values = values != nullptr ? values + to_end : nullptr;
+    n -= to_end;
+  }
+  WriteContiguous(cb, values, n);
+}
+
+}  // namespace mirrored_circular_buffer_internal
+
+// Returns the size of the memory that the mirrored circular buffer needs in
+// order to hold `capacity` items.
+inline size_t MirroredCircularBufferGetNeededMemory(size_t capacity) {
+  return sizeof(MirroredCircularBuffer) + 2 * capacity * sizeof(int16_t);
+}
+
+// Reset a mirrored circular buffer to its initial empty state
+inline void MirroredCircularBufferReset(MirroredCircularBuffer* cb) {
+  cb->read = 0;
+  cb->write = 0;
+  cb->available = 0;
+}
+
+// Initialize an instance of the mirrored circular buffer that holds
+// `capacity` items. `state` points to a memory allocation of size
+// `state_size`, which must be pointer aligned and greater or equal to the
+// value returned by MirroredCircularBufferGetNeededMemory(capacity).
+// On success, returns a pointer to the circular buffer's object, otherwise
+// nullptr.
+inline MirroredCircularBuffer* MirroredCircularBufferInit(size_t capacity,
+                                                          void* state,
+                                                          size_t state_size) {
+  if (capacity == 0 || state == nullptr ||
+      (reinterpret_cast<uintptr_t>(state) & (alignof(void*) - 1)) != 0 ||
+      state_size < MirroredCircularBufferGetNeededMemory(capacity)) {
+    return nullptr;
+  }
+  MirroredCircularBuffer* cb = static_cast<MirroredCircularBuffer*>(state);
+  cb->capacity = capacity;
+  cb->buffer = reinterpret_cast<int16_t*>(static_cast<uint8_t*>(state) +
+                                          sizeof(MirroredCircularBuffer));
+  MirroredCircularBufferReset(cb);
+  return cb;
+}
+
+inline size_t MirroredCircularBufferCapacity(const MirroredCircularBuffer* cb) {
+  return cb->capacity;
+}
+
+// Returns the number of elements ready to read.
+inline size_t MirroredCircularBufferAvailable(
+    const MirroredCircularBuffer* cb) {
+  return cb->available;
+}
+
+// Returns the number of elements that can be written.
+inline size_t MirroredCircularBufferCanWrite(const MirroredCircularBuffer* cb) {
+  return cb->capacity - cb->available;
+}
+
+// Writes `n` `values` into the buffer. `n` must not exceed
+// MirroredCircularBufferCanWrite().
+inline void MirroredCircularBufferWrite(MirroredCircularBuffer* cb,
+                                        const int16_t* values, size_t n) {
+  mirrored_circular_buffer_internal::Write(cb, values, n);
+}
+
+// Writes `n` zeros into the buffer. `n` must not exceed
+// MirroredCircularBufferCanWrite().
+inline void MirroredCircularBufferWriteZeros(MirroredCircularBuffer* cb,
+                                             size_t n) {
+  mirrored_circular_buffer_internal::Write(cb, nullptr, n);
+}
+
+// Returns a pointer to the element `offset` elements after the read position,
+// without modifying the read position. All elements available from there on
+// are contiguous. The span stays valid until its elements are discarded and
+// written again.
+inline const int16_t* MirroredCircularBufferPeekWindow(
+    const MirroredCircularBuffer* cb, size_t offset) {
+  return cb->buffer + cb->read + offset;
+}
+
+// Discards the next `n` elements by advancing the read position. `n` must not
+// exceed MirroredCircularBufferAvailable().
+inline void MirroredCircularBufferDiscard(MirroredCircularBuffer* cb,
+                                          size_t n) {
+  cb->read += n;
+  if (cb->read >= cb->capacity) {
+    cb->read -= cb->capacity;
+  }
+  cb->available -= n;
+}
+
+// Copies the next `n` elements to `values` and discards them. `n` must not
+// exceed MirroredCircularBufferAvailable().
+inline void MirroredCircularBufferRead(MirroredCircularBuffer* cb, size_t n,
+                                       int16_t* values) {
+  memcpy(values, MirroredCircularBufferPeekWindow(cb, 0),
+         n * sizeof(int16_t));
+  MirroredCircularBufferDiscard(cb, n);
+}
+
+}  // namespace tflm_signal
+}  // namespace tflite
+
+#endif  // SIGNAL_SRC_MIRRORED_CIRCULAR_BUFFER_H_
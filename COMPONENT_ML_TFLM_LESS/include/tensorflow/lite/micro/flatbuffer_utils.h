@@ -60,6 +60,99 @@ TfLiteIntArray* FlatBufferVectorToTfLiteTypeArray(
 TfLiteFloatArray* FlatBufferVectorToTfLiteTypeArray(
     const flatbuffers::Vector<float>* flatbuffer_array);
 
+// The helpers below only read the flatbuffer and are header only, so that
+// host-side tools can use them without linking the runtime library.
+
+// Returns the builtin operator of an operator code. Mirrors GetBuiltinCode()
+// from schema_utils.h, which reads the larger of the deprecated 8-bit field and
+// the extended builtin_code field.
+inline BuiltinOperator FlatbufferOperatorBuiltinCode(
+    const OperatorCode* op_code) {
+  const int deprecated_code = op_code->deprecated_builtin_code();
+  const int code = op_code->builtin_code();
+  return static_cast<BuiltinOperator>(code > deprecated_code ? code
+                                                             : deprecated_code);
+}
+
+// Returns the builtin operator of `op`.
+inline BuiltinOperator FlatbufferOperatorBuiltinCode(const Model* model,
+                                                     const Operator* op) {
+  return FlatbufferOperatorBuiltinCode(
+      model->operator_codes()->Get(op->opcode_index()));
+}
+
+// Returns true if the tensor's contents are stored in the model, i.e. it's a
+// constant that is not planned in the arena.
+inline bool FlatbufferTensorHasData(const Model* model, const Tensor* tensor) {
+  const auto* buffers = model->buffers();
+  if (buffers == nullptr || tensor->buffer() >= buffers->size()) {
+    return false;
+  }
+  const Buffer* buffer = buffers->Get(tensor->buffer());
+  if (buffer == nullptr) {
+    return false;
+  }
+  // Models larger than 2GB keep constant data behind offset/size.
+  return (buffer->data() != nullptr && buffer->data()->size() > 0) ||
+         buffer->offset() > 1;
+}
+
+// Returns the size in bytes of one element of `type` once loaded in the arena.
+// Sub-byte types are unpacked to one byte per element.
+inline size_t FlatbufferTensorTypeSize(TensorType type) {
+  switch (type) {
+    case TensorType_FLOAT64:
+    case TensorType_INT64:
+    case TensorType_UINT64:
+    case TensorType_COMPLEX64:
+      return 8;
+    case TensorType_COMPLEX128:
+      return 16;
+    case TensorType_FLOAT32:
+    case TensorType_INT32:
+    case TensorType_UINT32:
+      return 4;
+    case TensorType_FLOAT16:
+    case TensorType_BFLOAT16:
+    case TensorType_INT16:
+    case TensorType_UINT16:
+      return 2;
+    default:
+      return 1;
+  }
+}
+
+// Returns the number of elements of a tensor from its static shape.
+inline size_t FlatbufferTensorElementCount(const Tensor* tensor) {
+  size_t count = 1;
+  if (tensor->shape() != nullptr) {
+    for (int32_t dim : *tensor->shape()) {
+      count *= dim > 0 ? dim : 1;
+    }
+  }
+  return count;
+}
+
+// Returns the number of bytes a tensor needs in the arena.
+inline size_t FlatbufferTensorBytes(const Tensor* tensor) {
+  return FlatbufferTensorElementCount(tensor) *
+         FlatbufferTensorTypeSize(tensor->type());
+}
+
+// Returns true if `tensor_index` is in `indices`.
+inline bool FlatbufferVectorContains(const flatbuffers::Vector<int32_t>* indices,
+                                     int32_t tensor_index) {
+  if (indices == nullptr) {
+    return false;
+  }
+  for (int32_t index : *indices) {
+    if (index == tensor_index) {
+      return true;
+    }
+  }
+  return false;
+}
+
 }  // namespace tflite
 
 #endif  // THIRD_PARTY_TFLITE_MICRO_TENSORFLOW_LITE_MICRO_FLATBUFFER_UTILS_H_
@@ -0,0 +1,772 @@
+/* Copyright 2025 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_KERNELS_KERNEL_BENCHMARK_H_
+#define TENSORFLOW_LITE_MICRO_KERNELS_KERNEL_BENCHMARK_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/compatibility.h"
+#include "tensorflow/lite/micro/kernels/kernel_runner.h"
+#include "tensorflow/lite/micro/micro_benchmark_clock.h"
+#include "tensorflow/lite/micro/micro_json_writer.h"
+
+namespace tflite {
+namespace micro {
+
+// Returns a monotonic time in nanoseconds.
+typedef MicroBenchmarkClock KernelBenchmarkClock;
+
+inline uint64_t KernelBenchmarkDefaultClock() {
+  return MicroBenchmarkDefaultClock();
+}
+
+// One kernel, variant, shape and type combination. Variants are separate
+// registrations of the same operator, e.g. the reference kernel,
+// Register_CONV_2D_INT8() of CMSIS-NN or the IFX fast kernels, or an NNLite
+// emulated kernel. All pointers must stay valid while the case runs.
+struct KernelBenchmarkCase {
+  // Names reported in the JSON output.
+  const char* kernel;
+  const char* variant;
+  const char* type;
+  const char* shape;
+  const char* activation;
+
+  const TFLMRegistration* registration;
+  TfLiteTensor* tensors;
+  int tensors_size;
+  TfLiteIntArray* inputs;
+  TfLiteIntArray* outputs;
+  const void* builtin_data;
+  const char* init_data;
+  size_t init_data_size;
+
+  // Multiply-accumulates per invoke, 0 if not applicable.
+  uint64_t macs;
+};
+
+struct KernelBenchmarkResult {
+  TfLiteStatus status;
+  uint32_t invocations;
+  // Mean time of the invoke calls, in thousandths of a nanosecond.
+  uint64_t ns_per_invoke_thousandths;
+  uint64_t macs_per_second;
+  // Arena bytes requested by the kernel in init and prepare.
+  size_t scratch_bytes;
+  size_t persistent_bytes;
+};
+
+namespace kernel_benchmark_internal {
+
+// Accounting for the registration under measurement. KernelRunner runs one
+// kernel at a time, so a single instance is enough.
+struct State {
+  TFLMRegistration wrapped;
+  KernelBenchmarkClock clock;
+  uint64_t invoke_ns;
+  size_t scratch_bytes;
+  size_t persistent_bytes;
+  void* (*allocate_persistent_buffer)(TfLiteContext* context, size_t bytes);
+  TfLiteStatus (*request_scratch_buffer_in_arena)(TfLiteContext* context,
+                                                  size_t bytes,
+                                                  int* buffer_index);
+};
+
+inline State& GetState() {
+  static State state = {};
+  return state;
+}
+
+inline void* CountingAllocatePersistentBuffer(TfLiteContext* context,
+                                              size_t bytes) {
+  GetState().persistent_bytes += bytes;
+  return GetState().allocate_persistent_buffer(context, bytes);
+}
+
+inline TfLiteStatus CountingRequestScratchBufferInArena(TfLiteContext* context,
+                                                        size_t bytes,
+                                                        int* buffer_index) {
+  GetState().scratch_bytes += bytes;
+  return GetState().request_scratch_buffer_in_arena(context, bytes,
+                                                    buffer_index);
+}
+
+inline void HookContext(TfLiteContext* context) {
+  State& state = GetState();
+  state.allocate_persistent_buffer = context->AllocatePersistentBuffer;
+  state.request_scratch_buffer_in_arena = context->RequestScratchBufferInArena;
+  context->AllocatePersistentBuffer = CountingAllocatePersistentBuffer;
+  context->RequestScratchBufferInArena = CountingRequestScratchBufferInArena;
+}
+
+inline void UnhookContext(TfLiteContext* context) {
+  State& state = GetState();
+  context->AllocatePersistentBuffer = state.allocate_persistent_buffer;
+  context->RequestScratchBufferInArena = state.request_scratch_buffer_in_arena;
+}
+
+inline void* Init(TfLiteContext* context, const char* buffer, size_t length) {
+  if (GetState().wrapped.init == nullptr) {
+    return nullptr;
+  }
+  HookContext(context);
+  void* data = GetState().wrapped.init(context, buffer, length);
+  UnhookContext(context);
+  return data;
+}
+
+inline void Free(TfLiteContext* context, void* buffer) {
+  if (GetState().wrapped.free != nullptr) {
+    GetState().wrapped.free(context, buffer);
+  }
+}
+
+inline TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
+  if (GetState().wrapped.prepare == nullptr) {
+    return kTfLiteOk;
+  }
+  HookContext(context);
+  const TfLiteStatus status = GetState().wrapped.prepare(context, node);
+  UnhookContext(context);
+  return status;
+}
+
+// Times only the wrapped invoke, not the KernelRunner around it.
+inline TfLiteStatus Invoke(TfLiteContext* context, TfLiteNode* node) {
+  State& state = GetState();
+  const uint64_t start = state.clock();
+  const TfLiteStatus status = state.wrapped.invoke(context, node);
+  state.invoke_ns += state.clock() - start;
+  return status;
+}
+
+}  // namespace kernel_benchmark_internal
+
+// Runs KernelBenchmarkCases on KernelRunner and writes one JSON object per
+// case:
+//
+//   {"benchmarks":[
+//   {"kernel":"conv_2d","variant":"cmsis_nn","type":"int8",
+//    "shape":"1x32x32x16_3x3x16_s1","activation":"relu","status":"ok",
+//    "invocations":200,"ns_per_invoke":123456.789,"macs_per_second":...,
+//    "scratch_bytes":1024,"persistent_bytes":96},
+//   ...]}
+//
+// Only the kernel's invoke is timed. Each case is warmed up first, then
+// invoked until both `min_invocations` and `min_time_ns` are reached, or
+// `max_invocations`. The output stays valid JSON if a case fails; its status
+// is "error" and its numbers are 0.
+//
+// Example:
+//
+//   tflite::micro::KernelBenchmark benchmark(WriteToUart, nullptr);
+//   tflite::micro::KernelBenchmarkTensors tensors(memory, sizeof(memory));
+//   TFLMRegistration reference = tflite::Register_CONV_2D();
+//   TFLMRegistration fast = tflite::Register_CONV_2D_INT8();
+//   for (const auto& shape : kShapes) {
+//     for (auto activation : {kTfLiteActNone, kTfLiteActRelu6}) {
+//       tflite::micro::KernelBenchmarkCase c = tensors.BuildConv2D(
+//           shape, tflite::micro::KernelBenchmarkType::kInt8, activation);
+//       c.kernel = "conv_2d";
+//       c.variant = "reference";
+//       c.registration = &reference;
+//       benchmark.Run(c);
+//       c.variant = "fast";
+//       c.registration = &fast;
+//       benchmark.Run(c);
+//     }
+//   }
+//   benchmark.Finish();
+class KernelBenchmark {
+ public:
+  KernelBenchmark(MicroTextSink sink, void* context,
+                  KernelBenchmarkClock clock = KernelBenchmarkDefaultClock,
+                  uint32_t warmup_invocations = 2,
+                  uint32_t min_invocations = 10,
+                  uint64_t min_time_ns = 100000000u,
+                  uint32_t max_invocations = 100000u)
+      : writer_(sink, context),
+        clock_(clock),
+        warmup_invocations_(warmup_invocations),
+        min_invocations_(min_invocations > 0 ? min_invocations : 1),
+        min_time_ns_(min_time_ns),
+        max_invocations_(max_invocations > min_invocations_
+                             ? max_invocations
+                             : min_invocations_),
+        count_(0),
+        finished_(false) {
+    writer_.Append("{\"benchmarks\":[");
+  }
+
+  ~KernelBenchmark() { Finish(); }
+
+  // Measures `benchmark_case` and writes its JSON object.
+  KernelBenchmarkResult Run(const KernelBenchmarkCase& benchmark_case) {
+    KernelBenchmarkResult result = Measure(benchmark_case);
+    Write(benchmark_case, result);
+    return result;
+  }
+
+  // Closes the JSON output. Called by the destructor if needed.
+  void Finish() {
+    if (finished_) {
+      return;
+    }
+    finished_ = true;
+    writer_.Append("\n]}\n");
+    writer_.Flush();
+  }
+
+  int count() const { return count_; }
+
+ private:
+  KernelBenchmarkResult Measure(const KernelBenchmarkCase& benchmark_case) {
+    using kernel_benchmark_internal::State;
+    KernelBenchmarkResult result = {};
+    result.status = kTfLiteError;
+    if (benchmark_case.registration == nullptr ||
+        benchmark_case.registration->invoke == nullptr ||
+        benchmark_case.tensors == nullptr) {
+      return result;
+    }
+
+    State& state = kernel_benchmark_internal::GetState();
+    state = {};
+    state.wrapped = *benchmark_case.registration;
+    state.clock = clock_;
+    TFLMRegistration registration = *benchmark_case.registration;
+    registration.init = kernel_benchmark_internal::Init;
+    registration.free = kernel_benchmark_internal::Free;
+    registration.prepare = kernel_benchmark_internal::Prepare;
+    registration.invoke = kernel_benchmark_internal::Invoke;
+
+    KernelRunner runner(registration, benchmark_case.tensors,
+                        benchmark_case.tensors_size, benchmark_case.inputs,
+                        benchmark_case.outputs, benchmark_case.builtin_data);
+    result.status = runner.InitAndPrepare(benchmark_case.init_data,
+                                          benchmark_case.init_data_size);
+    result.scratch_bytes = state.scratch_bytes;
+    result.persistent_bytes = state.persistent_bytes;
+    for (uint32_t i = 0; i < warmup_invocations_ && result.status == kTfLiteOk;
+         ++i) {
+      result.status = runner.Invoke(/*no_second_invoke=*/true);
+    }
+    state.invoke_ns = 0;
+    while (result.status == kTfLiteOk &&
+           (result.invocations < min_invocations_ ||
+            state.invoke_ns < min_time_ns_) &&
+           result.invocations < max_invocations_) {
+      result.status = runner.Invoke(/*no_second_invoke=*/true);
+      ++result.invocations;
+    }
+    runner.Free();
+
+    if (result.status != kTfLiteOk) {
+      result.invocations = 0;
+      return result;
+    }
+    const uint64_t total_ns = state.invoke_ns > 0 ? state.invoke_ns : 1;
+    result.ns_per_invoke_thousandths = total_ns * 1000u / result.invocations;
+    result.macs_per_second = static_cast<uint64_t>(
+        static_cast<double>(benchmark_case.macs) * result.invocations *
+        1e9 / static_cast<double>(total_ns));
+    return result;
+  }
+
+  void Write(const KernelBenchmarkCase& benchmark_case,
+             const KernelBenchmarkResult& result) {
+    writer_.Append(count_++ == 0 ? "\n{" : ",\n{");
+    writer_.AppendString("kernel", benchmark_case.kernel, /*first=*/true);
+    writer_.AppendString("variant", benchmark_case.variant);
+    writer_.AppendString("type", benchmark_case.type);
+    writer_.AppendString("shape", benchmark_case.shape);
+    writer_.AppendString("activation", benchmark_case.activation);
+    writer_.AppendString("status", result.status == kTfLiteOk ? "ok" : "error");
+    writer_.AppendNumber("invocations", result.invocations);
+    writer_.AppendKey("ns_per_invoke");
+    writer_.AppendThousandths(result.ns_per_invoke_thousandths);
+    writer_.AppendNumber("macs_per_second", result.macs_per_second);
+    writer_.AppendNumber("scratch_bytes", result.scratch_bytes);
+    writer_.AppendNumber("persistent_bytes", result.persistent_bytes);
+    writer_.Append('}');
+  }
+
+  MicroJsonWriter writer_;
+  KernelBenchmarkClock clock_;
+  uint32_t warmup_invocations_;
+  uint32_t min_invocations_;
+  uint64_t min_time_ns_;
+  uint32_t max_invocations_;
+  int count_;
+  bool finished_;
+};
+
+// Data types the tensor builder creates. Weights are int8 except for kFloat32
+// and kInt4, where they are packed two per byte. Packed sub-8-bit weights of
+// other kernels are built by the caller and passed in a KernelBenchmarkCase.
+enum class KernelBenchmarkType { kFloat32, kInt8, kInt16x8, kInt4 };
+
+inline const char* KernelBenchmarkTypeName(KernelBenchmarkType type) {
+  switch (type) {
+    case KernelBenchmarkType::kFloat32:
+      return "float32";
+    case KernelBenchmarkType::kInt8:
+      return "int8";
+    case KernelBenchmarkType::kInt16x8:
+      return "int16x8";
+    case KernelBenchmarkType::kInt4:
+      return "int4";
+  }
+  return "unknown";
+}
+
+inline const char* KernelBenchmarkActivationName(
+    TfLiteFusedActivation activation) {
+  switch (activation) {
+    case kTfLiteActNone:
+      return "none";
+    case kTfLiteActRelu:
+      return "relu";
+    case kTfLiteActReluN1To1:
+      return "relu_n1_to_1";
+    case kTfLiteActRelu6:
+      return "relu6";
+    case kTfLiteActTanh:
+      return "tanh";
+    case kTfLiteActSignBit:
+      return "sign_bit";
+    case kTfLiteActSigmoid:
+      return "sigmoid";
+  }
+  return "unknown";
+}
+
+// NHWC input, VALID padding and no dilation. For depthwise convolutions
+// `output_channels` must be a multiple of `input_channels`.
+struct KernelBenchmarkConvShape {
+  int batches;
+  int height;
+  int width;
+  int input_channels;
+  int output_channels;
+  int filter_height;
+  int filter_width;
+  int stride;
+};
+
+struct KernelBenchmarkFullyConnectedShape {
+  int batches;
+  int input_size;
+  int output_size;
+};
+
+// Builds the tensors of a conv, depthwise conv or fully connected case in
+// memory provided by the caller, with deterministic pseudo random data.
+// Each Build call reuses the memory, so the returned case is valid until the
+// next call.
+class KernelBenchmarkTensors {
+ public:
+  KernelBenchmarkTensors(uint8_t* memory, size_t size)
+      : memory_(memory), size_(size), used_(0), seed_(1) {}
+
+  // The caller sets the names and the registration of the returned case. If
+  // `memory` is too small or the shape is invalid, the case has no tensors
+  // and KernelBenchmark::Run() reports it as an error.
+  KernelBenchmarkCase BuildConv2D(const KernelBenchmarkConvShape& shape,
+                                  KernelBenchmarkType type,
+                                  TfLiteFusedActivation activation) {
+    conv_params_ = {};
+    conv_params_.padding = kTfLitePaddingValid;
+    conv_params_.stride_width = shape.stride;
+    conv_params_.stride_height = shape.stride;
+    conv_params_.activation = activation;
+    conv_params_.dilation_width_factor = 1;
+    conv_params_.dilation_height_factor = 1;
+    conv_params_.quantized_bias_type = kTfLiteNoType;
+    const int filter_dims[] = {4, shape.output_channels, shape.filter_height,
+                               shape.filter_width, shape.input_channels};
+    return BuildConv(shape, type, activation, filter_dims,
+                     /*channel_dim=*/0, &conv_params_,
+                     static_cast<uint64_t>(shape.filter_height) *
+                         shape.filter_width * shape.input_channels);
+  }
+
+  KernelBenchmarkCase BuildDepthwiseConv2D(
+      const KernelBenchmarkConvShape& shape, KernelBenchmarkType type,
+      TfLiteFusedActivation activation) {
+    depthwise_params_ = {};
+    depthwise_params_.padding = kTfLitePaddingValid;
+    depthwise_params_.stride_width = shape.stride;
+    depthwise_params_.stride_height = shape.stride;
+    depthwise_params_.depth_multiplier =
+        shape.input_channels > 0 ? shape.output_channels / shape.input_channels
+                                 : 0;
+    depthwise_params_.activation = activation;
+    depthwise_params_.dilation_width_factor = 1;
+    depthwise_params_.dilation_height_factor = 1;
+    const int filter_dims[] = {4, 1, shape.filter_height, shape.filter_width,
+                               shape.output_channels};
+    return BuildConv(
+        shape, type, activation, filter_dims, /*channel_dim=*/3,
+        &depthwise_params_,
+        static_cast<uint64_t>(shape.filter_height) * shape.filter_width);
+  }
+
+  KernelBenchmarkCase BuildFullyConnected(
+      const KernelBenchmarkFullyConnectedShape& shape,
+      KernelBenchmarkType type, TfLiteFusedActivation activation) {
+    fully_connected_params_ = {};
+    fully_connected_params_.activation = activation;
+    fully_connected_params_.weights_format =
+        kTfLiteFullyConnectedWeightsFormatDefault;
+    fully_connected_params_.quantized_bias_type = kTfLiteNoType;
+
+    KernelBenchmarkCase result = Begin(type, activation);
+    // "<batches>x<input_size>_<output_size>"
+    AppendName(shape.batches);
+    AppendName('x');
+    AppendName(shape.input_size);
+    AppendName('_');
+    AppendName(shape.output_size);
+    const int input_dims[] = {2, shape.batches, shape.input_size};
+    const int filter_dims[] = {2, shape.output_size, shape.input_size};
+    const int bias_dims[] = {1, shape.output_size};
+    const int output_dims[] = {2, shape.batches, shape.output_size};
+    // Fully connected kernels only support per-tensor quantized weights.
+    bool ok = AddActivation(kInput, input_dims, type) &&
+              AddWeights(kFilter, filter_dims, type, /*channels=*/1,
+                         /*channel_dim=*/0) &&
+              AddBias(bias_dims, type, /*channels=*/1) &&
+              AddActivation(kOutput, output_dims, type);
+    return End(ok, &fully_connected_params_,
+                  static_cast<uint64_t>(shape.batches) * shape.input_size *
+                      shape.output_size,
+                  result);
+  }
+
+ private:
+  enum { kInput = 0, kFilter = 1, kBias = 2, kOutput = 3, kNumTensors = 4 };
+
+  static constexpr float kInputScale = 0.5f;
+  static constexpr float kFilterScale = 0.01f;
+  static constexpr float kOutputScale = 1.0f;
+
+  KernelBenchmarkCase BuildConv(const KernelBenchmarkConvShape& shape,
+                                KernelBenchmarkType type,
+                                TfLiteFusedActivation activation,
+                                const int* filter_dims, int channel_dim,
+                                const void* builtin_data,
+                                uint64_t macs_per_output) {
+    KernelBenchmarkCase result = Begin(type, activation);
+    const int stride = shape.stride > 0 ? shape.stride : 1;
+    const int output_height = (shape.height - shape.filter_height) / stride + 1;
+    const int output_width = (shape.width - shape.filter_width) / stride + 1;
+    // "<input NHWC>_<filter HxW>x<output channels>_s<stride>"
+    const int name_values[] = {shape.batches,       shape.height,
+                               shape.width,         shape.input_channels,
+                               shape.filter_height, shape.filter_width,
+                               shape.output_channels};
+    const char name_separators[] = "xxx_xx_";
+    for (int i = 0; i < 7; ++i) {
+      AppendName(name_values[i]);
+      AppendName(name_separators[i]);
+    }
+    AppendName('s');
+    AppendName(stride);
+    const int input_dims[] = {4, shape.batches, shape.height, shape.width,
+                              shape.input_channels};
+    const int bias_dims[] = {1, shape.output_channels};
+    const int output_dims[] = {4, shape.batches, output_height, output_width,
+                               shape.output_channels};
+    bool ok = output_height > 0 && output_width > 0 &&
+              AddActivation(kInput, input_dims, type) &&
+              AddWeights(kFilter, filter_dims, type, shape.output_channels,
+                         channel_dim) &&
+              AddBias(bias_dims, type, shape.output_channels) &&
+              AddActivation(kOutput, output_dims, type);
+    return End(ok, builtin_data,
+                  static_cast<uint64_t>(shape.batches) * output_height *
+                      output_width * shape.output_channels * macs_per_output,
+                  result);
+  }
+
+  KernelBenchmarkCase Begin(KernelBenchmarkType type,
+                            TfLiteFusedActivation activation) {
+    used_ = 0;
+    seed_ = 1;
+    name_size_ = 0;
+    name_[0] = '\0';
+    memset(tensors_, 0, sizeof(tensors_));
+    KernelBenchmarkCase result = {};
+    result.type = KernelBenchmarkTypeName(type);
+    result.activation = KernelBenchmarkActivationName(activation);
+    return result;
+  }
+
+  KernelBenchmarkCase End(bool ok, const void* builtin_data, uint64_t macs,
+                          KernelBenchmarkCase result) {
+    inputs_[0] = 3;
+    inputs_[1] = kInput;
+    inputs_[2] = kFilter;
+    inputs_[3] = kBias;
+    outputs_[0] = 1;
+    outputs_[1] = kOutput;
+    result.shape = name_;
+    result.tensors_size = kNumTensors;
+    result.inputs = IntArray(inputs_);
+    result.outputs = IntArray(outputs_);
+    result.builtin_data = builtin_data;
+    result.macs = macs;
+    // KernelBenchmark::Run() reports an error for cases without tensors.
+    result.tensors = ok ? tensors_ : nullptr;
+    return result;
+  }
+
+  static TfLiteIntArray* IntArray(int* data) {
+    return reinterpret_cast<TfLiteIntArray*>(data);
+  }
+
+  void AppendName(char c) {
+    if (name_size_ + 1 < sizeof(name_)) {
+      name_[name_size_++] = c;
+      name_[name_size_] = '\0';
+    }
+  }
+
+  void AppendName(int value) {
+    char digits[10];
+    int count = 0;
+    uint32_t magnitude = value < 0 ? 0u - static_cast<uint32_t>(value)
+                                   : static_cast<uint32_t>(value);
+    if (value < 0) {
+      AppendName('-');
+    }
+    do {
+      digits[count++] = static_cast<char>('0' + magnitude % 10);
+      magnitude /= 10;
+    } while (magnitude != 0);
+    while (count > 0) {
+      AppendName(digits[--count]);
+    }
+  }
+
+  void* Allocate(size_t bytes) {
+    const size_t start = (used_ + 15) & ~static_cast<size_t>(15);
+    if (memory_ == nullptr || start > size_ || bytes > size_ - start) {
+      return nullptr;
+    }
+    used_ = start + bytes;
+    return memory_ + start;
+  }
+
+  uint32_t Random() {
+    seed_ = seed_ * 1664525u + 1013904223u;
+    return seed_ >> 8;
+  }
+
+  TfLiteIntArray* Dims(const int* dims, int* elements) {
+    TfLiteIntArray* array = static_cast<TfLiteIntArray*>(
+        Allocate(sizeof(int) * (dims[0] + 1)));
+    *elements = 1;
+    if (array == nullptr) {
+      return nullptr;
+    }
+    array->size = dims[0];
+    for (int i = 0; i < dims[0]; ++i) {
+      array->data[i] = dims[i + 1];
+      *elements *= dims[i + 1];
+    }
+    return array;
+  }
+
+  // Sets affine quantization with `channels` scales of `scale` and zero
+  // points of 0 on `tensor`.
+  bool Quantize(TfLiteTensor* tensor, int channels, float scale,
+                int channel_dim) {
+    TfLiteAffineQuantization* quantization =
+        static_cast<TfLiteAffineQuantization*>(
+            Allocate(sizeof(TfLiteAffineQuantization)));
+    TfLiteFloatArray* scales = static_cast<TfLiteFloatArray*>(
+        Allocate(sizeof(int) + sizeof(float) * channels));
+    TfLiteIntArray* zero_points = static_cast<TfLiteIntArray*>(
+        Allocate(sizeof(int) * (channels + 1)));
+    if (quantization == nullptr || scales == nullptr ||
+        zero_points == nullptr) {
+      return false;
+    }
+    scales->size = channels;
+    zero_points->size = channels;
+    for (int i = 0; i < channels; ++i) {
+      scales->data[i] = scale;
+      zero_points->data[i] = 0;
+    }
+    quantization->scale = scales;
+    quantization->zero_point = zero_points;
+    quantization->quantized_dimension = channel_dim;
+    tensor->quantization.type = kTfLiteAffineQuantization;
+    tensor->quantization.params = quantization;
+    tensor->params.scale = scale;
+    tensor->params.zero_point = 0;
+    return true;
+  }
+
+  // Input and output tensors.
+  bool AddActivation(int index, const int* dims, KernelBenchmarkType type) {
+    TfLiteTensor* tensor = &tensors_[index];
+    int elements;
+    tensor->dims = Dims(dims, &elements);
+    tensor->allocation_type = kTfLiteArenaRw;
+    switch (type) {
+      case KernelBenchmarkType::kFloat32:
+        tensor->type = kTfLiteFloat32;
+        tensor->bytes = elements * sizeof(float);
+        break;
+      case KernelBenchmarkType::kInt8:
+      case KernelBenchmarkType::kInt4:
+        tensor->type = kTfLiteInt8;
+        tensor->bytes = elements * sizeof(int8_t);
+        break;
+      case KernelBenchmarkType::kInt16x8:
+        tensor->type = kTfLiteInt16;
+        tensor->bytes = elements * sizeof(int16_t);
+        break;
+    }
+    tensor->data.data = Allocate(tensor->bytes);
+    if (tensor->dims == nullptr || tensor->data.data == nullptr) {
+      return false;
+    }
+    Fill(tensor, elements);
+    if (type == KernelBenchmarkType::kFloat32) {
+      return true;
+    }
+    return Quantize(tensor, 1,
+                    index == kInput ? kInputScale : kOutputScale, 0);
+  }
+
+  bool AddWeights(int index, const int* dims, KernelBenchmarkType type,
+                  int channels, int channel_dim) {
+    TfLiteTensor* tensor = &tensors_[index];
+    int elements;
+    tensor->dims = Dims(dims, &elements);
+    tensor->allocation_type = kTfLiteMmapRo;
+    if (type == KernelBenchmarkType::kFloat32) {
+      tensor->type = kTfLiteFloat32;
+      tensor->bytes = elements * sizeof(float);
+    } else if (type == KernelBenchmarkType::kInt4) {
+      tensor->type = kTfLiteInt4;
+      tensor->bytes = (elements + 1) / 2;
+    } else {
+      tensor->type = kTfLiteInt8;
+      tensor->bytes = elements;
+    }
+    tensor->data.data = Allocate(tensor->bytes);
+    if (tensor->dims == nullptr || tensor->data.data == nullptr) {
+      return false;
+    }
+    if (type == KernelBenchmarkType::kInt4) {
+      // Random nibbles are already valid packed int4 values.
+      for (size_t i = 0; i < tensor->bytes; ++i) {
+        tensor->data.uint8[i] = static_cast<uint8_t>(Random());
+      }
+    } else {
+      Fill(tensor, elements);
+    }
+    if (type == KernelBenchmarkType::kFloat32) {
+      return true;
+    }
+    return Quantize(tensor, channels, kFilterScale, channel_dim);
+  }
+
+  bool AddBias(const int* dims, KernelBenchmarkType type, int channels) {
+    TfLiteTensor* tensor = &tensors_[kBias];
+    int elements;
+    tensor->dims = Dims(dims, &elements);
+    tensor->allocation_type = kTfLiteMmapRo;
+    switch (type) {
+      case KernelBenchmarkType::kFloat32:
+        tensor->type = kTfLiteFloat32;
+        tensor->bytes = elements * sizeof(float);
+        break;
+      case KernelBenchmarkType::kInt8:
+      case KernelBenchmarkType::kInt4:
+        tensor->type = kTfLiteInt32;
+        tensor->bytes = elements * sizeof(int32_t);
+        break;
+      case KernelBenchmarkType::kInt16x8:
+        tensor->type = kTfLiteInt64;
+        tensor->bytes = elements * sizeof(int64_t);
+        break;
+    }
+    tensor->data.data = Allocate(tensor->bytes);
+    if (tensor->dims == nullptr || tensor->data.data == nullptr) {
+      return false;
+    }
+    Fill(tensor, elements);
+    if (type == KernelBenchmarkType::kFloat32) {
+      return true;
+    }
+    return Quantize(tensor, channels, kInputScale * kFilterScale, 0);
+  }
+
+  void Fill(TfLiteTensor* tensor, int elements) {
+    for (int i = 0; i < elements; ++i) {
+      const uint32_t r = Random();
+      switch (tensor->type) {
+        case kTfLiteFloat32:
+          tensor->data.f[i] = static_cast<float>(r & 0xffff) / 32768.0f - 1.0f;
+          break;
+        case kTfLiteInt8:
+          tensor->data.int8[i] = static_cast<int8_t>(r);
+          break;
+        case kTfLiteInt16:
+          tensor->data.i16[i] = static_cast<int16_t>(r);
+          break;
+        case kTfLiteInt32:
+          tensor->data.i32[i] = static_cast<int32_t>(r & 0xfff) - 0x800;
+          break;
+        case kTfLiteInt64:
+          tensor->data.i64[i] = static_cast<int64_t>(r & 0xfff) - 0x800;
+          break;
+        default:
+          break;
+      }
+    }
+  }
+
+  uint8_t* memory_;
+  size_t size_;
+  size_t used_;
+  uint32_t seed_;
+
+  TfLiteTensor tensors_[kNumTensors];
+  int inputs_[4];
+  int outputs_[2];
+  char name_[48];
+  size_t name_size_ = 0;
+
+  TfLiteConvParams conv_params_;
+  TfLiteDepthwiseConvParams depthwise_params_;
+  TfLiteFullyConnectedParams fully_connected_params_;
+};
+
+}  // namespace micro
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_KERNELS_KERNEL_BENCHMARK_H_
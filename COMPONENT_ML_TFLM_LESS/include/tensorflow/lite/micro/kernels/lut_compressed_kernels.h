@@ -0,0 +1,802 @@
+/* Copyright 2025 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_KERNELS_LUT_COMPRESSED_KERNELS_H_
+#define TENSORFLOW_LITE_MICRO_KERNELS_LUT_COMPRESSED_KERNELS_H_
+
+#ifdef USE_TFLM_COMPRESSION
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/compression.h"
+#include "tensorflow/lite/micro/kernels/conv.h"
+#include "tensorflow/lite/micro/kernels/depthwise_conv.h"
+#include "tensorflow/lite/micro/kernels/fully_connected.h"
+#include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/micro_context.h"
+#include "tensorflow/lite/micro/micro_log.h"
+
+namespace tflite {
+
+// int8 CONV_2D, DEPTHWISE_CONV_2D and FULLY_CONNECTED kernels that read
+// LUT compressed weights directly.
+//
+// The regular kernels decompress a compressed weight tensor as a whole into a
+// scratch buffer of its full size before the computation. The kernels here
+// decompress the weights of one output channel at a time into a tile buffer
+// and run all the MACs of that channel before the next one is decompressed.
+// The tile takes filter_height * filter_width * input_depth bytes for
+// CONV_2D, filter_height * filter_width bytes for DEPTHWISE_CONV_2D and
+// accum_depth bytes for FULLY_CONNECTED, so the working set stays small
+// enough for the cache or TCM and no full size scratch buffer is planned.
+// Every weight is still decompressed exactly once per invocation.
+//
+// The arithmetic is the one of the int8 reference kernels, so the results are
+// bit exact with the decompress-then-compute path.
+
+// Compressed weights as seen by the kernels.
+struct LutCompressedWeights {
+  const LookupTableData* lut;
+  const uint8_t* indices;  // Data of the weight tensor.
+  size_t channels;         // Number of value tables.
+};
+
+// Number of value tables of a tensor, as used by DecompressTensorToBuffer.
+inline size_t LookupTableChannels(const LookupTableData& lut,
+                                  const TfLiteIntArray* dims) {
+  if (!lut.is_per_channel_quantized) {
+    return 1;
+  }
+  return dims->data[lut.use_alternate_axis ? dims->size - 1 : 0];
+}
+
+// Returns the value table index of `element`. Indices are packed most
+// significant bit first.
+inline uint32_t LookupTableIndex(const uint8_t* indices, size_t bit_width,
+                                 size_t element) {
+  const size_t bit = element * bit_width;
+  const uint8_t* byte = indices + (bit >> 3);
+  const size_t shift = bit & 7;
+  uint32_t value = static_cast<uint32_t>(byte[0]) << 8;
+  if (shift + bit_width > 8) {
+    value |= byte[1];
+  }
+  return (value >> (16 - shift - bit_width)) & ((1u << bit_width) - 1);
+}
+
+// Decompresses `count` elements into `tile`: element `first`, then every
+// `element_stride` elements, using the value table of `channel`.
+inline void DecompressLookupTableSlice(const LutCompressedWeights& weights,
+                                       size_t first, size_t count,
+                                       size_t element_stride, size_t channel,
+                                       int8_t* tile) {
+  const LookupTableData& lut = *weights.lut;
+  const int8_t* value_table = static_cast<const int8_t*>(lut.value_table) +
+                              channel * lut.value_table_channel_stride;
+  const size_t bit_width = lut.compressed_bit_width;
+  size_t element = first;
+  for (size_t i = 0; i < count; ++i, element += element_stride) {
+    tile[i] = value_table[LookupTableIndex(weights.indices, bit_width,
+                                           element)];
+  }
+}
+
+namespace reference_integer_ops {
+
+// ConvPerChannel with LUT compressed weights. `tile` holds the weights of one
+// output channel.
+inline void ConvPerChannelLut(
+    const ConvParams& params, const int32_t* output_multiplier,
+    const int32_t* output_shift, const RuntimeShape& input_shape,
+    const int8_t* input_data, const RuntimeShape& filter_shape,
+    const LutCompressedWeights& filter, const RuntimeShape& bias_shape,
+    const int32_t* bias_data, const RuntimeShape& output_shape,
+    int8_t* output_data, int8_t* tile) {
+  const int32_t input_offset = params.input_offset;
+  const int stride_width = params.stride_width;
+  const int stride_height = params.stride_height;
+  const int dilation_width_factor = params.dilation_width_factor;
+  const int dilation_height_factor = params.dilation_height_factor;
+  const int pad_width = params.padding_values.width;
+  const int pad_height = params.padding_values.height;
+  const int32_t output_offset = params.output_offset;
+  const int32_t output_activation_min = params.quantized_activation_min;
+  const int32_t output_activation_max = params.quantized_activation_max;
+
+  TFLITE_DCHECK_LE(output_activation_min, output_activation_max);
+  TFLITE_DCHECK_EQ(input_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(filter_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 4);
+  const int batches = MatchingDim(input_shape, 0, output_shape, 0);
+  const int input_depth = input_shape.Dims(3);
+  const int output_depth = MatchingDim(filter_shape, 0, output_shape, 3);
+  if (bias_data) {
+    TFLITE_DCHECK_EQ(bias_shape.FlatSize(), output_depth);
+  }
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int filter_height = filter_shape.Dims(1);
+  const int filter_width = filter_shape.Dims(2);
+  const int filter_input_depth = filter_shape.Dims(3);
+  const int groups = input_depth / filter_input_depth;
+  TFLITE_DCHECK_NE(groups, 0);
+  const int filters_per_group = output_depth / groups;
+  TFLITE_DCHECK_NE(filters_per_group, 0);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+  const size_t filter_size =
+      static_cast<size_t>(filter_height) * filter_width * filter_input_depth;
+
+  for (int out_channel = 0; out_channel < output_depth; ++out_channel) {
+    DecompressLookupTableSlice(filter, out_channel * filter_size, filter_size,
+                               1, filter.channels > 1 ? out_channel : 0,
+                               tile);
+    const int group = out_channel / filters_per_group;
+    for (int batch = 0; batch < batches; ++batch) {
+      for (int out_y = 0; out_y < output_height; ++out_y) {
+        const int in_y_origin = (out_y * stride_height) - pad_height;
+        for (int out_x = 0; out_x < output_width; ++out_x) {
+          const int in_x_origin = (out_x * stride_width) - pad_width;
+          int32_t acc = 0;
+          for (int filter_y = 0; filter_y < filter_height; ++filter_y) {
+            const int in_y = in_y_origin + dilation_height_factor * filter_y;
+            for (int filter_x = 0; filter_x < filter_width; ++filter_x) {
+              const int in_x = in_x_origin + dilation_width_factor * filter_x;
+              if (in_x < 0 || in_x >= input_width || in_y < 0 ||
+                  in_y >= input_height) {
+                continue;
+              }
+              const int8_t* input =
+                  input_data + Offset(input_shape, batch, in_y, in_x,
+                                      group * filter_input_depth);
+              const int8_t* weights =
+                  tile + (filter_y * filter_width + filter_x) *
+                             filter_input_depth;
+              for (int in_channel = 0; in_channel < filter_input_depth;
+                   ++in_channel) {
+                acc += weights[in_channel] * (input[in_channel] + input_offset);
+              }
+            }
+          }
+          if (bias_data) {
+            acc += bias_data[out_channel];
+          }
+          acc = MultiplyByQuantizedMultiplier(
+              acc, output_multiplier[out_channel], output_shift[out_channel]);
+          acc += output_offset;
+          acc = std::max(acc, output_activation_min);
+          acc = std::min(acc, output_activation_max);
+          output_data[Offset(output_shape, batch, out_y, out_x, out_channel)] =
+              static_cast<int8_t>(acc);
+        }
+      }
+    }
+  }
+}
+
+// DepthwiseConvPerChannel with LUT compressed weights. `tile` holds the
+// filter_height * filter_width weights of one output channel.
+inline void DepthwiseConvPerChannelLut(
+    const DepthwiseParams& params, const int32_t* output_multiplier,
+    const int32_t* output_shift, const RuntimeShape& input_shape,
+    const int8_t* input_data, const RuntimeShape& filter_shape,
+    const LutCompressedWeights& filter, const RuntimeShape& bias_shape,
+    const int32_t* bias_data, const RuntimeShape& output_shape,
+    int8_t* output_data, int8_t* tile) {
+  const int stride_width = params.stride_width;
+  const int stride_height = params.stride_height;
+  const int dilation_width_factor = params.dilation_width_factor;
+  const int dilation_height_factor = params.dilation_height_factor;
+  const int pad_width = params.padding_values.width;
+  const int pad_height = params.padding_values.height;
+  const int depth_multiplier = params.depth_multiplier;
+  const int32_t input_offset = params.input_offset;
+  const int32_t output_offset = params.output_offset;
+  const int32_t output_activation_min = params.quantized_activation_min;
+  const int32_t output_activation_max = params.quantized_activation_max;
+
+  TFLITE_DCHECK_EQ(input_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(filter_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_LE(output_activation_min, output_activation_max);
+  const int batches = MatchingDim(input_shape, 0, output_shape, 0);
+  const int output_depth = MatchingDim(filter_shape, 3, output_shape, 3);
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int input_depth = input_shape.Dims(3);
+  const int filter_height = filter_shape.Dims(1);
+  const int filter_width = filter_shape.Dims(2);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+  TFLITE_DCHECK_EQ(output_depth, input_depth * depth_multiplier);
+  TFLITE_DCHECK_EQ(bias_shape.FlatSize(), output_depth);
+
+  for (int in_channel = 0; in_channel < input_depth; ++in_channel) {
+    for (int m = 0; m < depth_multiplier; ++m) {
+      const int output_channel = m + in_channel * depth_multiplier;
+      // The weights of a channel are output_depth elements apart.
+      DecompressLookupTableSlice(filter, output_channel,
+                                 filter_height * filter_width, output_depth,
+                                 filter.channels > 1 ? output_channel : 0,
+                                 tile);
+      for (int batch = 0; batch < batches; ++batch) {
+        for (int out_y = 0; out_y < output_height; ++out_y) {
+          const int in_y_origin = (out_y * stride_height) - pad_height;
+          for (int out_x = 0; out_x < output_width; ++out_x) {
+            const int in_x_origin = (out_x * stride_width) - pad_width;
+            int32_t acc = 0;
+            for (int filter_y = 0; filter_y < filter_height; ++filter_y) {
+              const int in_y = in_y_origin + dilation_height_factor * filter_y;
+              for (int filter_x = 0; filter_x < filter_width; ++filter_x) {
+                const int in_x =
+                    in_x_origin + dilation_width_factor * filter_x;
+                if (in_x < 0 || in_x >= input_width || in_y < 0 ||
+                    in_y >= input_height) {
+                  continue;
+                }
+                const int32_t input_val = input_data[Offset(
+                    input_shape, batch, in_y, in_x, in_channel)];
+                const int32_t filter_val =
+                    tile[filter_y * filter_width + filter_x];
+                acc += filter_val * (input_val + input_offset);
+              }
+            }
+            if (bias_data) {
+              acc += bias_data[output_channel];
+            }
+            acc = MultiplyByQuantizedMultiplier(
+                acc, output_multiplier[output_channel],
+                output_shift[output_channel]);
+            acc += output_offset;
+            acc = std::max(acc, output_activation_min);
+            acc = std::min(acc, output_activation_max);
+            output_data[Offset(output_shape, batch, out_y, out_x,
+                               output_channel)] = static_cast<int8_t>(acc);
+          }
+        }
+      }
+    }
+  }
+}
+
+// FullyConnected with LUT compressed weights. Uses the per channel output
+// multipliers if `output_multiplier` isn't null, params.output_multiplier and
+// params.weights_offset otherwise. `tile` holds accum_depth weights.
+inline void FullyConnectedLut(
+    const FullyConnectedParams& params, const int32_t* output_multiplier,
+    const int32_t* output_shift, const RuntimeShape& input_shape,
+    const int8_t* input_data, const RuntimeShape& filter_shape,
+    const LutCompressedWeights& filter, const RuntimeShape& bias_shape,
+    const int32_t* bias_data, const RuntimeShape& output_shape,
+    int8_t* output_data, int8_t* tile) {
+  const int32_t input_offset = params.input_offset;
+  const int32_t filter_offset =
+      output_multiplier == nullptr ? params.weights_offset : 0;
+  const int32_t output_offset = params.output_offset;
+  const int32_t output_activation_min = params.quantized_activation_min;
+  const int32_t output_activation_max = params.quantized_activation_max;
+  TFLITE_DCHECK_GE(filter_shape.DimensionsCount(), 2);
+  TFLITE_DCHECK_GE(output_shape.DimensionsCount(), 1);
+  TFLITE_DCHECK_LE(output_activation_min, output_activation_max);
+
+  const int filter_dim_count = filter_shape.DimensionsCount();
+  const int output_dim_count = output_shape.DimensionsCount();
+  const int batches = FlatSizeSkipDim(output_shape, output_dim_count - 1);
+  const int output_depth = output_shape.Dims(output_dim_count - 1);
+  TFLITE_DCHECK_LE(output_depth, filter_shape.Dims(filter_dim_count - 2));
+  const int accum_depth = filter_shape.Dims(filter_dim_count - 1);
+  TFLITE_DCHECK_EQ(input_shape.FlatSize(), batches * accum_depth);
+  TFLITE_DCHECK(bias_data == nullptr || bias_shape.FlatSize() == output_depth);
+
+  for (int out_c = 0; out_c < output_depth; ++out_c) {
+    DecompressLookupTableSlice(filter, static_cast<size_t>(out_c) * accum_depth,
+                               accum_depth, 1,
+                               filter.channels > 1 ? out_c : 0, tile);
+    for (int b = 0; b < batches; ++b) {
+      const int8_t* input = input_data + b * accum_depth;
+      int32_t acc = 0;
+      for (int d = 0; d < accum_depth; ++d) {
+        acc += (tile[d] + filter_offset) * (input[d] + input_offset);
+      }
+      if (bias_data) {
+        acc += bias_data[out_c];
+      }
+      int32_t acc_scaled =
+          output_multiplier != nullptr
+              ? MultiplyByQuantizedMultiplier(acc, output_multiplier[out_c],
+                                              output_shift[out_c])
+              : MultiplyByQuantizedMultiplier(acc, params.output_multiplier,
+                                              params.output_shift);
+      acc_scaled += output_offset;
+      acc_scaled = std::max(acc_scaled, output_activation_min);
+      acc_scaled = std::min(acc_scaled, output_activation_max);
+      output_data[out_c + output_depth * b] = static_cast<int8_t>(acc_scaled);
+    }
+  }
+}
+
+}  // namespace reference_integer_ops
+
+namespace lut_compressed_kernels {
+
+// Per node data. Nodes whose weights can't be decompressed by channel run the
+// wrapped kernel with its own user data.
+template <typename OpData>
+struct KernelData {
+  void* wrapped_user_data;
+  bool fused;
+  LutCompressedWeights weights;
+  int tile_scratch_index;
+  int bias_scratch_index;
+  OpData op_data;
+};
+
+enum Slot {
+  kConv2DSlot,
+  kDepthwiseConv2DSlot,
+  kFullyConnectedSlot,
+};
+
+template <int kSlot>
+TFLMRegistration& Wrapped() {
+  static TFLMRegistration registration = {};
+  return registration;
+}
+
+template <int kSlot, typename OpData>
+void* Init(TfLiteContext* context, const char* buffer, size_t length) {
+  TFLITE_DCHECK(context->AllocatePersistentBuffer != nullptr);
+  auto* data = static_cast<KernelData<OpData>*>(
+      context->AllocatePersistentBuffer(context, sizeof(KernelData<OpData>)));
+  if (data == nullptr) {
+    return nullptr;
+  }
+  data->wrapped_user_data = Wrapped<kSlot>().init != nullptr
+                                ? Wrapped<kSlot>().init(context, buffer, length)
+                                : nullptr;
+  data->fused = false;
+  return data;
+}
+
+// Free and Reset of the wrapped kernel, on its own user data.
+template <int kSlot, typename OpData>
+void Free(TfLiteContext* context, void* buffer) {
+  auto* data = static_cast<KernelData<OpData>*>(buffer);
+  if (data != nullptr) {
+    Wrapped<kSlot>().free(context, data->wrapped_user_data);
+  }
+}
+
+template <int kSlot, typename OpData>
+void Reset(TfLiteContext* context, void* buffer) {
+  auto* data = static_cast<KernelData<OpData>*>(buffer);
+  if (data != nullptr) {
+    Wrapped<kSlot>().reset(context, data->wrapped_user_data);
+  }
+}
+
+// Runs `function` of the wrapped kernel on its own user data.
+template <typename OpData>
+TfLiteStatus RunWrapped(TfLiteStatus (*function)(TfLiteContext*, TfLiteNode*),
+                        TfLiteContext* context, TfLiteNode* node) {
+  auto* data = static_cast<KernelData<OpData>*>(node->user_data);
+  node->user_data = data->wrapped_user_data;
+  const TfLiteStatus status = function(context, node);
+  node->user_data = data;
+  return status;
+}
+
+// Deallocates the temporary tensors that were allocated.
+inline void DeallocateTempTensors(MicroContext* micro_context,
+                                  TfLiteTensor* const* tensors, int count) {
+  for (int i = 0; i < count; ++i) {
+    if (tensors[i] != nullptr) {
+      micro_context->DeallocateTempTfLiteTensor(tensors[i]);
+    }
+  }
+}
+
+// Checks whether the weights of the node can be decompressed by channel and
+// fills in data->weights if so. `alternate_axis` tells whether the output
+// channel is the last dimension of the weights.
+template <typename OpData>
+TfLiteStatus PrepareWeights(TfLiteContext* context, TfLiteNode* node,
+                            int input_index, int weights_index,
+                            bool alternate_axis, KernelData<OpData>* data) {
+  MicroContext* micro_context = GetMicroContext(context);
+  data->fused = false;
+  const CompressionTensorData* compression =
+      micro_context->GetTensorCompressionData(node, weights_index);
+  if (compression == nullptr ||
+      compression->scheme != CompressionScheme::kBinQuant) {
+    return kTfLiteOk;
+  }
+  TfLiteTensor* const tensors[] = {
+      micro_context->AllocateTempInputTensor(node, input_index),
+      micro_context->AllocateTempInputTensor(node, weights_index)};
+  const TfLiteTensor* input = tensors[0];
+  const TfLiteTensor* filter = tensors[1];
+  if (input != nullptr && filter != nullptr) {
+    const LookupTableData& lut = *compression->data.lut_data;
+    const size_t channels = LookupTableChannels(lut, filter->dims);
+    data->fused = input->type == kTfLiteInt8 && filter->type == kTfLiteInt8 &&
+                  (channels == 1 || lut.use_alternate_axis == alternate_axis);
+    data->weights.lut = &lut;
+    data->weights.indices = nullptr;  // Set at Eval.
+    data->weights.channels = channels;
+  }
+  DeallocateTempTensors(micro_context, tensors, 2);
+  TF_LITE_ENSURE(context, input != nullptr && filter != nullptr);
+  return kTfLiteOk;
+}
+
+// Prepare of a fused CONV_2D on the temporary tensors allocated by the
+// caller, which also deallocates them.
+inline TfLiteStatus PrepareFusedConv2D(TfLiteContext* context,
+                                       TfLiteNode* node,
+                                       const TfLiteTensor* input,
+                                       const TfLiteTensor* filter,
+                                       const TfLiteTensor* output,
+                                       KernelData<OpDataConv>* data) {
+  TF_LITE_ENSURE(context, input != nullptr);
+  TF_LITE_ENSURE(context, filter != nullptr);
+  TF_LITE_ENSURE(context, output != nullptr);
+  TFLITE_DCHECK(node->builtin_data != nullptr);
+  const auto& params =
+      *(static_cast<const TfLiteConvParams*>(node->builtin_data));
+  MicroContext* micro_context = GetMicroContext(context);
+
+  const int num_channels = filter->dims->data[kConvQuantizedDimension];
+  data->op_data.per_channel_output_multiplier =
+      static_cast<int32_t*>(context->AllocatePersistentBuffer(
+          context, num_channels * sizeof(int32_t)));
+  data->op_data.per_channel_output_shift =
+      static_cast<int32_t*>(context->AllocatePersistentBuffer(
+          context, num_channels * sizeof(int32_t)));
+  TF_LITE_ENSURE(context,
+                 data->op_data.per_channel_output_multiplier != nullptr &&
+                     data->op_data.per_channel_output_shift != nullptr);
+  TF_LITE_ENSURE_STATUS(CalculateOpDataConv(
+      context, node, params, input->dims->data[2], input->dims->data[1],
+      filter->dims->data[2], filter->dims->data[1], output->dims->data[2],
+      output->dims->data[1], input->type, &data->op_data));
+
+  const size_t tile_bytes = static_cast<size_t>(filter->dims->data[1]) *
+                            filter->dims->data[2] * filter->dims->data[3];
+  TF_LITE_ENSURE_STATUS(context->RequestScratchBufferInArena(
+      context, tile_bytes, &data->tile_scratch_index));
+  data->bias_scratch_index =
+      micro_context->AllocateDecompressionScratchBuffer(node, kConvBiasTensor);
+  return kTfLiteOk;
+}
+
+inline TfLiteStatus PrepareConv2D(TfLiteContext* context, TfLiteNode* node) {
+  using Data = KernelData<OpDataConv>;
+  Data* data = static_cast<Data*>(node->user_data);
+  TF_LITE_ENSURE_STATUS(PrepareWeights(context, node, kConvInputTensor,
+                                       kConvWeightsTensor, false, data));
+  if (!data->fused) {
+    return RunWrapped<OpDataConv>(Wrapped<kConv2DSlot>().prepare, context,
+                                  node);
+  }
+
+  MicroContext* micro_context = GetMicroContext(context);
+  TfLiteTensor* const tensors[] = {
+      micro_context->AllocateTempInputTensor(node, kConvInputTensor),
+      micro_context->AllocateTempInputTensor(node, kConvWeightsTensor),
+      micro_context->AllocateTempOutputTensor(node, kConvOutputTensor)};
+  const TfLiteStatus status = PrepareFusedConv2D(
+      context, node, tensors[0], tensors[1], tensors[2], data);
+  DeallocateTempTensors(micro_context, tensors, 3);
+  return status;
+}
+
+inline TfLiteStatus EvalConv2D(TfLiteContext* context, TfLiteNode* node) {
+  using Data = KernelData<OpDataConv>;
+  Data* data = static_cast<Data*>(node->user_data);
+  if (!data->fused) {
+    return RunWrapped<OpDataConv>(Wrapped<kConv2DSlot>().invoke, context,
+                                  node);
+  }
+  const auto& params =
+      *(static_cast<const TfLiteConvParams*>(node->builtin_data));
+  MicroContext* micro_context = GetMicroContext(context);
+  const TfLiteEvalTensor* input =
+      micro::GetEvalInput(context, node, kConvInputTensor);
+  const TfLiteEvalTensor* filter =
+      micro::GetEvalInput(context, node, kConvWeightsTensor);
+  const TfLiteEvalTensor* bias =
+      NumInputs(node) == 3 ? micro::GetEvalInput(context, node, kConvBiasTensor)
+                           : nullptr;
+  TfLiteEvalTensor* output =
+      micro::GetEvalOutput(context, node, kConvOutputTensor);
+
+  data->weights.indices = micro::GetTensorData<uint8_t>(filter);
+  const OpDataConv& op_data = data->op_data;
+  reference_integer_ops::ConvPerChannelLut(
+      ConvParamsQuantized(params, op_data),
+      op_data.per_channel_output_multiplier, op_data.per_channel_output_shift,
+      micro::GetTensorShape(input), micro::GetTensorData<int8_t>(input),
+      micro::GetTensorShape(filter), data->weights,
+      micro::GetTensorShape(bias),
+      micro::GetOptionalTensorData<int32_t>(
+          micro_context, bias,
+          micro_context->GetTensorCompressionData(node, kConvBiasTensor),
+          data->bias_scratch_index),
+      micro::GetTensorShape(output), micro::GetTensorData<int8_t>(output),
+      static_cast<int8_t*>(
+          context->GetScratchBuffer(context, data->tile_scratch_index)));
+  return kTfLiteOk;
+}
+
+// Prepare of a fused DEPTHWISE_CONV_2D on the temporary tensors allocated by
+// the caller, which also deallocates them.
+inline TfLiteStatus PrepareFusedDepthwiseConv2D(
+    TfLiteContext* context, TfLiteNode* node, const TfLiteTensor* input,
+    const TfLiteTensor* filter, const TfLiteTensor* output,
+    KernelData<OpDataConv>* data) {
+  TF_LITE_ENSURE(context, input != nullptr);
+  TF_LITE_ENSURE(context, filter != nullptr);
+  TF_LITE_ENSURE(context, output != nullptr);
+  TFLITE_DCHECK(node->builtin_data != nullptr);
+  const auto& params =
+      *(static_cast<const TfLiteDepthwiseConvParams*>(node->builtin_data));
+  MicroContext* micro_context = GetMicroContext(context);
+
+  const int num_channels =
+      filter->dims->data[kDepthwiseConvQuantizedDimension];
+  data->op_data.per_channel_output_multiplier =
+      static_cast<int32_t*>(context->AllocatePersistentBuffer(
+          context, num_channels * sizeof(int32_t)));
+  data->op_data.per_channel_output_shift =
+      static_cast<int32_t*>(context->AllocatePersistentBuffer(
+          context, num_channels * sizeof(int32_t)));
+  TF_LITE_ENSURE(context,
+                 data->op_data.per_channel_output_multiplier != nullptr &&
+                     data->op_data.per_channel_output_shift != nullptr);
+  TF_LITE_ENSURE_STATUS(CalculateOpDataDepthwiseConv(
+      context, node, params, input->dims->data[2], input->dims->data[1],
+      filter->dims->data[2], filter->dims->data[1], output->dims->data[2],
+      output->dims->data[1], input->type, &data->op_data));
+
+  const size_t tile_bytes =
+      static_cast<size_t>(filter->dims->data[1]) * filter->dims->data[2];
+  TF_LITE_ENSURE_STATUS(context->RequestScratchBufferInArena(
+      context, tile_bytes, &data->tile_scratch_index));
+  data->bias_scratch_index = micro_context->AllocateDecompressionScratchBuffer(
+      node, kDepthwiseConvBiasTensor);
+  return kTfLiteOk;
+}
+
+inline TfLiteStatus PrepareDepthwiseConv2D(TfLiteContext* context,
+                                           TfLiteNode* node) {
+  using Data = KernelData<OpDataConv>;
+  Data* data = static_cast<Data*>(node->user_data);
+  TF_LITE_ENSURE_STATUS(PrepareWeights(context, node, kDepthwiseConvInputTensor,
+                                       kDepthwiseConvWeightsTensor, true,
+                                       data));
+  if (!data->fused) {
+    return RunWrapped<OpDataConv>(Wrapped<kDepthwiseConv2DSlot>().prepare,
+                                  context, node);
+  }
+
+  MicroContext* micro_context = GetMicroContext(context);
+  TfLiteTensor* const tensors[] = {
+      micro_context->AllocateTempInputTensor(node, kDepthwiseConvInputTensor),
+      micro_context->AllocateTempInputTensor(node, kDepthwiseConvWeightsTensor),
+      micro_context->AllocateTempOutputTensor(node,
+                                              kDepthwiseConvOutputTensor)};
+  const TfLiteStatus status = PrepareFusedDepthwiseConv2D(
+      context, node, tensors[0], tensors[1], tensors[2], data);
+  DeallocateTempTensors(micro_context, tensors, 3);
+  return status;
+}
+
+inline TfLiteStatus EvalDepthwiseConv2D(TfLiteContext* context,
+                                        TfLiteNode* node) {
+  using Data = KernelData<OpDataConv>;
+  Data* data = static_cast<Data*>(node->user_data);
+  if (!data->fused) {
+    return RunWrapped<OpDataConv>(Wrapped<kDepthwiseConv2DSlot>().invoke,
+                                  context, node);
+  }
+  const auto& params =
+      *(static_cast<const TfLiteDepthwiseConvParams*>(node->builtin_data));
+  MicroContext* micro_context = GetMicroContext(context);
+  const TfLiteEvalTensor* input =
+      micro::GetEvalInput(context, node, kDepthwiseConvInputTensor);
+  const TfLiteEvalTensor* filter =
+      micro::GetEvalInput(context, node, kDepthwiseConvWeightsTensor);
+  const TfLiteEvalTensor* bias =
+      NumInputs(node) == 3
+          ? micro::GetEvalInput(context, node, kDepthwiseConvBiasTensor)
+          : nullptr;
+  TfLiteEvalTensor* output =
+      micro::GetEvalOutput(context, node, kDepthwiseConvOutputTensor);
+
+  data->weights.indices = micro::GetTensorData<uint8_t>(filter);
+  const OpDataConv& op_data = data->op_data;
+  reference_integer_ops::DepthwiseConvPerChannelLut(
+      DepthwiseConvParamsQuantized(params, op_data),
+      op_data.per_channel_output_multiplier, op_data.per_channel_output_shift,
+      micro::GetTensorShape(input), micro::GetTensorData<int8_t>(input),
+      micro::GetTensorShape(filter), data->weights,
+      micro::GetTensorShape(bias),
+      micro::GetOptionalTensorData<int32_t>(
+          micro_context, bias,
+          micro_context->GetTensorCompressionData(node,
+                                                  kDepthwiseConvBiasTensor),
+          data->bias_scratch_index),
+      micro::GetTensorShape(output), micro::GetTensorData<int8_t>(output),
+      static_cast<int8_t*>(
+          context->GetScratchBuffer(context, data->tile_scratch_index)));
+  return kTfLiteOk;
+}
+
+// Prepare of a fused FULLY_CONNECTED on the temporary tensors allocated by
+// the caller, which also deallocates them. `bias` is optional.
+inline TfLiteStatus PrepareFusedFullyConnected(
+    TfLiteContext* context, TfLiteNode* node, TfLiteTensor* input,
+    TfLiteTensor* filter, TfLiteTensor* bias, TfLiteTensor* output,
+    KernelData<OpDataFullyConnected>* data) {
+  TF_LITE_ENSURE(context, input != nullptr);
+  TF_LITE_ENSURE(context, filter != nullptr);
+  TF_LITE_ENSURE(context, output != nullptr);
+  TFLITE_DCHECK(node->builtin_data != nullptr);
+  const auto* params =
+      static_cast<const TfLiteFullyConnectedParams*>(node->builtin_data);
+  MicroContext* micro_context = GetMicroContext(context);
+
+  TF_LITE_ENSURE_STATUS(CalculateOpDataFullyConnected(
+      context, params->activation, input->type, input, filter, bias, output,
+      &data->op_data));
+
+  const size_t tile_bytes = filter->dims->data[filter->dims->size - 1];
+  TF_LITE_ENSURE_STATUS(context->RequestScratchBufferInArena(
+      context, tile_bytes, &data->tile_scratch_index));
+  data->bias_scratch_index = micro_context->AllocateDecompressionScratchBuffer(
+      node, kFullyConnectedBiasTensor);
+  return kTfLiteOk;
+}
+
+inline TfLiteStatus PrepareFullyConnected(TfLiteContext* context,
+                                          TfLiteNode* node) {
+  using Data = KernelData<OpDataFullyConnected>;
+  Data* data = static_cast<Data*>(node->user_data);
+  TF_LITE_ENSURE_STATUS(PrepareWeights(context, node,
+                                       kFullyConnectedInputTensor,
+                                       kFullyConnectedWeightsTensor, false,
+                                       data));
+  if (!data->fused) {
+    return RunWrapped<OpDataFullyConnected>(
+        Wrapped<kFullyConnectedSlot>().prepare, context, node);
+  }
+
+  MicroContext* micro_context = GetMicroContext(context);
+  TfLiteTensor* const tensors[] = {
+      micro_context->AllocateTempInputTensor(node, kFullyConnectedInputTensor),
+      micro_context->AllocateTempInputTensor(node,
+                                             kFullyConnectedWeightsTensor),
+      micro_context->AllocateTempInputTensor(node, kFullyConnectedBiasTensor),
+      micro_context->AllocateTempOutputTensor(node,
+                                              kFullyConnectedOutputTensor)};
+  const TfLiteStatus status =
+      PrepareFusedFullyConnected(context, node, tensors[0], tensors[1],
+                                 tensors[2], tensors[3], data);
+  DeallocateTempTensors(micro_context, tensors, 4);
+  return status;
+}
+
+inline TfLiteStatus EvalFullyConnected(TfLiteContext* context,
+                                       TfLiteNode* node) {
+  using Data = KernelData<OpDataFullyConnected>;
+  Data* data = static_cast<Data*>(node->user_data);
+  if (!data->fused) {
+    return RunWrapped<OpDataFullyConnected>(
+        Wrapped<kFullyConnectedSlot>().invoke, context, node);
+  }
+  MicroContext* micro_context = GetMicroContext(context);
+  const TfLiteEvalTensor* input =
+      micro::GetEvalInput(context, node, kFullyConnectedInputTensor);
+  const TfLiteEvalTensor* filter =
+      micro::GetEvalInput(context, node, kFullyConnectedWeightsTensor);
+  const TfLiteEvalTensor* bias =
+      micro::GetEvalInput(context, node, kFullyConnectedBiasTensor);
+  TfLiteEvalTensor* output =
+      micro::GetEvalOutput(context, node, kFullyConnectedOutputTensor);
+
+  data->weights.indices = micro::GetTensorData<uint8_t>(filter);
+  const OpDataFullyConnected& op_data = data->op_data;
+  reference_integer_ops::FullyConnectedLut(
+      FullyConnectedParamsQuantized(op_data),
+      op_data.is_per_channel ? op_data.per_channel_output_multiplier : nullptr,
+      op_data.is_per_channel ? op_data.per_channel_output_shift : nullptr,
+      micro::GetTensorShape(input), micro::GetTensorData<int8_t>(input),
+      micro::GetTensorShape(filter), data->weights,
+      micro::GetTensorShape(bias),
+      micro::GetOptionalTensorData<int32_t>(
+          micro_context, bias,
+          micro_context->GetTensorCompressionData(node,
+                                                  kFullyConnectedBiasTensor),
+          data->bias_scratch_index),
+      micro::GetTensorShape(output), micro::GetTensorData<int8_t>(output),
+      static_cast<int8_t*>(
+          context->GetScratchBuffer(context, data->tile_scratch_index)));
+  return kTfLiteOk;
+}
+
+template <int kSlot, typename OpData>
+TFLMRegistration Wrap(const TFLMRegistration& registration,
+                      TfLiteStatus (*prepare)(TfLiteContext*, TfLiteNode*),
+                      TfLiteStatus (*invoke)(TfLiteContext*, TfLiteNode*)) {
+  Wrapped<kSlot>() = registration;
+  TFLMRegistration wrapper = registration;
+  wrapper.init = Init<kSlot, OpData>;
+  wrapper.prepare = prepare;
+  wrapper.invoke = invoke;
+  wrapper.free =
+      registration.free != nullptr ? Free<kSlot, OpData> : nullptr;
+  wrapper.reset =
+      registration.reset != nullptr ? Reset<kSlot, OpData> : nullptr;
+  return wrapper;
+}
+
+}  // namespace lut_compressed_kernels
+
+// Registrations that run int8 layers with LUT compressed weights on the
+// per channel kernels above. All other layers run `registration`, which must
+// be the kernel these registrations are used in place of:
+//
+//   op_resolver.AddConv2D(tflite::Register_CONV_2D_LUT());
+//   op_resolver.AddFullyConnected(tflite::Register_FULLY_CONNECTED_LUT());
+//
+// The last wrapped registration of each operator is used by all
+// interpreters.
+inline TFLMRegistration Register_CONV_2D_LUT(
+    const TFLMRegistration& registration = Register_CONV_2D()) {
+  return lut_compressed_kernels::Wrap<lut_compressed_kernels::kConv2DSlot,
+                                      OpDataConv>(
+      registration, lut_compressed_kernels::PrepareConv2D,
+      lut_compressed_kernels::EvalConv2D);
+}
+
+inline TFLMRegistration Register_DEPTHWISE_CONV_2D_LUT(
+    const TFLMRegistration& registration = Register_DEPTHWISE_CONV_2D()) {
+  return lut_compressed_kernels::Wrap<
+      lut_compressed_kernels::kDepthwiseConv2DSlot, OpDataConv>(
+      registration, lut_compressed_kernels::PrepareDepthwiseConv2D,
+      lut_compressed_kernels::EvalDepthwiseConv2D);
+}
+
+inline TFLMRegistration Register_FULLY_CONNECTED_LUT(
+    const TFLMRegistration& registration = Register_FULLY_CONNECTED()) {
+  return lut_compressed_kernels::Wrap<
+      lut_compressed_kernels::kFullyConnectedSlot, OpDataFullyConnected>(
+      registration, lut_compressed_kernels::PrepareFullyConnected,
+      lut_compressed_kernels::EvalFullyConnected);
+}
+
+}  // namespace tflite
+
+#endif  // USE_TFLM_COMPRESSION
+
+#endif  // TENSORFLOW_LITE_MICRO_KERNELS_LUT_COMPRESSED_KERNELS_H_
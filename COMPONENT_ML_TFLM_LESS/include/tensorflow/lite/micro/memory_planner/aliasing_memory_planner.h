@@ -0,0 +1,213 @@
+/* Copyright 2025 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_ALIASING_MEMORY_PLANNER_H_
+#define TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_ALIASING_MEMORY_PLANNER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/compatibility.h"
+#include "tensorflow/lite/micro/flatbuffer_utils.h"
+#include "tensorflow/lite/micro/memory_planner/micro_memory_planner.h"
+#include "tensorflow/lite/micro/memory_planner/recording_memory_planner.h"
+#include "tensorflow/lite/micro/micro_log.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+
+/*   This is an experimental feature and subjected to change.
+ *
+The AliasingMemoryPlanner lets element-wise operators execute in place: the
+output of an operator is planned at the same offset as its first input when that
+input dies at the operator. In activation chains like CONV_2D -> ADD -> RELU ->
+QUANTIZE this removes one live buffer per element-wise operator.
+
+The MicroAllocator only passes sizes and lifetimes to the memory planner, so
+this planner wraps another planner and uses the model flatbuffer to find out
+which planner buffer belongs to which tensor (see recording_memory_planner.h).
+Aliasing is only applied when that mapping is verified against the buffers the
+MicroAllocator actually adds (buffer count and sizes); otherwise every buffer
+is forwarded unchanged, so a mismatch can cost memory but never correctness.
+
+An output aliases its input only if:
+ - the operator was declared in-place safe with AllowInPlace() or
+   AllowInPlaceOps(),
+ - the operator has a single output,
+ - the input is not a constant, a variable or a subgraph output,
+ - the input is last used by this operator, and
+ - input and output have exactly the same size in bytes.
+
+An in-place safe operator must produce element i of its output only from
+element i of the aliased input (plus any other inputs), and must read that
+element before writing it. The kernels are compiled into the runtime library,
+so the declaration is made per builtin operator by the application rather than
+by the kernels' Prepare. Nothing is declared by default: whether an operator is
+safe depends on the kernel the resolver links for it. The reference and
+CMSIS-NN kernels of these operators meet the requirement:
+
+  ABS, ADD, ELU, EXPAND_DIMS, HARD_SWISH, LEAKY_RELU, LOGISTIC, MUL, NEG,
+  QUANTIZE, RELU, RELU6, RELU_0_TO_1, RELU_N1_TO_1, RESHAPE, SQUEEZE, SUB, TANH
+
+Operators run by an accelerator, such as the NNLite kernels, stream their
+inputs and outputs independently and must not be declared unless their kernel
+is known to be safe.
+
+Example:
+
+  tflite::GreedyMemoryPlanner greedy;
+  tflite::AliasingMemoryPlanner planner(&greedy, model);
+  constexpr tflite::BuiltinOperator kInPlaceOps[] = {
+      tflite::BuiltinOperator_RELU, tflite::BuiltinOperator_RESHAPE,
+      tflite::BuiltinOperator_QUANTIZE};
+  planner.AllowInPlaceOps(kInPlaceOps, 3);
+  tflite::MicroAllocator* allocator =
+      tflite::MicroAllocator::Create(arena, arena_size, &planner);
+
+Only models with a single subgraph and no offline planned buffers are aliased.
+*/
+class AliasingMemoryPlanner : public RecordingMemoryPlanner {
+ public:
+  // Does not take ownership of planner or model, which must outlive this
+  // object.
+  AliasingMemoryPlanner(MicroMemoryPlanner* planner, const Model* model)
+      : RecordingMemoryPlanner(planner, model, "aliasing"),
+        aliased_buffer_count_(0) {
+    for (uint32_t& word : in_place_ops_) {
+      word = 0;
+    }
+  }
+  ~AliasingMemoryPlanner() override {}
+
+  // Declares that `op` can write its output over its first non-constant input.
+  void AllowInPlace(BuiltinOperator op) {
+    const int code = static_cast<int>(op);
+    if (code >= 0 && code <= BuiltinOperator_MAX) {
+      in_place_ops_[code / 32] |= 1u << (code % 32);
+    }
+  }
+
+  // Declares the `count` operators of `ops` in-place safe, see above.
+  void AllowInPlaceOps(const BuiltinOperator* ops, int count) {
+    for (int i = 0; i < count; ++i) {
+      AllowInPlace(ops[i]);
+    }
+  }
+
+  bool IsInPlaceAllowed(BuiltinOperator op) const {
+    const int code = static_cast<int>(op);
+    return code >= 0 && code <= BuiltinOperator_MAX &&
+           (in_place_ops_[code / 32] & (1u << (code % 32))) != 0;
+  }
+
+  TfLiteStatus Init(unsigned char* scratch_buffer,
+                    int scratch_buffer_size) override {
+    aliased_buffer_count_ = 0;
+    return RecordingMemoryPlanner::Init(scratch_buffer, scratch_buffer_size);
+  }
+
+  bool preserves_all_tensors() const override {
+    // Aliasing overwrites inputs, so this never preserves all tensors.
+    return false;
+  }
+
+  void PrintMemoryPlan() override {
+    MicroPrintf("Aliasing planner: %d of %d buffers planned in place",
+                aliased_buffer_count_, buffer_count_);
+    planner_->PrintMemoryPlan();
+  }
+
+  // Number of buffers planned at the offset of another buffer.
+  int GetAliasedBufferCount() {
+    ForwardBuffersIfNeeded();
+    return aliased_buffer_count_;
+  }
+
+ private:
+  int RootOf(int buffer) const {
+    while (records_[buffer].root >= 0) {
+      buffer = records_[buffer].root;
+    }
+    return buffer;
+  }
+
+  // Marks the outputs of in-place operators as aliases of their input. The
+  // root buffer of an alias chain lives on until the last alias dies.
+  TfLiteStatus PlanBuffers() override {
+    aliased_buffer_count_ = 0;
+    if (!HasSingleSubgraph() || !MapTensorsToBuffers()) {
+      return kTfLiteOk;
+    }
+    const SubGraph* subgraph = model_->subgraphs()->Get(0);
+    const auto* operators = subgraph->operators();
+    if (operators == nullptr) {
+      return kTfLiteOk;
+    }
+    const auto* tensors = subgraph->tensors();
+    for (const Operator* op : *operators) {
+      if (!IsInPlaceAllowed(FlatbufferOperatorBuiltinCode(model_, op)) ||
+          op->inputs() == nullptr || op->outputs() == nullptr ||
+          op->outputs()->size() != 1) {
+        continue;
+      }
+      const int output = op->outputs()->Get(0);
+      if (BufferOf(output) < 0) {
+        continue;
+      }
+      // The first input that's planned in the arena is the aliasing candidate.
+      int input = -1;
+      for (int32_t candidate : *op->inputs()) {
+        if (BufferOf(candidate) >= 0) {
+          input = candidate;
+          break;
+        }
+      }
+      if (input < 0 || input == output ||
+          FlatbufferVectorContains(subgraph->outputs(), input) ||
+          FlatbufferTensorBytes(tensors->Get(input)) !=
+              FlatbufferTensorBytes(tensors->Get(output))) {
+        continue;
+      }
+      BufferRecord& input_record = records_[BufferOf(input)];
+      BufferRecord& output_record = records_[BufferOf(output)];
+      if (input_record.last_time_used != output_record.first_time_used ||
+          output_record.root >= 0) {
+        continue;
+      }
+      // The input's buffer now lives on until the output dies.
+      const int root = RootOf(BufferOf(input));
+      output_record.root = root;
+      if (output_record.last_time_used >
+          records_[root].planned_last_time_used) {
+        records_[root].planned_last_time_used = output_record.last_time_used;
+      }
+      ++aliased_buffer_count_;
+    }
+    return kTfLiteOk;
+  }
+
+  // Bit set of builtin operators declared in-place safe.
+  uint32_t in_place_ops_[BuiltinOperator_MAX / 32 + 1];
+
+  int aliased_buffer_count_;
+
+ public:
+  TF_LITE_REMOVE_VIRTUAL_DELETE
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_ALIASING_MEMORY_PLANNER_H_
@@ -0,0 +1,133 @@
+/* Copyright 2025 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_FUSION_MEMORY_PLANNER_H_
+#define TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_FUSION_MEMORY_PLANNER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/compatibility.h"
+#include "tensorflow/lite/micro/flatbuffer_utils.h"
+#include "tensorflow/lite/micro/memory_planner/micro_memory_planner.h"
+#include "tensorflow/lite/micro/memory_planner/recording_memory_planner.h"
+#include "tensorflow/lite/micro/micro_fusion_plan.h"
+#include "tensorflow/lite/micro/micro_log.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+
+/*   This is an experimental feature and subjected to change.
+ *
+The FusionMemoryPlanner applies a MicroFusionPlan to the memory plan:
+
+  - the intermediate tensor of every fusion gets no space in the arena,
+  - the producer input stays alive until the consumer ran, since the consumer
+    reads it in place of the intermediate tensor.
+
+Like the OverlapMemoryPlanner, the buffers are recorded first and forwarded to
+the wrapped planner once all of them are known (see
+recording_memory_planner.h), and the operator times are taken from the buffers
+of their output tensors. The kernels are rewired before
+the memory plan is made, so a plan that doesn't match the buffers the
+MicroAllocator added is an error instead of being ignored.
+
+See micro_fusion_plan.h for an example.
+*/
+class FusionMemoryPlanner : public RecordingMemoryPlanner {
+ public:
+  // Does not take ownership of planner or plan, which must outlive this
+  // object. Enables the fusions of the plan; fused operators run once the
+  // plan was applied to the memory plan.
+  FusionMemoryPlanner(MicroMemoryPlanner* planner, MicroFusionPlan* plan)
+      : RecordingMemoryPlanner(planner, plan->model(), "fusion"),
+        plan_(plan),
+        saved_bytes_(0) {
+    plan_->set_planner_attached(true);
+  }
+  ~FusionMemoryPlanner() override {
+    plan_->set_planner_attached(false);
+    plan_->set_memory_planned(false);
+  }
+
+  TfLiteStatus Init(unsigned char* scratch_buffer,
+                    int scratch_buffer_size) override {
+    saved_bytes_ = 0;
+    plan_->set_memory_planned(false);
+    return RecordingMemoryPlanner::Init(scratch_buffer, scratch_buffer_size);
+  }
+
+  void PrintMemoryPlan() override {
+    MicroPrintf("Fusion planner: %d fusions, %d bytes of intermediates removed",
+                plan_->fusion_count(), saved_bytes_);
+    planner_->PrintMemoryPlan();
+  }
+
+  // Arena bytes of the intermediate tensors that were removed from the plan.
+  int GetSavedBytes() {
+    ForwardBuffersIfNeeded();
+    return saved_bytes_;
+  }
+
+ private:
+  TfLiteStatus ApplyFusions() {
+    for (int i = 0; i < plan_->fusion_count(); ++i) {
+      const MicroFusionPlan::Fusion& fusion = plan_->fusion(i);
+      const int intermediate = BufferOf(fusion.intermediate);
+      const int output = BufferOf(fusion.consumer_output);
+      if (intermediate < 0 || output < 0) {
+        MicroPrintf("Fusion %d doesn't match the memory plan", i);
+        return kTfLiteError;
+      }
+      // The consumer time is the first use of its output buffer.
+      const int consumer_time = records_[output].first_time_used;
+      const int source = BufferOf(fusion.source);
+      if (source >= 0 &&
+          records_[source].planned_last_time_used < consumer_time) {
+        records_[source].planned_last_time_used = consumer_time;
+      }
+      saved_bytes_ += records_[intermediate].planned_size;
+      records_[intermediate].planned_size = 0;
+    }
+    return kTfLiteOk;
+  }
+
+  TfLiteStatus PlanBuffers() override {
+    saved_bytes_ = 0;
+    plan_->set_memory_planned(false);
+    if (plan_->fusion_count() == 0) {
+      return kTfLiteOk;
+    }
+    if (!MapTensorsToBuffers()) {
+      MicroPrintf("Fusion plan doesn't match the buffers of the model");
+      return kTfLiteError;
+    }
+    return ApplyFusions();
+  }
+
+  void OnBuffersForwarded() override { plan_->set_memory_planned(true); }
+
+  MicroFusionPlan* plan_;  // not owned, can't be null
+
+  int saved_bytes_;
+
+ public:
+  TF_LITE_REMOVE_VIRTUAL_DELETE
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_FUSION_MEMORY_PLANNER_H_
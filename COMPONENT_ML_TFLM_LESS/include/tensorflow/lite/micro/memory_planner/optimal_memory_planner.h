@@ -0,0 +1,621 @@
+/* Copyright 2025 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_OPTIMAL_MEMORY_PLANNER_H_
+#define TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_OPTIMAL_MEMORY_PLANNER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#include "tensorflow/lite/micro/arena_allocator/single_arena_buffer_allocator.h"
+#include "tensorflow/lite/micro/compatibility.h"
+#include "tensorflow/lite/micro/memory_helpers.h"
+#include "tensorflow/lite/micro/memory_planner/greedy_memory_planner.h"
+#include "tensorflow/lite/micro/memory_planner/micro_memory_planner.h"
+#include "tensorflow/lite/micro/micro_allocator.h"
+#include "tensorflow/lite/micro/micro_arena_constants.h"
+#include "tensorflow/lite/micro/micro_log.h"
+#include "tensorflow/lite/micro/micro_time.h"
+
+namespace tflite {
+
+// A memory planner that searches for a tighter arena layout than the
+// GreedyMemoryPlanner, at the cost of more planning time.
+//
+// The algorithm works like this:
+//  - The client enters the buffer information through AddBuffer().
+//  - When a function like GetOffsetForBuffer() is called, the plan is
+//    calculated if it isn't up to date.
+//  - A lower bound is computed as the largest total size of buffers that are
+//    live at the same time. No layout can be smaller than this.
+//  - A first-fit layout is computed for several buffer orderings (by size, by
+//    lifetime length and by size * lifetime). First-fit places each buffer at
+//    the lowest offset where it doesn't overlap a simultaneously active buffer
+//    placed before it. The ordering by size is close to what the
+//    GreedyMemoryPlanner does, but ties and offline planned buffers are
+//    handled differently, so its layout can differ. The best of these layouts
+//    is the initial upper bound.
+//  - A depth-first branch-and-bound search then looks for a buffer ordering
+//    whose first-fit layout is smaller. Every layout can be compacted into one
+//    that first-fit reproduces when buffers are placed in ascending offset
+//    order, so the search only considers orderings where each buffer lands at
+//    or above the previous one. That keeps the search complete while cutting
+//    most of the permutations.
+//  - A partial ordering is pruned when its high-water mark, or the end of any
+//    unplaced buffer at its current lowest possible offset, reaches the best
+//    complete layout found so far.
+//  - The search stops when it proves that the best layout is optimal (the
+//    search space is exhausted or the lower bound is reached) or when the
+//    search budget set through SetSearchBudget() runs out. The best layout
+//    found so far is used in either case, so the result is never worse than
+//    the first-fit layouts above. It is not compared with the
+//    GreedyMemoryPlanner and can, in rare cases where the search budget runs
+//    out, be larger; see memory_planner_benchmark.h to compare both.
+//
+// Offline planned buffers keep the offset they were given, like in the
+// GreedyMemoryPlanner.
+//
+// To use it, pass an instance to MicroAllocator::Create(), or use
+// CreateMicroAllocatorWithOptimalPlanner() below which mirrors how
+// MicroAllocator::Create() sets up the planner for MemoryPlannerType::kGreedy.
+class OptimalMemoryPlanner : public MicroMemoryPlanner {
+ public:
+  // Default number of search steps. Each step finds the lowest offset of one
+  // buffer for one partial ordering and costs O(N) in the number of buffers.
+  static constexpr int kDefaultMaxSearchSteps = 100000;
+
+  OptimalMemoryPlanner()
+      : max_search_steps_(kDefaultMaxSearchSteps),
+        max_search_ticks_(0),
+        max_buffer_count_(0),
+        buffer_count_(0),
+        requirements_(nullptr),
+        order_(nullptr),
+        stack_(nullptr),
+        offsets_(nullptr),
+        best_offsets_(nullptr),
+        next_candidates_(nullptr),
+        peaks_(nullptr),
+        first_online_(0),
+        best_size_(0),
+        first_fit_size_(0),
+        lower_bound_size_(0),
+        search_steps_(0),
+        is_proven_optimal_(false),
+        need_to_calculate_offsets_(true) {}
+  ~OptimalMemoryPlanner() override {}
+
+  // Limits the time spent searching for a better layout. max_search_steps
+  // bounds the number of buffer placements tried, max_ticks bounds the wall
+  // clock time as measured by GetCurrentTimeTicks(). A value of zero disables
+  // the corresponding limit. With both limits disabled the search runs until
+  // the optimal layout is found, which can take exponential time.
+  void SetSearchBudget(int max_search_steps, uint32_t max_ticks) {
+    max_search_steps_ = max_search_steps;
+    max_search_ticks_ = max_ticks;
+    need_to_calculate_offsets_ = true;
+  }
+
+  // You need to pass in an area of memory to be used for planning, with the
+  // same semantics as GreedyMemoryPlanner::Init(). Each buffer requires
+  // per_buffer_size() bytes of scratch.
+  TfLiteStatus Init(unsigned char* scratch_buffer,
+                    int scratch_buffer_size) override {
+    buffer_count_ = 0;
+    max_buffer_count_ = scratch_buffer_size / per_buffer_size();
+
+    unsigned char* next_free = scratch_buffer;
+    requirements_ = reinterpret_cast<BufferRequirements*>(next_free);
+    next_free += sizeof(BufferRequirements) * max_buffer_count_;
+    order_ = reinterpret_cast<int*>(next_free);
+    next_free += sizeof(int) * max_buffer_count_;
+    stack_ = reinterpret_cast<int*>(next_free);
+    next_free += sizeof(int) * max_buffer_count_;
+    offsets_ = reinterpret_cast<int*>(next_free);
+    next_free += sizeof(int) * max_buffer_count_;
+    best_offsets_ = reinterpret_cast<int*>(next_free);
+    next_free += sizeof(int) * max_buffer_count_;
+    next_candidates_ = reinterpret_cast<int*>(next_free);
+    next_free += sizeof(int) * max_buffer_count_;
+    peaks_ = reinterpret_cast<int*>(next_free);
+
+    need_to_calculate_offsets_ = true;
+    return kTfLiteOk;
+  }
+
+  // Record details of a buffer we want to place.
+  TfLiteStatus AddBuffer(int size, int first_time_used,
+                         int last_time_used) override {
+    return AddBuffer(size, first_time_used, last_time_used,
+                     kOnlinePlannedBuffer);
+  }
+
+  // Record details of an offline planned buffer offset we want to place.
+  // offline_offset is the buffer offset from the start of the arena.
+  TfLiteStatus AddBuffer(int size, int first_time_used, int last_time_used,
+                         int offline_offset) override {
+    if (buffer_count_ >= max_buffer_count_) {
+      MicroPrintf("Too many buffers (max is %d)", max_buffer_count_);
+      return kTfLiteError;
+    }
+    BufferRequirements* current = &requirements_[buffer_count_];
+    current->size = size;
+    current->offline_offset = offline_offset;
+    current->first_time_used = first_time_used;
+    current->last_time_used = last_time_used;
+    ++buffer_count_;
+    need_to_calculate_offsets_ = true;
+    return kTfLiteOk;
+  }
+
+  // Returns the high-water mark of the best layout found.
+  size_t GetMaximumMemorySize() override {
+    CalculateOffsetsIfNeeded();
+    return static_cast<size_t>(best_size_);
+  }
+
+  int GetBufferCount() override { return buffer_count_; }
+
+  // Where a given buffer should be placed in the memory arena.
+  // This information is stored in the memory arena itself, so once the arena
+  // is used for inference, it will be overwritten.
+  TfLiteStatus GetOffsetForBuffer(int buffer_index, int* offset) override {
+    CalculateOffsetsIfNeeded();
+    if ((buffer_index < 0) || (buffer_index >= buffer_count_)) {
+      MicroPrintf("buffer index %d is outside range 0 to %d", buffer_index,
+                  buffer_count_);
+      return kTfLiteError;
+    }
+    *offset = best_offsets_[buffer_index];
+    return kTfLiteOk;
+  }
+
+  // Prints the layout plan and how it compares to the greedy layout.
+  void PrintMemoryPlan() override {
+    CalculateOffsetsIfNeeded();
+    for (int i = 0; i < buffer_count_; ++i) {
+      MicroPrintf(
+          "Planner buffer ID: %d, calculated offset: %d, size required: %d, "
+          "first_time_created: %d, last_time_used: %d",
+          i, best_offsets_[i], requirements_[i].size,
+          requirements_[i].first_time_used, requirements_[i].last_time_used);
+    }
+    MicroPrintf(
+        "Optimal planner: %d bytes (first fit by size %d bytes, lower bound "
+        "%d bytes), "
+        "%d search steps, %s",
+        best_size_, first_fit_size_, lower_bound_size_, search_steps_,
+        is_proven_optimal_ ? "proven optimal" : "search budget exhausted");
+  }
+
+  size_t GetPerBufferSize() override { return per_buffer_size(); }
+
+  // Number of bytes required in order to plan a buffer.
+  static size_t per_buffer_size() {
+    const int per_buffer_size = sizeof(BufferRequirements) +  // requirements_
+                                sizeof(int) +                 // order_
+                                sizeof(int) +                 // stack_
+                                sizeof(int) +                 // offsets_
+                                sizeof(int) +                 // best_offsets_
+                                sizeof(int) +                 // next_candidates_
+                                sizeof(int);                  // peaks_
+    return per_buffer_size;
+  }
+
+  // Returns False because tensors that aren't being used during a phase of
+  // invocation are overwritten, as with the GreedyMemoryPlanner.
+  bool preserves_all_tensors() const override { return false; }
+
+  // Arena size of the first fit layout of the buffers ordered by size, which
+  // seeds the search. It is close to, but not the same as, the layout of the
+  // GreedyMemoryPlanner.
+  size_t GetFirstFitMemorySize() {
+    CalculateOffsetsIfNeeded();
+    return static_cast<size_t>(first_fit_size_);
+  }
+
+  // Largest total size of simultaneously live buffers. No layout can need
+  // less than this.
+  size_t GetLowerBoundMemorySize() {
+    CalculateOffsetsIfNeeded();
+    return static_cast<size_t>(lower_bound_size_);
+  }
+
+  // True if the search completed, so no smaller layout exists.
+  bool IsPlanProvenOptimal() {
+    CalculateOffsetsIfNeeded();
+    return is_proven_optimal_;
+  }
+
+  // Number of buffer placements tried by the last search.
+  int GetSearchSteps() {
+    CalculateOffsetsIfNeeded();
+    return search_steps_;
+  }
+
+  // Debug method to check whether any buffer allocations are overlapping. This
+  // is an O(N^2) complexity operation, so only use for testing.
+  bool DoAnyBuffersOverlap() {
+    CalculateOffsetsIfNeeded();
+    for (int i = 0; i < buffer_count_; ++i) {
+      for (int j = i + 1; j < buffer_count_; ++j) {
+        if (OverlapsInTime(requirements_[i], requirements_[j]) &&
+            best_offsets_[i] < best_offsets_[j] + requirements_[j].size &&
+            best_offsets_[j] < best_offsets_[i] + requirements_[i].size) {
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+ private:
+  // Records the client-provided information about each buffer.
+  struct BufferRequirements {
+    int size;
+    int offline_offset;
+    int first_time_used;
+    int last_time_used;
+  };
+
+  // Orderings used to build the initial first-fit layouts.
+  enum class Ordering {
+    kBySize,
+    kByLifetime,
+    kByArea,
+  };
+
+  static bool OverlapsInTime(const BufferRequirements& a,
+                             const BufferRequirements& b) {
+    return !(a.last_time_used < b.first_time_used ||
+             b.last_time_used < a.first_time_used);
+  }
+
+  static bool IsOffline(const BufferRequirements& r) {
+    return r.offline_offset != kOnlinePlannedBuffer;
+  }
+
+  // Sort key for an ordering; buffers with larger keys are placed first.
+  static int64_t OrderingKey(const BufferRequirements& r, Ordering ordering) {
+    const int64_t lifetime =
+        static_cast<int64_t>(r.last_time_used) - r.first_time_used + 1;
+    switch (ordering) {
+      case Ordering::kByLifetime:
+        return (lifetime << 32) + r.size;
+      case Ordering::kByArea:
+        return lifetime * r.size;
+      case Ordering::kBySize:
+      default:
+        return r.size;
+    }
+  }
+
+  // Fills order_ with offline planned buffers first, followed by the online
+  // planned buffers in descending key order. Insertion sort is stable, so
+  // buffers with equal keys keep the order they were added in. Returns the
+  // number of offline planned buffers.
+  int SortBuffers(Ordering ordering) {
+    int count = 0;
+    for (int i = 0; i < buffer_count_; ++i) {
+      if (IsOffline(requirements_[i])) {
+        order_[count++] = i;
+      }
+    }
+    const int first_online = count;
+    for (int i = 0; i < buffer_count_; ++i) {
+      if (IsOffline(requirements_[i])) {
+        continue;
+      }
+      const int64_t key = OrderingKey(requirements_[i], ordering);
+      int j = count;
+      while (j > first_online &&
+             OrderingKey(requirements_[order_[j - 1]], ordering) < key) {
+        order_[j] = order_[j - 1];
+        --j;
+      }
+      order_[j] = i;
+      ++count;
+    }
+    return first_online;
+  }
+
+  // Returns the lowest offset at which `buffer` fits without overlapping any
+  // simultaneously active buffer in stack_[0] to stack_[depth - 1].
+  int FirstFitOffset(int buffer, int depth) {
+    ++search_steps_;
+    const BufferRequirements& current = requirements_[buffer];
+    if (IsOffline(current)) {
+      return current.offline_offset;
+    }
+    int candidate = 0;
+    bool moved = true;
+    while (moved) {
+      moved = false;
+      for (int i = 0; i < depth; ++i) {
+        const BufferRequirements& other = requirements_[stack_[i]];
+        const int other_end = offsets_[stack_[i]] + other.size;
+        if (OverlapsInTime(current, other) && candidate < other_end &&
+            offsets_[stack_[i]] < candidate + current.size) {
+          // Every offset below the end of the conflicting buffer also
+          // overlaps it.
+          candidate = other_end;
+          moved = true;
+        }
+      }
+    }
+    return candidate;
+  }
+
+  // Places all buffers in order_ with first-fit and returns the resulting
+  // high-water mark.
+  int FirstFitLayout() {
+    int peak = 0;
+    for (int depth = 0; depth < buffer_count_; ++depth) {
+      const int buffer = order_[depth];
+      offsets_[buffer] = FirstFitOffset(buffer, depth);
+      stack_[depth] = buffer;
+      const int end = offsets_[buffer] + requirements_[buffer].size;
+      peak = end > peak ? end : peak;
+    }
+    return peak;
+  }
+
+  int LowerBound() const {
+    int lower_bound = 0;
+    for (int i = 0; i < buffer_count_; ++i) {
+      // The peak of live bytes is reached when some buffer is first used.
+      const int time = requirements_[i].first_time_used;
+      int live = 0;
+      for (int j = 0; j < buffer_count_; ++j) {
+        const BufferRequirements& r = requirements_[j];
+        if (r.first_time_used <= time && time <= r.last_time_used) {
+          live += r.size;
+        }
+      }
+      lower_bound = live > lower_bound ? live : lower_bound;
+      if (IsOffline(requirements_[i])) {
+        const int end = requirements_[i].offline_offset + requirements_[i].size;
+        lower_bound = end > lower_bound ? end : lower_bound;
+      }
+    }
+    return lower_bound;
+  }
+
+  bool SearchBudgetExhausted(uint32_t start_ticks) const {
+    if (max_search_steps_ > 0 && search_steps_ >= max_search_steps_) {
+      return true;
+    }
+    if (max_search_ticks_ > 0) {
+      return GetCurrentTimeTicks() - start_ticks >= max_search_ticks_;
+    }
+    return false;
+  }
+
+  // Returns true if some unplaced buffer can no longer end below best_size_.
+  // Buffers only move up as more buffers are placed, and none may be placed
+  // below `floor`.
+  bool CanPrune(int depth, int floor) {
+    for (int pos = first_online_; pos < buffer_count_; ++pos) {
+      const int buffer = order_[pos];
+      if (offsets_[buffer] >= 0) {
+        continue;
+      }
+      const int offset = FirstFitOffset(buffer, depth);
+      const int lowest = offset > floor ? offset : floor;
+      if (lowest + requirements_[buffer].size >= best_size_) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Depth-first branch-and-bound over the orderings of the online planned
+  // buffers, seeded with the layout in best_offsets_. At each depth the
+  // candidates are the unplaced buffers in order_; next_candidates_[depth] is
+  // the position in order_ of the next candidate to try.
+  void Search() {
+    const uint32_t start_ticks =
+        max_search_ticks_ > 0 ? GetCurrentTimeTicks() : 0;
+    for (int pos = first_online_; pos < buffer_count_; ++pos) {
+      offsets_[order_[pos]] = -1;
+    }
+    // Offline planned buffers are fixed at the bottom of the stack.
+    for (int depth = 0; depth < first_online_; ++depth) {
+      const int buffer = stack_[depth];
+      const int end = offsets_[buffer] + requirements_[buffer].size;
+      const int previous = depth > 0 ? peaks_[depth - 1] : 0;
+      peaks_[depth] = end > previous ? end : previous;
+    }
+
+    // Nothing to search if all buffers are offline planned; next_candidates_
+    // has no entry at index buffer_count_.
+    if (first_online_ == buffer_count_) {
+      return;
+    }
+    int depth = first_online_;
+    next_candidates_[depth] = first_online_;
+    while (depth >= first_online_) {
+      if (SearchBudgetExhausted(start_ticks)) {
+        return;
+      }
+      // Canonical orderings place buffers at non-decreasing offsets, breaking
+      // ties by position in order_.
+      const bool has_previous = depth > first_online_;
+      const int floor = has_previous ? offsets_[stack_[depth - 1]] : 0;
+      const int floor_pos = has_previous ? next_candidates_[depth - 1] - 1 : -1;
+      const int previous_peak = depth > 0 ? peaks_[depth - 1] : 0;
+
+      int chosen = -1;
+      int pos = next_candidates_[depth];
+      for (; previous_peak < best_size_ && pos < buffer_count_; ++pos) {
+        const int buffer = order_[pos];
+        if (offsets_[buffer] >= 0) {
+          continue;
+        }
+        const int offset = FirstFitOffset(buffer, depth);
+        if (offset < floor || (offset == floor && pos < floor_pos) ||
+            offset + requirements_[buffer].size >= best_size_) {
+          continue;
+        }
+        chosen = buffer;
+        offsets_[buffer] = offset;
+        break;
+      }
+      if (chosen < 0) {
+        --depth;
+        if (depth >= first_online_) {
+          offsets_[stack_[depth]] = -1;
+        }
+        continue;
+      }
+      next_candidates_[depth] = pos + 1;
+      stack_[depth] = chosen;
+      const int end = offsets_[chosen] + requirements_[chosen].size;
+      peaks_[depth] = end > previous_peak ? end : previous_peak;
+
+      if (depth == buffer_count_ - 1) {
+        best_size_ = peaks_[depth];
+        for (int i = 0; i < buffer_count_; ++i) {
+          best_offsets_[i] = offsets_[i];
+        }
+        if (best_size_ <= lower_bound_size_) {
+          is_proven_optimal_ = true;
+          return;
+        }
+        offsets_[chosen] = -1;
+        continue;
+      }
+      if (CanPrune(depth + 1, offsets_[chosen])) {
+        offsets_[chosen] = -1;
+        continue;
+      }
+      ++depth;
+      next_candidates_[depth] = first_online_;
+    }
+    is_proven_optimal_ = true;
+  }
+
+  // If there isn't an up to date plan, calculate a new one.
+  void CalculateOffsetsIfNeeded() {
+    if (!need_to_calculate_offsets_) {
+      return;
+    }
+    need_to_calculate_offsets_ = false;
+    search_steps_ = 0;
+    is_proven_optimal_ = false;
+    best_size_ = 0;
+    first_fit_size_ = 0;
+    lower_bound_size_ = 0;
+    if (buffer_count_ == 0) {
+      is_proven_optimal_ = true;
+      return;
+    }
+    lower_bound_size_ = LowerBound();
+
+    constexpr Ordering kOrderings[] = {Ordering::kBySize, Ordering::kByLifetime,
+                                       Ordering::kByArea};
+    Ordering best_ordering = Ordering::kBySize;
+    for (Ordering ordering : kOrderings) {
+      SortBuffers(ordering);
+      const int size = FirstFitLayout();
+      if (ordering == Ordering::kBySize) {
+        first_fit_size_ = size;
+      }
+      if (ordering == Ordering::kBySize || size < best_size_) {
+        best_size_ = size;
+        best_ordering = ordering;
+        for (int i = 0; i < buffer_count_; ++i) {
+          best_offsets_[i] = offsets_[i];
+        }
+      }
+    }
+    if (best_size_ <= lower_bound_size_) {
+      is_proven_optimal_ = true;
+      return;
+    }
+    first_online_ = SortBuffers(best_ordering);
+    FirstFitLayout();
+    Search();
+  }
+
+  int max_search_steps_;
+  uint32_t max_search_ticks_;
+
+  // How many buffers we can plan for, based on the scratch memory given to
+  // Init().
+  int max_buffer_count_;
+
+  // The number of buffers added so far.
+  int buffer_count_;
+
+  // Working arrays used during the layout algorithm. requirements_, offsets_
+  // and best_offsets_ are indexed by buffer index, stack_, next_candidates_
+  // and peaks_ by search depth. order_ holds the buffer indices in the order
+  // candidates are tried.
+  BufferRequirements* requirements_;
+  int* order_;
+  int* stack_;
+  int* offsets_;
+  int* best_offsets_;
+  int* next_candidates_;
+  int* peaks_;
+
+  // Number of offline planned buffers, which come first in order_.
+  int first_online_;
+
+  int best_size_;
+  int first_fit_size_;
+  int lower_bound_size_;
+  int search_steps_;
+  bool is_proven_optimal_;
+
+  // Whether buffers have been added since the last plan was calculated.
+  bool need_to_calculate_offsets_;
+
+ public:
+  TF_LITE_REMOVE_VIRTUAL_DELETE
+};
+
+// Creates a MicroAllocator instance from a given tensor arena that plans the
+// non-persistent buffers with an OptimalMemoryPlanner. The planner is
+// allocated from the persistent (tail) section of the arena, in the same way
+// MicroAllocator::Create() allocates the planner for a MemoryPlannerType.
+// Note: Please use alignas(16) to make sure tensor_arena is 16 bytes aligned,
+// otherwise some head room will be wasted.
+inline MicroAllocator* CreateMicroAllocatorWithOptimalPlanner(
+    uint8_t* tensor_arena, size_t arena_size,
+    int max_search_steps = OptimalMemoryPlanner::kDefaultMaxSearchSteps,
+    uint32_t max_search_ticks = 0) {
+  uint8_t* aligned_arena =
+      AlignPointerUp(tensor_arena, MicroArenaBufferAlignment());
+  size_t aligned_arena_size = tensor_arena + arena_size - aligned_arena;
+  SingleArenaBufferAllocator* memory_allocator =
+      SingleArenaBufferAllocator::Create(aligned_arena, aligned_arena_size);
+  uint8_t* memory_planner_buffer = memory_allocator->AllocatePersistentBuffer(
+      sizeof(OptimalMemoryPlanner), alignof(OptimalMemoryPlanner));
+  if (memory_planner_buffer == nullptr) {
+    MicroPrintf("Failed to allocate the OptimalMemoryPlanner");
+    return nullptr;
+  }
+  OptimalMemoryPlanner* memory_planner =
+      new (memory_planner_buffer) OptimalMemoryPlanner();
+  memory_planner->SetSearchBudget(max_search_steps, max_search_ticks);
+  return MicroAllocator::Create(memory_allocator, memory_planner);
+}
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_OPTIMAL_MEMORY_PLANNER_H_
@@ -0,0 +1,44 @@
+/* Copyright 2025 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_MICRO_BENCHMARK_CLOCK_H_
+#define TENSORFLOW_LITE_MICRO_MICRO_BENCHMARK_CLOCK_H_
+
+#include <cstdint>
+
+#include "tensorflow/lite/micro/micro_time.h"
+
+namespace tflite {
+
+// Returns a monotonic time in nanoseconds. Used by the benchmark harnesses,
+// so that targets can time with a wider counter than GetCurrentTimeTicks().
+typedef uint64_t (*MicroBenchmarkClock)();
+
+// Default clock on GetCurrentTimeTicks(). The 32 bit tick counter is extended
+// to 64 bits, so the clock must be read at least once per counter wrap.
+inline uint64_t MicroBenchmarkDefaultClock() {
+  static uint32_t last_ticks = GetCurrentTimeTicks();
+  static uint64_t total_ticks = 0;
+  const uint32_t ticks = GetCurrentTimeTicks();
+  total_ticks += static_cast<uint32_t>(ticks - last_ticks);
+  last_ticks = ticks;
+  const uint32_t rate = ticks_per_second() > 0 ? ticks_per_second() : 1;
+  return total_ticks / rate * 1000000000u +
+         total_ticks % rate * 1000000000u / rate;
+}
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MICRO_BENCHMARK_CLOCK_H_
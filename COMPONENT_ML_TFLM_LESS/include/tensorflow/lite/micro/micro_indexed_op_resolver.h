@@ -0,0 +1,292 @@
+/* Copyright 2025 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_MICRO_INDEXED_OP_RESOLVER_H_
+#define TENSORFLOW_LITE_MICRO_MICRO_INDEXED_OP_RESOLVER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/compatibility.h"
+#include "tensorflow/lite/micro/micro_log.h"
+#include "tensorflow/lite/micro/micro_mutable_op_resolver.h"
+#include "tensorflow/lite/micro/micro_op_resolver.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+
+// Number of entries of a table indexed by BuiltinOperator.
+constexpr int kMicroBuiltinOperatorCount = BuiltinOperator_MAX + 1;
+
+inline bool IsIndexableBuiltin(BuiltinOperator op) {
+  return op >= 0 && op < kMicroBuiltinOperatorCount &&
+         op != BuiltinOperator_CUSTOM;
+}
+
+// Open addressing hash table from custom op names to registrations. Names
+// are hashed with FNV-1a and compared once on a hash match.
+template <unsigned int tCapacity>
+class MicroCustomOpTable {
+ public:
+  MicroCustomOpTable() : count_(0) {
+    for (unsigned int i = 0; i < kSize; ++i) {
+      entries_[i].registration = nullptr;
+    }
+  }
+
+  TfLiteStatus Insert(const char* name, const TFLMRegistration* registration) {
+    if (count_ >= tCapacity) {
+      return kTfLiteError;
+    }
+    const uint32_t hash = Hash(name);
+    for (uint32_t i = hash;; ++i) {
+      Entry& entry = entries_[i & (kSize - 1)];
+      if (entry.registration == nullptr) {
+        entry.hash = hash;
+        entry.registration = registration;
+        ++count_;
+        return kTfLiteOk;
+      }
+    }
+  }
+
+  const TFLMRegistration* Find(const char* name) const {
+    if (name == nullptr) {
+      return nullptr;
+    }
+    const uint32_t hash = Hash(name);
+    for (uint32_t i = hash;; ++i) {
+      const Entry& entry = entries_[i & (kSize - 1)];
+      if (entry.registration == nullptr) {
+        return nullptr;
+      }
+      if (entry.hash == hash &&
+          strcmp(entry.registration->custom_name, name) == 0) {
+        return entry.registration;
+      }
+    }
+  }
+
+  static uint32_t Hash(const char* name) {
+    uint32_t hash = 2166136261u;
+    for (; *name != '\0'; ++name) {
+      hash = (hash ^ static_cast<uint8_t>(*name)) * 16777619u;
+    }
+    return hash;
+  }
+
+ private:
+  static constexpr unsigned int RoundUpToPowerOfTwo(unsigned int value) {
+    unsigned int size = 1;
+    while (size < value) {
+      size <<= 1;
+    }
+    return size;
+  }
+
+  // At most half full, so probe sequences stay short and always end.
+  static constexpr unsigned int kSize = RoundUpToPowerOfTwo(2 * tCapacity + 1);
+
+  struct Entry {
+    uint32_t hash;
+    const TFLMRegistration* registration;
+  };
+
+  Entry entries_[kSize];
+  unsigned int count_;
+};
+
+// MicroMutableOpResolver with constant time lookups: a dense table indexed by
+// BuiltinOperator for builtin ops and a hash table for custom op names. It is
+// a drop-in replacement, the tables are updated as operators are added.
+//
+// The tables cost about 2 * kMicroBuiltinOperatorCount bytes plus two
+// pointers per possible custom op.
+template <unsigned int tOpCount>
+class MicroIndexedOpResolver : public MicroMutableOpResolver<tOpCount> {
+  static_assert(tOpCount < 255, "Registration indices are stored as uint8_t");
+  using Base = MicroMutableOpResolver<tOpCount>;
+
+ public:
+  MicroIndexedOpResolver() : indexed_registrations_(0), indexed_builtins_(0) {
+    memset(registration_index_, 0, sizeof(registration_index_));
+    memset(parser_index_, 0, sizeof(parser_index_));
+  }
+
+  const TFLMRegistration* FindOp(BuiltinOperator op) const override {
+    if (!IsIndexableBuiltin(op)) {
+      return nullptr;
+    }
+    UpdateIndex();
+    const uint8_t slot = registration_index_[op];
+    return slot != 0 ? &this->registration_at(slot - 1) : nullptr;
+  }
+
+  const TFLMRegistration* FindOp(const char* op) const override {
+    UpdateIndex();
+    return custom_ops_.Find(op);
+  }
+
+  TfLiteBridgeBuiltinParseFunction GetOpDataParser(
+      BuiltinOperator op) const override {
+    if (!IsIndexableBuiltin(op)) {
+      return nullptr;
+    }
+    UpdateIndex();
+    const uint8_t slot = parser_index_[op];
+    return slot != 0 ? this->builtin_parser_at(slot - 1) : nullptr;
+  }
+
+ private:
+  // Indexes the registrations added since the last lookup. The base class
+  // looks up every op before adding it, so this indexes one op at a time.
+  void UpdateIndex() const {
+    for (; indexed_registrations_ < this->registration_count();
+         ++indexed_registrations_) {
+      const TFLMRegistration& registration =
+          this->registration_at(indexed_registrations_);
+      if (registration.builtin_code == BuiltinOperator_CUSTOM) {
+        custom_ops_.Insert(registration.custom_name, &registration);
+      } else if (IsIndexableBuiltin(
+                     static_cast<BuiltinOperator>(registration.builtin_code))) {
+        registration_index_[registration.builtin_code] =
+            static_cast<uint8_t>(indexed_registrations_ + 1);
+      }
+    }
+    for (; indexed_builtins_ < this->builtin_op_count(); ++indexed_builtins_) {
+      const BuiltinOperator op = this->builtin_code_at(indexed_builtins_);
+      if (IsIndexableBuiltin(op)) {
+        parser_index_[op] = static_cast<uint8_t>(indexed_builtins_ + 1);
+      }
+    }
+  }
+
+  // Indices are one based, 0 means not registered.
+  mutable uint8_t registration_index_[kMicroBuiltinOperatorCount];
+  mutable uint8_t parser_index_[kMicroBuiltinOperatorCount];
+  mutable MicroCustomOpTable<tOpCount> custom_ops_;
+  mutable unsigned int indexed_registrations_;
+  mutable unsigned int indexed_builtins_;
+
+ public:
+  TF_LITE_REMOVE_VIRTUAL_DELETE
+};
+
+// Index of a fixed list of builtin ops, computed at compile time.
+struct MicroBuiltinIndex {
+  uint8_t slot[kMicroBuiltinOperatorCount];  // One based, 0 means absent.
+};
+
+template <size_t N>
+constexpr MicroBuiltinIndex MakeMicroBuiltinIndex(
+    const BuiltinOperator (&ops)[N]) {
+  static_assert(N < 255, "Registration indices are stored as uint8_t");
+  MicroBuiltinIndex index{};
+  for (size_t i = 0; i < N; ++i) {
+    if (ops[i] >= 0 && ops[i] < kMicroBuiltinOperatorCount &&
+        ops[i] != BuiltinOperator_CUSTOM) {
+      index.slot[ops[i]] = static_cast<uint8_t>(i + 1);
+    }
+  }
+  return index;
+}
+
+// Resolver for the operators of one model, as emitted by a code generator
+// from the operator_codes of the model. The builtin index is a compile time
+// constant, so resolving the operators of the model does no search at all,
+// and only the kernels the model uses are linked.
+//
+// Generated code:
+//
+//   constexpr tflite::BuiltinOperator kOps[] = {
+//       tflite::BuiltinOperator_CONV_2D, tflite::BuiltinOperator_SOFTMAX,
+//       tflite::BuiltinOperator_CUSTOM};
+//   constexpr tflite::MicroBuiltinIndex kOpIndex =
+//       tflite::MakeMicroBuiltinIndex(kOps);
+//   const tflite::MicroStaticOpResolver<3>::Entry kOpEntries[] = {
+//       {tflite::Register_CONV_2D, tflite::ParseConv2D, nullptr},
+//       {tflite::Register_SOFTMAX, tflite::ParseSoftmax, nullptr},
+//       {tflite::Register_MY_OP, nullptr, "MyOp"},
+//   };
+//   tflite::MicroStaticOpResolver<3> op_resolver(kOpEntries, kOpIndex);
+//
+// Entry i describes kOps[i]; custom ops have a name and no parser.
+template <unsigned int tOpCount>
+class MicroStaticOpResolver : public MicroOpResolver {
+ public:
+  struct Entry {
+    TFLMRegistration (*registration)();
+    TfLiteBridgeBuiltinParseFunction parser;
+    const char* custom_name;  // Only for custom ops.
+  };
+
+  // Does not take ownership of `index`, which must outlive this object.
+  MicroStaticOpResolver(const Entry (&entries)[tOpCount],
+                        const MicroBuiltinIndex& index)
+      : index_(index) {
+    for (unsigned int i = 0; i < tOpCount; ++i) {
+      registrations_[i] = entries[i].registration();
+      parsers_[i] = entries[i].parser;
+      if (entries[i].custom_name != nullptr) {
+        registrations_[i].builtin_code = BuiltinOperator_CUSTOM;
+        registrations_[i].custom_name = entries[i].custom_name;
+        if (custom_ops_.Insert(entries[i].custom_name, &registrations_[i]) !=
+            kTfLiteOk) {
+          MicroPrintf("Couldn't register custom op '%s'",
+                      entries[i].custom_name);
+        }
+      }
+    }
+    for (int op = 0; op < kMicroBuiltinOperatorCount; ++op) {
+      if (index_.slot[op] != 0) {
+        registrations_[index_.slot[op] - 1].builtin_code = op;
+      }
+    }
+  }
+
+  const TFLMRegistration* FindOp(BuiltinOperator op) const override {
+    if (!IsIndexableBuiltin(op) || index_.slot[op] == 0) {
+      return nullptr;
+    }
+    return &registrations_[index_.slot[op] - 1];
+  }
+
+  const TFLMRegistration* FindOp(const char* op) const override {
+    return custom_ops_.Find(op);
+  }
+
+  TfLiteBridgeBuiltinParseFunction GetOpDataParser(
+      BuiltinOperator op) const override {
+    if (!IsIndexableBuiltin(op) || index_.slot[op] == 0) {
+      return nullptr;
+    }
+    return parsers_[index_.slot[op] - 1];
+  }
+
+ private:
+  const MicroBuiltinIndex& index_;
+  TFLMRegistration registrations_[tOpCount];
+  TfLiteBridgeBuiltinParseFunction parsers_[tOpCount];
+  MicroCustomOpTable<tOpCount> custom_ops_;
+
+ public:
+  TF_LITE_REMOVE_VIRTUAL_DELETE
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MICRO_INDEXED_OP_RESOLVER_H_
@@ -16,10 +16,21 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_MICRO_MICRO_INTERPRETER_GRAPH_H_
 #define TENSORFLOW_LITE_MICRO_MICRO_INTERPRETER_GRAPH_H_
 
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/compatibility.h"
+#include "tensorflow/lite/micro/flatbuffer_utils.h"
+#include "tensorflow/lite/micro/memory_helpers.h"
+#include "tensorflow/lite/micro/memory_planner/overlap_memory_planner.h"
 #include "tensorflow/lite/micro/micro_allocator.h"
+#include "tensorflow/lite/micro/micro_async_accelerator.h"
 #include "tensorflow/lite/micro/micro_common.h"
 #include "tensorflow/lite/micro/micro_graph.h"
+#include "tensorflow/lite/micro/micro_log.h"
+#include "tensorflow/lite/micro/micro_profiler.h"
 #include "tensorflow/lite/micro/micro_resource_variable.h"
+#include "tensorflow/lite/micro/micro_time.h"
 #include "tensorflow/lite/schema/schema_generated.h"
 
 namespace tflite {
@@ -91,6 +102,140 @@ class MicroInterpreterGraph : public MicroGraph {
   // identifier of the operator inside the subgraph
   int GetCurrentOperatorIndex() { return current_operator_index_; }
 
+  // Resumable, time-sliced alternative to InvokeSubgraph(). Runs at most
+  // `max_ops` operators of a subgraph and returns kTfLiteOk; IsInvokePending()
+  // tells whether operators are left. The next call for the same subgraph
+  // resumes after the last operator that ran. A failing operator aborts the
+  // run, and the next call starts the subgraph from its first operator.
+  // Calling it for another subgraph, or CancelPendingInvoke(), abandons the
+  // pending invoke.
+  //
+  // The resume position is part of the graph, so graphs can be sliced
+  // independently, but one graph must not be invoked from several execution
+  // contexts. InvokeSubgraphOverlapped() clears it. InvokeSubgraph(),
+  // ResetSubgraphs() and PrepareSubgraphs() are compiled into the runtime
+  // library and do not, so call CancelPendingInvoke() before them.
+  //
+  // Example, running inference in the idle time of a control loop:
+  //
+  //   TfLiteStatus status = graph.InvokeSteps(0, 1);
+  //   while (status == kTfLiteOk && graph.IsInvokePending(0)) {
+  //     WaitForNextControlPeriod();
+  //     status = graph.InvokeSteps(0, 2);
+  //   }
+  TfLiteStatus InvokeSteps(int subgraph_idx, uint32_t max_ops) {
+    return InvokeSlice(subgraph_idx, max_ops, 0);
+  }
+
+  // Like InvokeSteps(), but starts operators only as long as fewer than
+  // `max_ticks` ticks of GetCurrentTimeTicks() passed since the call. At least
+  // one operator runs per call, and an operator that has been started always
+  // completes, so a call can overrun `max_ticks` by the duration of one
+  // operator.
+  TfLiteStatus InvokeFor(int subgraph_idx, uint32_t max_ticks) {
+    return InvokeSlice(subgraph_idx, UINT32_MAX, max_ticks);
+  }
+
+  // Overlapped execution mode for accelerators that run asynchronously to
+  // the CPU, such as the NNLite NPU. Operators declared by `accelerator` are
+  // submitted to it without waiting. While one of them runs, the following
+  // operator is run on the CPU if it is not accelerated and shares no
+  // written tensor memory with the accelerated operator; then the
+  // interpreter waits for the completion callback.
+  //
+  // The scratch buffers and dying inputs of an accelerated operator are not
+  // visible in its node, so operators are only overlapped if `planner`
+  // planned the arena and reports that it kept them alive for the overlapped
+  // operator. Otherwise every operator runs in turn.
+  TfLiteStatus InvokeSubgraphOverlapped(int subgraph_idx,
+                                        MicroAsyncAccelerator* accelerator,
+                                        const OverlapMemoryPlanner* planner) {
+    TF_LITE_ENSURE_STATUS(CheckSubgraphIndex(subgraph_idx));
+    CancelPendingInvoke();
+    const bool is_overlap_planned =
+        planner != nullptr && planner->IsOverlapPlanned(accelerator);
+    const int previous_subgraph_idx = current_subgraph_index_;
+    const uint32_t previous_operator_idx = current_operator_index_;
+    current_subgraph_index_ = subgraph_idx;
+    NodeAndRegistration* nodes =
+        subgraph_allocations_[subgraph_idx].node_and_registrations;
+    const uint32_t operators_size = NumSubgraphOperators(model_, subgraph_idx);
+
+    TfLiteStatus status = kTfLiteOk;
+    uint32_t index = 0;
+    while (status == kTfLiteOk && index < operators_size) {
+      current_operator_index_ = index;
+      const TFLMRegistration* registration = nodes[index].registration;
+      if (!accelerator->IsAccelerated(registration)) {
+        status = InvokeOperator(nodes[index]);
+        allocator_->ResetTempAllocations();
+        ++index;
+        continue;
+      }
+
+      AsyncCompletion completion = {false, kTfLiteOk};
+      TfLiteStatus overlapped_status = kTfLiteOk;
+      const uint32_t next = index + 1;
+      bool is_next_overlapped = false;
+      {
+        ScopedMicroProfiler scoped_profiler(
+            OpNameFromRegistration(registration),
+            reinterpret_cast<MicroProfilerInterface*>(context_->profiler));
+        status = accelerator->Submit(context_, &nodes[index].node,
+                                     registration, &OnAsyncCompletion,
+                                     &completion);
+        if (status != kTfLiteOk) {
+          break;
+        }
+        is_next_overlapped =
+            is_overlap_planned && next < operators_size &&
+            !accelerator->IsAccelerated(nodes[next].registration) &&
+            MicroAsyncAccelerator::MayOverlap(registration->builtin_code) &&
+            MicroAsyncAccelerator::MayOverlap(
+                nodes[next].registration->builtin_code) &&
+            AreOperatorsIndependent(subgraph_idx, nodes[index].node,
+                                    nodes[next].node);
+        if (is_next_overlapped) {
+          current_operator_index_ = next;
+          overlapped_status = InvokeOperator(nodes[next]);
+          accelerator->OnOverlappedOperator(next);
+          current_operator_index_ = index;
+        }
+        while (!completion.done) {
+          accelerator->WaitForEvent();
+        }
+      }
+      allocator_->ResetTempAllocations();
+
+      status = completion.status;
+      if (status == kTfLiteError) {
+        MicroPrintf("Node %s (number %d) failed to invoke with status %d",
+                    OpNameFromRegistration(registration),
+                    static_cast<int>(index), status);
+      } else if (status == kTfLiteOk) {
+        status = overlapped_status;
+      }
+      index = is_next_overlapped ? next + 1 : next;
+    }
+
+    current_subgraph_index_ = previous_subgraph_idx;
+    current_operator_index_ = previous_operator_idx;
+    return status;
+  }
+
+  // Returns true while a resumable invoke of `subgraph_idx` is in progress.
+  bool IsInvokePending(int subgraph_idx) const {
+    return pending_subgraph_index_ >= 0 &&
+           pending_subgraph_index_ == subgraph_idx;
+  }
+
+  // Abandons a resumable invoke in progress; the next InvokeSteps() or
+  // InvokeFor() starts from the first operator.
+  void CancelPendingInvoke() {
+    pending_subgraph_index_ = -1;
+    pending_operator_index_ = 0;
+  }
+
   // Gets the list of allocations for each subgraph. This is the source of truth
   // for all per-subgraph allocation data.
   SubgraphAllocations* GetAllocations() const { return subgraph_allocations_; }
@@ -99,6 +244,176 @@ class MicroInterpreterGraph : public MicroGraph {
   MicroResourceVariables* GetResourceVariables() { return resource_variables_; }
 
  private:
+  // Runs operators of a subgraph until `max_ops` ran or, for a non-zero
+  // `max_ticks`, the time budget is used up. The position is kept in
+  // pending_subgraph_index_ and pending_operator_index_ between calls.
+  TfLiteStatus InvokeSlice(int subgraph_idx, uint32_t max_ops,
+                           uint32_t max_ticks) {
+    TF_LITE_ENSURE_STATUS(CheckSubgraphIndex(subgraph_idx));
+    uint32_t index = 0;
+    if (IsInvokePending(subgraph_idx)) {
+      index = pending_operator_index_;
+    }
+    CancelPendingInvoke();
+    const int previous_subgraph_idx = current_subgraph_index_;
+    const uint32_t previous_operator_idx = current_operator_index_;
+    current_subgraph_index_ = subgraph_idx;
+    const uint32_t operators_size = NumSubgraphOperators(model_, subgraph_idx);
+    const uint32_t start_ticks = max_ticks != 0 ? GetCurrentTimeTicks() : 0;
+    uint32_t ops_run = 0;
+    TfLiteStatus status = kTfLiteOk;
+    while (index < operators_size && ops_run < max_ops) {
+      if (ops_run > 0 && max_ticks != 0 &&
+          GetCurrentTimeTicks() - start_ticks >= max_ticks) {
+        break;
+      }
+      current_operator_index_ = index;
+      status = InvokeOperator(
+          subgraph_allocations_[subgraph_idx].node_and_registrations[index]);
+      // All TfLiteTensor structs used in the kernel are allocated from temp
+      // memory in the allocator, release them before the next operator.
+      allocator_->ResetTempAllocations();
+      if (status != kTfLiteOk) {
+        break;
+      }
+      ++index;
+      ++ops_run;
+    }
+    if (status == kTfLiteOk && index < operators_size) {
+      pending_subgraph_index_ = subgraph_idx;
+      pending_operator_index_ = index;
+    }
+    current_subgraph_index_ = previous_subgraph_idx;
+    current_operator_index_ = previous_operator_idx;
+    return status;
+  }
+
+  TfLiteStatus CheckSubgraphIndex(int subgraph_idx) const {
+    if (subgraphs_ == nullptr || subgraph_idx < 0 ||
+        static_cast<size_t>(subgraph_idx) >= subgraphs_->size()) {
+      MicroPrintf("Accessing subgraph %d but only %d subgraphs found",
+                  subgraph_idx,
+                  subgraphs_ == nullptr ? 0
+                                        : static_cast<int>(subgraphs_->size()));
+      return kTfLiteError;
+    }
+    return kTfLiteOk;
+  }
+
+  // Runs the kernel of one operator at current_operator_index_. Temporary
+  // allocations are left to the caller to reset.
+  TfLiteStatus InvokeOperator(NodeAndRegistration& node_and_registration) {
+    const TFLMRegistration* registration = node_and_registration.registration;
+    TfLiteStatus invoke_status;
+    {
+      ScopedMicroProfiler scoped_profiler(
+          OpNameFromRegistration(registration),
+          reinterpret_cast<MicroProfilerInterface*>(context_->profiler));
+      TFLITE_DCHECK(registration->invoke);
+      invoke_status =
+          registration->invoke(context_, &node_and_registration.node);
+    }
+    if (invoke_status == kTfLiteError) {
+      MicroPrintf("Node %s (number %d) failed to invoke with status %d",
+                  OpNameFromRegistration(registration),
+                  static_cast<int>(current_operator_index_), invoke_status);
+    }
+    return invoke_status;
+  }
+
+  // State shared with the MicroAsyncAccelerator completion callback.
+  struct AsyncCompletion {
+    volatile bool done;
+    volatile TfLiteStatus status;
+  };
+
+  static void OnAsyncCompletion(void* user_data, TfLiteStatus status) {
+    AsyncCompletion* completion = static_cast<AsyncCompletion*>(user_data);
+    completion->status = status;
+    completion->done = true;
+  }
+
+  // Returns true if `node` writes tensor `tensor_index`: its outputs,
+  // intermediates and variable inputs.
+  bool IsWrittenTensor(int subgraph_idx, const TfLiteNode& node,
+                       int tensor_index) const {
+    for (int i = 0; i < node.outputs->size; ++i) {
+      if (node.outputs->data[i] == tensor_index) return true;
+    }
+    if (node.intermediates != nullptr) {
+      for (int i = 0; i < node.intermediates->size; ++i) {
+        if (node.intermediates->data[i] == tensor_index) return true;
+      }
+    }
+    return model_->subgraphs()
+        ->Get(subgraph_idx)
+        ->tensors()
+        ->Get(tensor_index)
+        ->is_variable();
+  }
+
+  // Calls `visit` for every tensor of `node` that has data.
+  template <typename Visitor>
+  static bool ForEachNodeTensor(const TfLiteNode& node, Visitor visit) {
+    const TfLiteIntArray* lists[] = {node.inputs, node.outputs,
+                                     node.intermediates};
+    for (const TfLiteIntArray* list : lists) {
+      if (list == nullptr) continue;
+      for (int i = 0; i < list->size; ++i) {
+        if (list->data[i] >= 0 && !visit(list->data[i])) return false;
+      }
+    }
+    return true;
+  }
+
+  // Assumes an overlap if the memory of a tensor is not known.
+  bool DoTensorsOverlap(int subgraph_idx, int first, int second) const {
+    if (first == second) return true;
+    const TfLiteEvalTensor* tensors =
+        subgraph_allocations_[subgraph_idx].tensors;
+    const uint8_t* first_data =
+        reinterpret_cast<const uint8_t*>(tensors[first].data.data);
+    const uint8_t* second_data =
+        reinterpret_cast<const uint8_t*>(tensors[second].data.data);
+    size_t first_bytes = 0;
+    size_t second_bytes = 0;
+    if (first_data == nullptr || second_data == nullptr ||
+        TfLiteEvalTensorByteLength(&tensors[first], &first_bytes) !=
+            kTfLiteOk ||
+        TfLiteEvalTensorByteLength(&tensors[second], &second_bytes) !=
+            kTfLiteOk) {
+      return true;
+    }
+    return first_data < second_data + second_bytes &&
+           second_data < first_data + first_bytes;
+  }
+
+  // Returns true if two operators of a subgraph can run at the same time:
+  // no tensor memory written by one of them is accessed by the other.
+  bool AreOperatorsIndependent(int subgraph_idx, const TfLiteNode& first,
+                               const TfLiteNode& second) const {
+    return ForEachNodeTensor(first, [&](int first_tensor) {
+      const bool first_written =
+          IsWrittenTensor(subgraph_idx, first, first_tensor);
+      return ForEachNodeTensor(second, [&](int second_tensor) {
+        if (!first_written &&
+            !IsWrittenTensor(subgraph_idx, second, second_tensor)) {
+          return true;
+        }
+        return !DoTensorsOverlap(subgraph_idx, first_tensor, second_tensor);
+      });
+    });
+  }
+
+  static const char* OpNameFromRegistration(
+      const TFLMRegistration* registration) {
+    if (registration->builtin_code == BuiltinOperator_CUSTOM) {
+      return registration->custom_name;
+    }
+    return EnumNameBuiltinOperator(
+        static_cast<BuiltinOperator>(registration->builtin_code));
+  }
+
   TfLiteContext* context_;
   const Model* model_;
   MicroAllocator* allocator_;
@@ -109,6 +424,9 @@ class MicroInterpreterGraph : public MicroGraph {
   const flatbuffers::Vector<flatbuffers::Offset<SubGraph>>* subgraphs_ =
       nullptr;  // Initialized as nullptr to prevent any possible issues
                 // related to accessing uninitialized memory.
+  // Subgraph and next operator of a resumable invoke in progress, or -1.
+  int pending_subgraph_index_ = -1;
+  uint32_t pending_operator_index_ = 0;
 
   TF_LITE_REMOVE_VIRTUAL_DELETE
 };
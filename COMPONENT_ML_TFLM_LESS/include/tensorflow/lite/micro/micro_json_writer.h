@@ -0,0 +1,121 @@
+/* Copyright 2025 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_MICRO_JSON_WRITER_H_
+#define TENSORFLOW_LITE_MICRO_MICRO_JSON_WRITER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace tflite {
+
+// Receives chunks of exported text, e.g. to write them to a UART or a file.
+// Chunks are not null terminated.
+typedef void (*MicroTextSink)(void* context, const char* data, size_t size);
+
+// Writes JSON text to a MicroTextSink in small chunks, so the sink is not
+// called per character. Numbers are formatted here rather than with printf,
+// so the output also works with TF_LITE_STRIP_ERROR_STRINGS.
+class MicroJsonWriter {
+ public:
+  MicroJsonWriter(MicroTextSink sink, void* context)
+      : sink_(sink), context_(context), size_(0) {}
+
+  ~MicroJsonWriter() { Flush(); }
+
+  void Append(char c) {
+    if (size_ == sizeof(buffer_)) {
+      Flush();
+    }
+    buffer_[size_++] = c;
+  }
+
+  void Append(const char* text) {
+    while (*text != '\0') {
+      Append(*text++);
+    }
+  }
+
+  // Appends `text` for use inside a JSON string.
+  void AppendEscaped(const char* text) {
+    if (text == nullptr) {
+      return;
+    }
+    for (; *text != '\0'; ++text) {
+      if (*text == '"' || *text == '\\') {
+        Append('\\');
+      }
+      Append(static_cast<unsigned char>(*text) < 0x20 ? ' ' : *text);
+    }
+  }
+
+  void AppendUnsigned(uint64_t value, int min_digits = 1) {
+    char digits[20];
+    int count = 0;
+    do {
+      digits[count++] = static_cast<char>('0' + value % 10);
+      value /= 10;
+    } while (value != 0 || count < min_digits);
+    while (count > 0) {
+      Append(digits[--count]);
+    }
+  }
+
+  // Appends `thousandths` / 1000 with three decimals.
+  void AppendThousandths(uint64_t thousandths) {
+    AppendUnsigned(thousandths / 1000u);
+    Append('.');
+    AppendUnsigned(thousandths % 1000u, 3);
+  }
+
+  // Appends `"key":` after a comma unless `first`.
+  void AppendKey(const char* key, bool first = false) {
+    if (!first) {
+      Append(',');
+    }
+    Append('"');
+    AppendEscaped(key);
+    Append("\":");
+  }
+
+  void AppendString(const char* key, const char* value, bool first = false) {
+    AppendKey(key, first);
+    Append('"');
+    AppendEscaped(value);
+    Append('"');
+  }
+
+  void AppendNumber(const char* key, uint64_t value, bool first = false) {
+    AppendKey(key, first);
+    AppendUnsigned(value);
+  }
+
+  void Flush() {
+    if (size_ > 0 && sink_ != nullptr) {
+      sink_(context_, buffer_, size_);
+    }
+    size_ = 0;
+  }
+
+ private:
+  MicroTextSink sink_;
+  void* context_;
+  char buffer_[64];
+  size_t size_;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MICRO_JSON_WRITER_H_
@@ -0,0 +1,189 @@
+/* Copyright 2025 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_MICRO_MODEL_SWAPPER_H_
+#define TENSORFLOW_LITE_MICRO_MICRO_MODEL_SWAPPER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/compatibility.h"
+#include "tensorflow/lite/micro/micro_arena_constants.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/micro_log.h"
+
+namespace tflite {
+
+// Switches between prepared models without running Init/Prepare again.
+//
+// All the state AllocateTensors() creates for a model (the MicroAllocator,
+// node and registration arrays, TfLiteEvalTensors, kernel OpData such as
+// per-channel multipliers and precomputed filter sums, variable tensors) is
+// allocated from the tail of its persistent arena. The models handled by a
+// swapper take turns in one persistent arena, the slot. After AllocateTensors()
+// the used tail of the slot is copied to an image of the model, e.g. in
+// external RAM. Activating a model copies its image back into the slot. Since
+// the image is restored at the address it was created at, every pointer in it
+// is valid again without relocation, and the switch costs one memcpy of the
+// used persistent bytes.
+//
+// The MicroInterpreter objects stay where they are. They must be constructed
+// one after the other, each after the previous model was added, because every
+// allocator is created in the same slot. The non-persistent arena can be
+// shared as well, see MicroSharedArenaScheduler.
+//
+// Images are snapshots: changes a model makes to its persistent arena while
+// active (variable tensors, resource variables) are lost on the next switch
+// unless SaveActiveModel() is called first.
+//
+// If the persistent arenas of all models fit into memory at the same time,
+// e.g. in PSRAM, no swapper is needed: each model simply keeps its own
+// persistent arena and its interpreter.
+//
+// Example:
+//
+//   alignas(16) static uint8_t slot[16 * 1024];
+//   alignas(16) static uint8_t shared_arena[96 * 1024];
+//   static uint8_t vad_image[16 * 1024] PSRAM_SECTION;
+//   static uint8_t kws_image[16 * 1024] PSRAM_SECTION;
+//
+//   tflite::MicroModelSwapper<2> swapper(slot, sizeof(slot));
+//   int vad_id, kws_id;
+//   static tflite::MicroInterpreter vad(vad_model, resolver,
+//       tflite::MicroAllocator::Create(slot, sizeof(slot), shared_arena,
+//                                      sizeof(shared_arena)));
+//   swapper.AddModel(&vad, vad_image, sizeof(vad_image), &vad_id);
+//   static tflite::MicroInterpreter kws(kws_model, resolver,
+//       tflite::MicroAllocator::Create(slot, sizeof(slot), shared_arena,
+//                                      sizeof(shared_arena)));
+//   swapper.AddModel(&kws, kws_image, sizeof(kws_image), &kws_id);
+//
+//   swapper.Activate(vad_id);
+//   vad.Invoke();
+template <unsigned int tMaxModels>
+class MicroModelSwapper {
+ public:
+  static constexpr int kNoModel = -1;
+
+  // `slot` is the persistent arena all the added models were created in.
+  MicroModelSwapper(uint8_t* slot, size_t slot_size)
+      : slot_(slot),
+        slot_size_(slot_size),
+        model_count_(0),
+        active_model_(kNoModel) {}
+
+  // Allocates the tensors of `interpreter`, whose allocator must have been
+  // created with `slot` as persistent arena just before, and copies the
+  // prepared state to `image`. The model is active afterwards.
+  TfLiteStatus AddModel(MicroInterpreter* interpreter, uint8_t* image,
+                        size_t image_size, int* model_id) {
+    if (interpreter == nullptr || image == nullptr || model_id == nullptr) {
+      return kTfLiteError;
+    }
+    if (model_count_ >= static_cast<int>(tMaxModels)) {
+      MicroPrintf("MicroModelSwapper is full (%d models).",
+                  static_cast<int>(tMaxModels));
+      return kTfLiteError;
+    }
+    // The slot now holds the allocator of this interpreter, so the data of
+    // the previously active model is gone.
+    active_model_ = kNoModel;
+    TF_LITE_ENSURE_STATUS(interpreter->AllocateTensors());
+
+    ModelImage& model = models_[model_count_];
+    model.interpreter = interpreter;
+    model.image = image;
+    // arena_used_bytes() counts the persistent and the non-persistent usage,
+    // so it covers the used tail of the slot.
+    model.bytes = interpreter->arena_used_bytes() + MicroArenaBufferAlignment();
+    if (model.bytes > slot_size_) {
+      model.bytes = slot_size_;
+    }
+    if (model.bytes > image_size) {
+      MicroPrintf("Model image needs %d bytes, only %d available.",
+                  static_cast<int>(model.bytes),
+                  static_cast<int>(image_size));
+      return kTfLiteError;
+    }
+    *model_id = model_count_++;
+    active_model_ = *model_id;
+    return SaveActiveModel();
+  }
+
+  // Restores the prepared state of `model_id` into the slot, unless it is
+  // already active.
+  TfLiteStatus Activate(int model_id) {
+    if (model_id < 0 || model_id >= model_count_) {
+      MicroPrintf("Invalid model id %d.", model_id);
+      return kTfLiteError;
+    }
+    if (model_id != active_model_) {
+      const ModelImage& model = models_[model_id];
+      memcpy(SlotTail(model.bytes), model.image, model.bytes);
+      active_model_ = model_id;
+    }
+    return kTfLiteOk;
+  }
+
+  // Copies the persistent state of the active model back to its image, so
+  // that e.g. variable tensors survive the next switch.
+  TfLiteStatus SaveActiveModel() {
+    if (active_model_ == kNoModel) {
+      return kTfLiteError;
+    }
+    const ModelImage& model = models_[active_model_];
+    memcpy(model.image, SlotTail(model.bytes), model.bytes);
+    return kTfLiteOk;
+  }
+
+  int active_model() const { return active_model_; }
+  int model_count() const { return model_count_; }
+
+  // Bytes copied when `model_id` is activated.
+  size_t image_bytes(int model_id) const {
+    return model_id >= 0 && model_id < model_count_ ? models_[model_id].bytes
+                                                    : 0;
+  }
+
+  MicroInterpreter* interpreter(int model_id) const {
+    return model_id >= 0 && model_id < model_count_
+               ? models_[model_id].interpreter
+               : nullptr;
+  }
+
+ private:
+  struct ModelImage {
+    MicroInterpreter* interpreter;
+    uint8_t* image;
+    size_t bytes;
+  };
+
+  uint8_t* SlotTail(size_t bytes) const { return slot_ + slot_size_ - bytes; }
+
+  uint8_t* slot_;
+  size_t slot_size_;
+  ModelImage models_[tMaxModels];
+  int model_count_;
+  int active_model_;
+
+ public:
+  TF_LITE_REMOVE_VIRTUAL_DELETE
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MICRO_MODEL_SWAPPER_H_
@@ -0,0 +1,367 @@
+/* Copyright 2025 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_MICRO_ROOFLINE_PROFILER_H_
+#define TENSORFLOW_LITE_MICRO_MICRO_ROOFLINE_PROFILER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/compatibility.h"
+#include "tensorflow/lite/micro/flatbuffer_utils.h"
+#include "tensorflow/lite/micro/micro_async_accelerator.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/micro_log.h"
+#include "tensorflow/lite/micro/micro_profiler_interface.h"
+#include "tensorflow/lite/micro/micro_time.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+
+// Static work and measured time of one operator of the first subgraph.
+struct MicroNodeWork {
+  uint64_t macs;           // Per invocation.
+  uint32_t bytes_read;     // Inputs including weights, per invocation.
+  uint32_t bytes_written;  // Outputs, per invocation.
+  int32_t builtin_code;
+  bool accelerated;
+  uint32_t invocations;
+  uint64_t ticks;  // Summed over all invocations.
+};
+
+// Peak throughput of a kernel family in units of GetCurrentTimeTicks().
+struct MicroRooflinePeak {
+  float macs_per_tick;
+  float bytes_per_tick;
+};
+
+// Profiler that joins static per-operator work metrics with measured ticks to
+// tell how close each operator of a model gets to its roofline.
+//
+// ComputeStaticWork() derives from the model, once, the MACs of CONV_2D,
+// DEPTHWISE_CONV_2D, FULLY_CONNECTED and BATCH_MATMUL and the bytes read and
+// written by every operator. During Invoke() the interpreter's per-operator
+// profiler events are attributed to operators through
+// MicroInterpreter::current_operator_index(); nested events (e.g. from
+// kernels) are forwarded to an optional second profiler but not counted.
+//
+// The roofline of an operator is min(peak MACs, intensity * peak bandwidth),
+// with the peak of the CPU kernels or, for operators executed by an
+// accelerator set with SetAcceleratorPeak(), that of the accelerator. The
+// peaks are measured per target and kernel library (reference, CMSIS-NN,
+// NNLite), e.g. with a large FULLY_CONNECTED for MACs and a large ADD for
+// bandwidth.
+//
+// Example:
+//
+//   static tflite::MicroNodeWork work[64];
+//   tflite::MicroRooflineProfiler roofline(work, 64, {0.5f, 2.0f});
+//   tflite::MicroInterpreter interpreter(model, resolver, arena, arena_size,
+//                                        nullptr, &roofline);
+//   roofline.ComputeStaticWork(model, &interpreter);
+//   interpreter.Invoke();
+//   roofline.LogReport(/*min_efficiency_percent=*/25);
+class MicroRooflineProfiler : public MicroProfilerInterface {
+ public:
+  // `nodes` holds one entry per operator of the first subgraph and must
+  // outlive the profiler. Events are also passed on to `next` if not null.
+  MicroRooflineProfiler(MicroNodeWork* nodes, size_t capacity,
+                        const MicroRooflinePeak& cpu_peak,
+                        MicroProfilerInterface* next = nullptr)
+      : nodes_(nodes),
+        capacity_(capacity),
+        node_count_(0),
+        cpu_peak_(cpu_peak),
+        accelerator_peak_(cpu_peak),
+        accelerator_(nullptr),
+        interpreter_(nullptr),
+        next_(next),
+        depth_(0),
+        active_node_(-1),
+        active_depth_(0),
+        active_start_(0) {}
+  ~MicroRooflineProfiler() override {}
+
+  // Operators that `accelerator` declares are measured against `peak`. Call
+  // before ComputeStaticWork().
+  void SetAcceleratorPeak(const MicroAsyncAccelerator* accelerator,
+                          const MicroRooflinePeak& peak) {
+    accelerator_ = accelerator;
+    accelerator_peak_ = peak;
+  }
+
+  // Computes the static work of every operator of the first subgraph and
+  // starts attributing events of `interpreter` to them.
+  TfLiteStatus ComputeStaticWork(const Model* model,
+                                 MicroInterpreter* interpreter) {
+    if (model == nullptr || interpreter == nullptr ||
+        model->subgraphs() == nullptr || model->subgraphs()->size() == 0) {
+      return kTfLiteError;
+    }
+    const SubGraph* subgraph = model->subgraphs()->Get(0);
+    const uint32_t operators_size = NumSubgraphOperators(subgraph);
+    if (operators_size > capacity_) {
+      MicroPrintf("MicroRooflineProfiler: %d operators, capacity is %d",
+                  static_cast<int>(operators_size),
+                  static_cast<int>(capacity_));
+      return kTfLiteError;
+    }
+    for (uint32_t i = 0; i < operators_size; ++i) {
+      const Operator* op = subgraph->operators()->Get(i);
+      MicroNodeWork& node = nodes_[i];
+      node.builtin_code = FlatbufferOperatorBuiltinCode(model, op);
+      node.macs = ComputeMacs(subgraph, op, node.builtin_code);
+      node.bytes_read = SumTensorBytes(model, subgraph, op->inputs());
+      node.bytes_written = SumTensorBytes(model, subgraph, op->outputs());
+      const char* custom_name = nullptr;
+      if (node.builtin_code == BuiltinOperator_CUSTOM) {
+        const OperatorCode* code =
+            model->operator_codes()->Get(op->opcode_index());
+        custom_name =
+            code->custom_code() != nullptr ? code->custom_code()->c_str()
+                                           : nullptr;
+      }
+      node.accelerated =
+          accelerator_ != nullptr &&
+          accelerator_->IsAccelerated(node.builtin_code, custom_name);
+    }
+    node_count_ = operators_size;
+    interpreter_ = interpreter;
+    ResetMeasurements();
+    return kTfLiteOk;
+  }
+
+  void ResetMeasurements() {
+    for (size_t i = 0; i < node_count_; ++i) {
+      nodes_[i].invocations = 0;
+      nodes_[i].ticks = 0;
+    }
+    active_node_ = -1;
+  }
+
+  uint32_t BeginEvent(const char* tag) override {
+    const uint32_t handle = next_ != nullptr ? next_->BeginEvent(tag) : 0;
+    if (active_node_ < 0 && interpreter_ != nullptr &&
+        interpreter_->current_subgraph_index() == 0) {
+      const int node = interpreter_->current_operator_index();
+      if (node >= 0 && static_cast<size_t>(node) < node_count_ &&
+          IsOperatorEvent(node, tag)) {
+        active_node_ = node;
+        active_depth_ = depth_;
+        active_start_ = GetCurrentTimeTicks();
+      }
+    }
+    ++depth_;
+    return handle;
+  }
+
+  void EndEvent(uint32_t event_handle) override {
+    if (depth_ > 0) {
+      --depth_;
+    }
+    if (active_node_ >= 0 && depth_ == active_depth_) {
+      MicroNodeWork& node = nodes_[active_node_];
+      node.ticks += GetCurrentTimeTicks() - active_start_;
+      ++node.invocations;
+      active_node_ = -1;
+    }
+    if (next_ != nullptr) {
+      next_->EndEvent(event_handle);
+    }
+  }
+
+  size_t node_count() const { return node_count_; }
+
+  const MicroNodeWork& GetNodeWork(int node) const { return nodes_[node]; }
+
+  // Average MACs and bytes per tick of `node`, and the fraction of its
+  // roofline this reaches. Fails if the node has not been measured.
+  TfLiteStatus GetNodeEfficiency(int node, float* macs_per_tick,
+                                 float* bytes_per_tick,
+                                 float* roofline_fraction) const {
+    if (node < 0 || static_cast<size_t>(node) >= node_count_ ||
+        nodes_[node].invocations == 0 || nodes_[node].ticks == 0) {
+      return kTfLiteError;
+    }
+    const MicroNodeWork& work = nodes_[node];
+    const MicroRooflinePeak& peak =
+        work.accelerated ? accelerator_peak_ : cpu_peak_;
+    const float ticks = static_cast<float>(work.ticks) /
+                        static_cast<float>(work.invocations);
+    const float bytes =
+        static_cast<float>(work.bytes_read) + work.bytes_written;
+    *macs_per_tick = static_cast<float>(work.macs) / ticks;
+    *bytes_per_tick = bytes / ticks;
+    if (work.macs > 0 && bytes > 0.0f) {
+      const float intensity = static_cast<float>(work.macs) / bytes;
+      const float bandwidth_bound = intensity * peak.bytes_per_tick;
+      const float attainable = bandwidth_bound < peak.macs_per_tick
+                                   ? bandwidth_bound
+                                   : peak.macs_per_tick;
+      *roofline_fraction = *macs_per_tick / attainable;
+    } else {
+      *roofline_fraction = *bytes_per_tick / peak.bytes_per_tick;
+    }
+    return kTfLiteOk;
+  }
+
+  // Prints one CSV line per measured operator and flags those reaching less
+  // than `min_efficiency_percent` of their roofline.
+  void LogReport(int min_efficiency_percent) const {
+    MicroPrintf(
+        "\"Node\",\"Unit\",\"Op\",\"MACs\",\"Bytes\",\"Ticks\","
+        "\"MACs/tick\",\"Bytes/tick\",\"Roofline %%\",\"Below roofline\"");
+    for (size_t i = 0; i < node_count_; ++i) {
+      const MicroNodeWork& work = nodes_[i];
+      float macs_per_tick, bytes_per_tick, fraction;
+      if (GetNodeEfficiency(static_cast<int>(i), &macs_per_tick,
+                            &bytes_per_tick, &fraction) != kTfLiteOk) {
+        continue;
+      }
+      const int percent = static_cast<int>(fraction * 100.0f + 0.5f);
+      MicroPrintf("%d,%s,%s,%u,%u,%u,%d.%02d,%d.%02d,%d,%s",
+                  static_cast<int>(i), work.accelerated ? "npu" : "cpu",
+                  EnumNameBuiltinOperator(
+                      static_cast<BuiltinOperator>(work.builtin_code)),
+                  static_cast<unsigned>(work.macs),
+                  static_cast<unsigned>(work.bytes_read + work.bytes_written),
+                  static_cast<unsigned>(work.ticks / work.invocations),
+                  Whole(macs_per_tick), Hundredths(macs_per_tick),
+                  Whole(bytes_per_tick), Hundredths(bytes_per_tick), percent,
+                  percent < min_efficiency_percent ? "yes" : "no");
+    }
+  }
+
+ private:
+  static int Whole(float value) { return static_cast<int>(value); }
+  static int Hundredths(float value) {
+    return static_cast<int>((value - static_cast<int>(value)) * 100.0f);
+  }
+
+  // Distinguishes the interpreter's event for an operator, which is tagged
+  // with the operator name, from application events around Invoke().
+  bool IsOperatorEvent(int node, const char* tag) const {
+    const TFLMRegistration* registration =
+        interpreter_->node_and_registration(0, node).registration;
+    if (registration == nullptr || tag == nullptr) {
+      return false;
+    }
+    const char* name =
+        registration->builtin_code == BuiltinOperator_CUSTOM
+            ? registration->custom_name
+            : EnumNameBuiltinOperator(
+                  static_cast<BuiltinOperator>(registration->builtin_code));
+    return name != nullptr && (name == tag || strcmp(name, tag) == 0);
+  }
+
+  static const Tensor* GetTensor(const SubGraph* subgraph,
+                                 const flatbuffers::Vector<int32_t>* indices,
+                                 uint32_t i) {
+    if (indices == nullptr || i >= indices->size() || indices->Get(i) < 0 ||
+        subgraph->tensors() == nullptr) {
+      return nullptr;
+    }
+    return subgraph->tensors()->Get(indices->Get(i));
+  }
+
+  static int32_t Dim(const Tensor* tensor, int from_end) {
+    if (tensor == nullptr || tensor->shape() == nullptr ||
+        static_cast<int>(tensor->shape()->size()) < from_end) {
+      return 1;
+    }
+    const int32_t dim =
+        tensor->shape()->Get(tensor->shape()->size() - from_end);
+    return dim > 0 ? dim : 1;
+  }
+
+  static uint64_t ComputeMacs(const SubGraph* subgraph, const Operator* op,
+                              int32_t builtin_code) {
+    const Tensor* output = GetTensor(subgraph, op->outputs(), 0);
+    const Tensor* filter = GetTensor(subgraph, op->inputs(), 1);
+    if (output == nullptr || filter == nullptr) {
+      return 0;
+    }
+    const uint64_t output_count = FlatbufferTensorElementCount(output);
+    const uint64_t filter_count = FlatbufferTensorElementCount(filter);
+    switch (builtin_code) {
+      case BuiltinOperator_CONV_2D:
+        // Filter [out_c, h, w, in_c]: every output sums h * w * in_c terms.
+        return output_count * (filter_count / Dim(filter, 4));
+      case BuiltinOperator_DEPTHWISE_CONV_2D:
+        // Filter [1, h, w, out_c].
+        return output_count * (filter_count / Dim(filter, 1));
+      case BuiltinOperator_FULLY_CONNECTED:
+        return output_count * Dim(filter, 1);
+      case BuiltinOperator_BATCH_MATMUL: {
+        const Tensor* lhs = GetTensor(subgraph, op->inputs(), 0);
+        const BatchMatMulOptions* options =
+            op->builtin_options_as_BatchMatMulOptions();
+        const bool adj_x = options != nullptr && options->adj_x();
+        return output_count * Dim(lhs, adj_x ? 2 : 1);
+      }
+      default:
+        return 0;
+    }
+  }
+
+  // Constant tensors count with their size in the model, which is smaller
+  // than the arena size for packed or compressed weights.
+  static uint32_t SumTensorBytes(const Model* model, const SubGraph* subgraph,
+                                 const flatbuffers::Vector<int32_t>* indices) {
+    uint32_t bytes = 0;
+    for (uint32_t i = 0; indices != nullptr && i < indices->size(); ++i) {
+      const Tensor* tensor = GetTensor(subgraph, indices, i);
+      if (tensor == nullptr) {
+        continue;
+      }
+      const Buffer* buffer =
+          model->buffers() != nullptr &&
+                  tensor->buffer() < model->buffers()->size()
+              ? model->buffers()->Get(tensor->buffer())
+              : nullptr;
+      if (buffer != nullptr && buffer->data() != nullptr &&
+          buffer->data()->size() > 0) {
+        bytes += buffer->data()->size();
+      } else if (buffer != nullptr && buffer->offset() > 1) {
+        bytes += static_cast<uint32_t>(buffer->size());
+      } else {
+        bytes += static_cast<uint32_t>(FlatbufferTensorBytes(tensor));
+      }
+    }
+    return bytes;
+  }
+
+  MicroNodeWork* nodes_;
+  size_t capacity_;
+  size_t node_count_;
+  MicroRooflinePeak cpu_peak_;
+  MicroRooflinePeak accelerator_peak_;
+  const MicroAsyncAccelerator* accelerator_;
+  MicroInterpreter* interpreter_;
+  MicroProfilerInterface* next_;
+  int depth_;
+  int active_node_;
+  int active_depth_;
+  uint32_t active_start_;
+
+ public:
+  TF_LITE_REMOVE_VIRTUAL_DELETE
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MICRO_ROOFLINE_PROFILER_H_